@@ -85,10 +85,22 @@ private:
 	void applyQualitySettings() override;
 	void run() override;
 
-	int setHWParams( const ch_cnt_t _channels, snd_pcm_access_t _access );
+	int setHWParams( const ch_cnt_t _channels );
 	int setSWParams();
 	int handleError( int _err );
 
+	// convert given buffer into interleaved samples in the device's
+	// sample format
+	void convertBuffer( const surroundSampleFrame * _ab,
+						const fpp_t _frames,
+						const float _master_gain,
+						void * _dst );
+
+	void writeInterleaved( const char * _buf, const fpp_t _frames );
+	// convert given buffer straight into the device's mmap'ed buffer
+	void writeMmap( const surroundSampleFrame * _ab, const fpp_t _frames,
+						const float _master_gain );
+
 
 	snd_pcm_t * m_handle;
 
@@ -99,6 +111,9 @@ private:
 	snd_pcm_sw_params_t * m_swParams;
 
 	bool m_convertEndian;
+	snd_pcm_format_t m_format;
+	bool m_mmap;
+	int m_frameBytes;
 
 } ;
 
@@ -54,6 +54,7 @@ public slots:
 private:
 	QComboBox * m_deviceComboBox;
 	LcdSpinBox * m_channels;
+	QComboBox * m_formatComboBox;
 
 	int m_selectedDevice;
 	AudioAlsa::DeviceInfoCollection m_deviceInfos;
@@ -29,6 +29,7 @@
 #include <samplerate.h>
 
 #include "lmms_basics.h"
+#include "SampleConversion.h"
 
 
 class AudioPort;
@@ -61,6 +62,13 @@ public:
 	virtual void unregisterPort( AudioPort * _port );
 	virtual void renamePort( AudioPort * _port );
 
+	// called once per period from the mixer's worker threads with the
+	// output of each registered port, _buf is NULL if it was silent
+	virtual void portBufferReady( AudioPort * /* _port */,
+						const sampleFrame * /* _buf */ )
+	{
+	}
+
 
 	inline bool supportsCapture() const
 	{
@@ -79,6 +87,11 @@ public:
 
 	void processNextBuffer();
 
+	// write a buffer rendered at the mixer's processing rate which wasn't
+	// fetched by this device itself, e.g. a stem tapped during export
+	void processBuffer( const surroundSampleFrame * _ab,
+							const fpp_t _frames );
+
 	virtual void startProcessing()
 	{
 		m_inProcess = true;
@@ -99,9 +112,25 @@ protected:
 	{
 	}
 
+	// called by processNextBuffer() and processBuffer() for passing a
+	// buffer on to writeBuffer(), devices can defer writing by
+	// re-implementing it
+	virtual void outputBuffer( const surroundSampleFrame * _buf,
+						const fpp_t _frames,
+						const float _master_gain )
+	{
+		writeBuffer( _buf, _frames, _master_gain );
+	}
+
 	// called by according driver for fetching new sound-data
 	fpp_t getNextBuffer( surroundSampleFrame * _ab );
 
+	// mixer pool slot of the buffer last fetched by getNextBuffer()
+	int bufferPoolIndex() const
+	{
+		return m_bufferPoolIndex;
+	}
+
 	// convert a given audio-buffer to a buffer in signed 16-bit samples
 	// returns num of bytes in outbuf
 	int convertToS16( const surroundSampleFrame * _ab,
@@ -110,6 +139,12 @@ protected:
 						int_sample_t * _output_buffer,
 						const bool _convert_endian = false );
 
+	// dither used for conversions to integer formats
+	SampleConversion::Ditherer * ditherer()
+	{
+		return &m_ditherer;
+	}
+
 	// clear given signed-int-16-buffer
 	void clearS16Buffer( int_sample_t * _outbuf,
 							const fpp_t _frames );
@@ -152,6 +187,9 @@ private:
 	SRC_STATE * m_srcState;
 
 	surroundSampleFrame * m_buffer;
+	int m_bufferPoolIndex;
+
+	SampleConversion::Ditherer m_ditherer;
 
 } ;
 
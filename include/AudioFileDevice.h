@@ -27,8 +27,10 @@
 #define AUDIO_FILE_DEVICE_H
 
 #include <QtCore/QFile>
+#include <QtCore/QThread>
 
 #include "AudioDevice.h"
+#include "fifo_buffer.h"
 #include "OutputSettings.h"
 
 
@@ -47,8 +49,20 @@ public:
 
 	OutputSettings const & getOutputSettings() const { return m_outputSettings; }
 
+	// encode and write buffers on a separate thread, so the mixer can
+	// render the next periods meanwhile
+	void startEncoderThread();
+	// write all queued buffers and stop the encoder thread again, must be
+	// called by the destructors of derived classes at the latest, as the
+	// encoder thread uses their writeBuffer()
+	void stopEncoderThread();
+
 
 protected:
+	void outputBuffer( const surroundSampleFrame * _buf,
+						const fpp_t _frames,
+						const float _master_gain ) override;
+
 	int writeData( const void* data, int len );
 
 	inline bool outputFileOpened() const
@@ -61,9 +75,54 @@ protected:
 		return m_outputFile.handle();
 	}
 
+	// buffer for converting the data passed to writeBuffer() into the
+	// file's sample format, kept for the next call
+	template<typename T>
+	T * conversionBuffer( const fpp_t _frames )
+	{
+		const int size = _frames * channels() * sizeof( T );
+		if( m_conversionBuffer.size() < size )
+		{
+			m_conversionBuffer.resize( size );
+		}
+		return reinterpret_cast<T *>( m_conversionBuffer.data() );
+	}
+
 private:
+	// number of periods the encoder thread may lag behind
+	static const int EncoderQueueSize = 8;
+
+	struct EncoderBuffer
+	{
+		surroundSampleFrame * data;
+		fpp_t frames;
+		float masterGain;
+	} ;
+
+	class EncoderThread : public QThread
+	{
+	public:
+		EncoderThread( AudioFileDevice * _dev ) :
+			m_dev( _dev )
+		{
+		}
+
+	private:
+		void run() override;
+
+		AudioFileDevice * m_dev;
+	} ;
+
 	QFile m_outputFile;
 	OutputSettings m_outputSettings;
+	QByteArray m_conversionBuffer;
+
+	EncoderThread * m_encoderThread;
+	EncoderBuffer m_encoderBuffers[EncoderQueueSize];
+	// buffers ready to be filled by the rendering thread
+	fifoBuffer<EncoderBuffer *> m_freeBuffers;
+	// buffers waiting to be written by the encoder thread, NULL stops it
+	fifoBuffer<EncoderBuffer *> m_queuedBuffers;
 } ;
 
 
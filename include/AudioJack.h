@@ -37,6 +37,7 @@
 #include <QtCore/QVector>
 #include <QtCore/QList>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
 
 #include "AudioDevice.h"
 #include "AudioDeviceSetupWidget.h"
@@ -95,6 +96,11 @@ private:
 	virtual void registerPort( AudioPort * _port );
 	virtual void unregisterPort( AudioPort * _port );
 	virtual void renamePort( AudioPort * _port );
+	virtual void portBufferReady( AudioPort * _port,
+						const sampleFrame * _buf );
+
+	jack_port_t * registerOutputPort( const QString & _name );
+	void writePortOutputs( jack_nframes_t _offset, jack_nframes_t _frames );
 
 	int processCallback( jack_nframes_t _nframes, void * _udata );
 
@@ -117,15 +123,25 @@ private:
 	f_cnt_t m_framesToDoInCurBuf;
 
 
-#ifdef AUDIO_PORT_SUPPORT
+	// output of an AudioPort, the de-interleaved data of each period is
+	// kept in the slot of the mixer pool buffer it belongs to so it stays
+	// aligned with the master output no matter how far the mixer is ahead
 	struct StereoPort
 	{
-		jack_port_t * ports[2];
+		jack_port_t * ports[DEFAULT_CHANNELS];
+		jack_default_audio_sample_t * buffers[DEFAULT_CHANNELS];
+		QVector<jack_default_audio_sample_t> data;
+		QVector<bool> silent;
 	} ;
 
-	typedef QMap<AudioPort *, StereoPort> JackPortMap;
+	typedef QMap<AudioPort *, StereoPort *> JackPortMap;
 	JackPortMap m_portMap;
-#endif
+	QMutex m_portMapMutex;
+	// the JACK ports of m_portMap, with a mutex of their own so the process
+	// thread can still silence them while the map is being changed
+	QVector<jack_port_t *> m_portList;
+	QMutex m_portListMutex;
+	bool m_trackPorts;
 
 signals:
 	void zombified();
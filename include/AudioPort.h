@@ -30,6 +30,7 @@
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
 
+#include "CompensationDelay.h"
 #include "MemoryManager.h"
 #include "PlayHandle.h"
 
@@ -83,9 +84,21 @@ public:
 		return m_effects.get();
 	}
 
-	void setNextFxChannel( const fx_ch_t _chnl )
+	void setNextFxChannel( const fx_ch_t _chnl );
+
+
+	// frames the output lags behind the song, i.e. the latency of the
+	// source playing into the port plus the one of the effects
+	f_cnt_t latency() const;
+
+	// latency of what plays into the port, e.g. an instrument
+	void setSourceLatency( f_cnt_t _frames );
+
+	// delays the output to line up with the other inputs of the FX
+	// channel, set by the FX mixer
+	void setCompensationDelay( f_cnt_t _frames )
 	{
-		m_nextFxChannel = _chnl;
+		m_compensation.setDelay( _frames );
 	}
 
 
@@ -99,6 +112,34 @@ public:
 
 	bool processEffects();
 
+	enum StemTaps
+	{
+		// before the effects
+		StemPreEffects,
+		// after the effects, lined up with the other inputs of the FX
+		// channel
+		StemPostEffects,
+		// after the effects but before lining up the output, for audio
+		// that is played through the port again, e.g. by freezing
+		StemUncompensated
+	} ;
+
+	// copy the output of each period into given buffer, taken at given
+	// point - used for rendering stems in one pass, the buffer is left
+	// untouched in periods without output
+	void setStemBuffer( sampleFrame * _buf, StemTaps _tap = StemPostEffects )
+	{
+		m_stemBuffer = _buf;
+		m_stemTap = _tap;
+	}
+
+	// add given buffer to the output of the next period after the effects,
+	// used for playing back a frozen track
+	void setFrozenBuffer( const sampleFrame * _buf )
+	{
+		m_frozenBuffer = _buf;
+	}
+
 	// ThreadableJob stuff
 	void doProcessing() override;
 	bool requiresProcessing() const override
@@ -115,9 +156,17 @@ private:
 	sampleFrame * m_portBuffer;
 	QMutex m_portBufferLock;
 
+	sampleFrame * m_stemBuffer;
+	StemTaps m_stemTap;
+
+	const sampleFrame * m_frozenBuffer;
+
 	bool m_extOutputEnabled;
 	fx_ch_t m_nextFxChannel;
 
+	f_cnt_t m_sourceLatency;
+	CompensationDelay m_compensation;
+
 	QString m_name;
 
 	std::unique_ptr<EffectChain> m_effects;
@@ -260,6 +260,17 @@ public:
 		return "automatablemodel";
 	}
 
+	bool journalValue( float & value ) const override
+	{
+		value = m_value;
+		return true;
+	}
+
+	void restoreJournalValue( float value ) override
+	{
+		setValue( value );
+	}
+
 	virtual QString displayValue( const float val ) const = 0;
 
 	bool hasLinkedModels() const
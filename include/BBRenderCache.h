@@ -0,0 +1,222 @@
+/*
+ * BBRenderCache.h - reuses the output of repeating beat/bassline patterns
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef BB_RENDER_CACHE_H
+#define BB_RENDER_CACHE_H
+
+#include <memory>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+
+#include "lmms_basics.h"
+#include "MemoryManager.h"
+#include "MidiTime.h"
+#include "PlayHandle.h"
+
+class InstrumentTrack;
+class Pattern;
+class Track;
+
+
+// output of the notes of one repetition of a beat/bassline pattern on one
+// track, including the release tails of its notes - the notes mix into it
+// while they are played for the first time
+class BBRender
+{
+	MM_OPERATORS
+public:
+	BBRender( f_cnt_t _startOffset );
+	~BBRender();
+
+	const sampleFrame * data() const
+	{
+		return m_data;
+	}
+
+	f_cnt_t frames() const
+	{
+		return m_frames;
+	}
+
+	// called by the notes of the repetition and their sub-notes
+	void attach();
+	void detach( bool _finished );
+	void add( const sampleFrame * _buf, const fpp_t _frames );
+
+	// all notes of the repetition were started
+	void finishRepetition();
+	// the repetition wasn't played the same way as usual
+	void abort();
+
+	bool isComplete() const;
+	bool isAborted() const;
+	bool isDone() const;
+
+
+private:
+	void reserve( f_cnt_t _frames );
+
+	sampleFrame * m_data;
+	f_cnt_t m_frames;
+	f_cnt_t m_capacity;
+
+	const long m_startPeriod;
+	const f_cnt_t m_startOffset;
+
+	int m_notes;
+	bool m_repetitionFinished;
+	bool m_aborted;
+	mutable QMutex m_mutex;
+
+} ;
+
+
+
+
+class BBRenderCache
+{
+	MM_OPERATORS
+public:
+	// upper bound for the memory used by renders (64 MB of stereo frames)
+	static const f_cnt_t MaximumFrames = 8 * 1024 * 1024;
+
+	struct Key
+	{
+		const InstrumentTrack * track;
+		int bb;
+		bpm_t tempo;
+		int numerator;
+		int denominator;
+		sample_rate_t sampleRate;
+		uint hash;
+
+		bool operator==( const Key & _other ) const
+		{
+			return track == _other.track && bb == _other.bb &&
+				tempo == _other.tempo &&
+				numerator == _other.numerator &&
+				denominator == _other.denominator &&
+				sampleRate == _other.sampleRate &&
+				hash == _other.hash;
+		}
+	} ;
+
+	// a repetition of a pattern on a track being played by the song
+	struct Playback
+	{
+		Key key;
+		tick_t nextTick;
+		tick_t ticks;
+		// frame of the last tick played, counted from the start of the
+		// period counter
+		long lastTick;
+		std::shared_ptr<BBRender> render;
+		bool fromCache;
+		bool cut;
+	} ;
+
+	BBRenderCache();
+	~BBRenderCache();
+
+	static bool isEnabled();
+
+	// called for each tick the song plays of given pattern of given
+	// beat/bassline - returns true if the notes at this tick are covered
+	// by a previous render, otherwise notes started at this tick have to
+	// be attached to the render returned in _render, if any
+	bool processTick( InstrumentTrack * _track, Pattern * _pattern,
+				int _bb, Track * _bbTrack, const MidiTime & _tick,
+				f_cnt_t _offset, BBRender ** _render );
+
+	void removeTrack( const InstrumentTrack * _track );
+	void clear();
+
+
+private:
+	typedef QPair<const InstrumentTrack *, int> PlaybackKey;
+	typedef QHash<PlaybackKey, std::shared_ptr<Playback> > PlaybackMap;
+	typedef QPair<Key, std::shared_ptr<BBRender> > Recording;
+
+	struct Entry
+	{
+		std::shared_ptr<BBRender> render;
+		long lastUse;
+	} ;
+
+	std::shared_ptr<Playback> startRepetition( InstrumentTrack * _track,
+				Pattern * _pattern, int _bb, Track * _bbTrack,
+				f_cnt_t _offset );
+	void endPlayback( Playback & _playback );
+	void collectRenders();
+	void shrink( f_cnt_t _frames );
+
+	// whether the song will play a whole repetition from now on
+	static bool playsThrough( Track * _bbTrack, tick_t _ticks );
+
+	QHash<Key, Entry> m_entries;
+	f_cnt_t m_frames;
+
+	QList<Recording> m_recordings;
+	PlaybackMap m_playbacks;
+
+} ;
+
+
+inline uint qHash( const BBRenderCache::Key & _key )
+{
+	return qHash( _key.track ) ^ qHash( _key.bb ) ^ qHash( _key.tempo ) ^
+		_key.hash;
+}
+
+
+
+
+// plays back a render in place of the notes of a repetition
+class BBRenderPlayHandle : public PlayHandle
+{
+public:
+	BBRenderPlayHandle(
+			const std::shared_ptr<BBRenderCache::Playback> & _playback,
+			InstrumentTrack * _track, Track * _bbTrack,
+			f_cnt_t _offset );
+	virtual ~BBRenderPlayHandle() = default;
+
+	void play( sampleFrame * _working_buffer ) override;
+	bool isFinished() const override;
+	bool isFromTrack( const Track * _track ) const override;
+
+
+private:
+	std::shared_ptr<BBRenderCache::Playback> m_playback;
+	std::shared_ptr<BBRender> m_render;
+	InstrumentTrack * m_track;
+	Track * m_bbTrack;
+
+	f_cnt_t m_frame;
+	bool m_finished;
+
+} ;
+
+
+#endif
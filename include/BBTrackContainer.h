@@ -27,6 +27,7 @@
 #define BB_TRACK_CONTAINER_H
 
 #include "TrackContainer.h"
+#include "BBRenderCache.h"
 #include "ComboBoxModel.h"
 
 
@@ -64,6 +65,11 @@ public:
 
 	AutomatedValueMap automatedValuesAt(MidiTime time, int tcoNum) const override;
 
+	BBRenderCache & renderCache()
+	{
+		return m_renderCache;
+	}
+
 public slots:
 	void play();
 	void stop();
@@ -73,6 +79,7 @@ public slots:
 
 private:
 	ComboBoxModel m_bbComboBoxModel;
+	BBRenderCache m_renderCache;
 
 
 	friend class BBEditor;
@@ -0,0 +1,67 @@
+/*
+ * CompensationDelay.h - delays audio to line up paths of different latency
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef COMPENSATION_DELAY_H
+#define COMPENSATION_DELAY_H
+
+#include <memory>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "MemoryManager.h"
+
+class RingBuffer;
+
+
+//! Delays the audio of a signal path by a number of frames so that it lines
+//! up with parallel paths of higher latency where they are mixed together.
+class LMMS_EXPORT CompensationDelay
+{
+	MM_OPERATORS
+public:
+	CompensationDelay();
+	~CompensationDelay();
+
+	f_cnt_t delay() const
+	{
+		return m_delay;
+	}
+
+	//! Changes the delay, which drops the audio still being delayed
+	void setDelay( f_cnt_t _frames );
+
+	//! Delays a period of audio in place. _hasInput tells whether the
+	//! buffer holds audio at all, the return value whether it does after
+	//! the delay, which stays true until the delayed audio is played out.
+	bool process( sampleFrame * _buf, bool _hasInput );
+
+
+private:
+	std::unique_ptr<RingBuffer> m_ring;
+	f_cnt_t m_delay;
+	// frames of input audio yet to come out of the delay
+	f_cnt_t m_pending;
+
+} ;
+
+
+#endif
@@ -27,6 +27,7 @@
 #define EFFECT_H
 
 #include "Plugin.h"
+#include "CompensationDelay.h"
 #include "Engine.h"
 #include "Mixer.h"
 #include "AutomatableModel.h"
@@ -35,6 +36,7 @@
 
 class EffectChain;
 class EffectControls;
+class PlanarBuffer;
 
 
 class LMMS_EXPORT Effect : public Plugin
@@ -55,9 +57,46 @@ public:
 		return "effect";
 	}
 
-	
+	//! Memory layouts of the buffers effects can process
+	enum BufferLayouts
+	{
+		InterleavedLayout,
+		PlanarLayout
+	} ;
+
+	//! Processes the buffer in place, including the mix with the dry
+	//! signal and the gate. Must be reimplemented by all effects but
+	//! wet-only ones.
 	virtual bool processAudioBuffer( sampleFrame * _buf,
-						const fpp_t _frames ) = 0;
+						const fpp_t _frames );
+
+	//! Processes audio in the planar layout. The default implementation
+	//! goes through processAudioBuffer(), so only effects preferring the
+	//! planar layout need to reimplement it.
+	virtual bool processPlanarBuffer( PlanarBuffer & _buf,
+						const fpp_t _frames );
+
+	//! The layout the effect chain should pass audio in - it only
+	//! converts buffers where the preferences of two effects differ
+	virtual BufferLayouts preferredLayout() const
+	{
+		return InterleavedLayout;
+	}
+
+	//! Number of frames the output of the effect lags behind its input,
+	//! which the FX mixer compensates for on parallel signal paths
+	virtual f_cnt_t latency() const
+	{
+		return 0;
+	}
+
+	//! Number of frames audio may stay inside the effect before it comes
+	//! out, e.g. the length of its delay lines - auto-quit doesn't stop
+	//! the effect before its output was silent for at least that long
+	virtual f_cnt_t tailLength() const
+	{
+		return 0;
+	}
 
 	inline ch_cnt_t processorCount() const
 	{
@@ -103,7 +142,8 @@ public:
 
 	inline f_cnt_t timeout() const
 	{
-		const float samples = Engine::mixer()->processingSampleRate() * m_autoQuitModel.value() / 1000.0f;
+		const float samples = qMax<float>( Engine::mixer()->processingSampleRate() * m_autoQuitModel.value() / 1000.0f,
+								tailLength() );
 		return 1 + ( static_cast<int>( samples ) / Engine::mixer()->framesPerPeriod() );
 	}
 
@@ -143,6 +183,14 @@ public:
 		return m_noRun;
 	}
 
+	//! Wet-only effects only compute their wet signal in
+	//! processWetBuffer() and leave mixing it with the dry signal, the gate
+	//! and auto-quit to the effect chain
+	inline bool isWetOnly() const
+	{
+		return m_wetOnly;
+	}
+
 	inline void setDontRun( bool _state )
 	{
 		m_noRun = _state;
@@ -170,8 +218,28 @@ protected:
 	*/
 	void checkGate( double _out_sum );
 
+	inline void setWetOnly( bool _state )
+	{
+		m_wetOnly = _state;
+	}
+
+	//! Replaces the buffer with the wet signal of the effect - to be
+	//! implemented by wet-only effects
+	virtual void processWetBuffer( sampleFrame * /* _buf */,
+						const fpp_t /* _frames */ )
+	{
+	}
+
 	PluginView * instantiateView( QWidget * ) override;
 
+protected slots:
+	//! Effects whose latency changes call this so that the delay
+	//! compensation is updated. Wet-only effects must call it while
+	//! they aren't processed, e.g. from their constructor or when the
+	//! sample rate changes, as the delay of their dry signal is resized.
+	void latencyChanged();
+
+protected:
 	// some effects might not be capable of higher sample-rates so they can
 	// sample it down before processing and back after processing
 	inline void sampleDown( const sampleFrame * _src_buf,
@@ -207,6 +275,7 @@ private:
 
 	bool m_okay;
 	bool m_noRun;
+	bool m_wetOnly;
 	bool m_running;
 	f_cnt_t m_bufferCount;
 
@@ -220,6 +289,9 @@ private:
 	SRC_DATA m_srcData[2];
 	SRC_STATE * m_srcState[2];
 
+	// lines up the dry signal of wet-only effects with their latency
+	CompensationDelay m_dryDelay;
+
 
 	friend class EffectView;
 	friend class EffectChain;
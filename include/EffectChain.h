@@ -29,6 +29,7 @@
 #include "Model.h"
 #include "SerializingObject.h"
 #include "AutomatableModel.h"
+#include "PlanarBuffer.h"
 
 class Effect;
 
@@ -55,19 +56,41 @@ public:
 	bool processAudioBuffer( sampleFrame * _buf, const fpp_t _frames, bool hasInputNoise );
 	void startRunning();
 
+	//! Sum of the latencies of the enabled effects
+	f_cnt_t latency() const;
+
+	//! Runs a wet-only effect on given buffer and mixes the result with
+	//! the dry signal, which is kept in _dry meanwhile. Also tracks the
+	//! output level for the gate and auto-quit of the effect.
+	static bool processWetOnly( Effect * _effect, sampleFrame * _buf,
+					sampleFrame * _dry, const fpp_t _frames );
+
 	void clear();
 
 
 private:
 	typedef QVector<Effect *> EffectList;
+
+	// allocates the scratch buffers once the chain gets effects
+	void allocateBuffers();
+
 	EffectList m_effects;
 
 	BoolModel m_enabledModel;
 
+	// scratch buffer for effects preferring the planar layout
+	PlanarBuffer m_planarBuffer;
+	// copy of the input of wet-only effects
+	sampleFrame * m_dryBuffer;
+
 
 	friend class EffectRackView;
 
 
+private slots:
+	void latencyChanged();
+
+
 signals:
 	void aboutToClear();
 
@@ -90,6 +90,12 @@ public:
 		return m_used;
 	}
 
+	// the LFO runs on global time, so it makes equal notes sound different
+	inline bool isLfoUsed() const
+	{
+		return !m_lfoAmountIsZero;
+	}
+
 
 	void saveSettings( QDomDocument & _doc, QDomElement & _parent ) override;
 	void loadSettings( const QDomElement & _this ) override;
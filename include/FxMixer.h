@@ -26,6 +26,7 @@
 #define FX_MIXER_H
 
 #include "Model.h"
+#include "CompensationDelay.h"
 #include "EffectChain.h"
 #include "JournallingObject.h"
 #include "ThreadableJob.h"
@@ -51,6 +52,9 @@ class FxChannel : public ThreadableJob
 		float m_peakLeft;
 		float m_peakRight;
 		sampleFrame * m_buffer;
+		// if set, the channel's output after volume is added to it
+		// each period, used for rendering stems in one pass
+		sampleFrame * m_stemBuffer;
 		bool m_muteBeforeSolo;
 		BoolModel m_muteModel;
 		BoolModel m_soloModel;
@@ -67,6 +71,10 @@ class FxChannel : public ThreadableJob
 		// pointers to other channels that send to this one
 		FxRouteVector m_receives;
 
+		// frames the output of the channel lags behind the song,
+		// updated by FxMixer::updateLatencies()
+		f_cnt_t m_latency;
+
 		bool requiresProcessing() const override { return true; }
 		void unmuteForSolo();
 
@@ -111,6 +119,12 @@ class FxRoute : public QObject
 	{
 		return m_to;
 	}
+
+	// lines the send up with the other inputs of the receiver
+	CompensationDelay * compensation()
+	{
+		return &m_compensation;
+	}
 	
 	void updateName();
 		
@@ -118,6 +132,7 @@ class FxRoute : public QObject
 		FxChannel * m_from;
 		FxChannel * m_to;
 		FloatModel m_amount;
+		CompensationDelay m_compensation;
 };
 
 
@@ -185,6 +200,14 @@ public:
 	// rename channels when moving etc. if they still have their original name
 	void validateChannelName( int index, int oldIndex );
 
+	// to be called whenever the routing or the latency of a track,
+	// effect or instrument changes - the delay compensation is updated
+	// before the next period
+	void invalidateLatency()
+	{
+		m_latencyChanged = true;
+	}
+
 	void toggledSolo();
 	void activateSolo();
 	void deactivateSolo();
@@ -203,8 +226,14 @@ private:
 	// make sure we have at least num channels
 	void allocateChannelsTo(int num);
 
+	// delays the inputs of each channel so that they all arrive with
+	// the latency of the slowest one
+	void updateLatencies();
+
 	int m_lastSoloed;
 
+	std::atomic_bool m_latencyChanged;
+
 } ;
 
 
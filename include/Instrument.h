@@ -51,6 +51,7 @@ public:
 		IsSingleStreamed = 0x01,	/*! Instrument provides a single audio stream for all notes */
 		IsMidiBased = 0x02,			/*! Instrument is controlled by MIDI events rather than NotePlayHandles */
 		IsNotBendable = 0x04,		/*! Instrument can't react to pitch bend changes */
+		IsDeterministic = 0x08,		/*! Equal notes with equal settings always give equal output */
 	};
 
 	Q_DECLARE_FLAGS(Flags, Flag);
@@ -103,6 +104,14 @@ public:
 		return NoFlags;
 	}
 
+	// instruments whose output lags behind the notes they play, e.g.
+	// because they render ahead, return the number of frames here - the
+	// FX mixer delays parallel tracks accordingly
+	virtual f_cnt_t latency() const
+	{
+		return 0;
+	}
+
 	// sub-classes can re-implement this for receiving all incoming
 	// MIDI-events
 	inline virtual bool handleMidiEvent( const MidiEvent&, const MidiTime& = MidiTime(), f_cnt_t offset = 0 )
@@ -137,6 +146,9 @@ protected:
 	// desiredReleaseFrames() frames are left
 	void applyRelease( sampleFrame * buf, const NotePlayHandle * _n );
 
+	// to be called whenever the value returned by latency() changes
+	void latencyChanged();
+
 
 private:
 	InstrumentTrack * m_instrumentTrack;
@@ -27,6 +27,7 @@
 
 #include "PlayHandle.h"
 #include "Instrument.h"
+#include "InstrumentTrack.h"
 #include "NotePlayHandle.h"
 #include "lmms_export.h"
 
@@ -61,7 +62,13 @@ public:
 			}
 		}
 		while( nphsLeft );
-		
+
+		// the output of a frozen track is played back instead
+		if( m_instrument->instrumentTrack()->playsFrozen() )
+		{
+			return;
+		}
+
 		m_instrument->play( _working_buffer );
 	}
 
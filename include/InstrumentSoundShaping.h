@@ -54,6 +54,8 @@ public:
 	f_cnt_t envFrames( const bool _only_vol = false ) const;
 	f_cnt_t releaseFrames() const;
 
+	bool usesLfo() const;
+
 	float volumeLevel( NotePlayHandle * _n, const f_cnt_t _frame );
 
 
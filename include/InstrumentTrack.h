@@ -63,6 +63,7 @@ class TabWidget;
 class TrackLabelButton;
 class LedCheckBox;
 class QLabel;
+class SampleBuffer;
 
 
 class LMMS_EXPORT InstrumentTrack : public Track, public MidiEventProcessor
@@ -132,6 +133,10 @@ public:
 	// play everything in given frame-range - creates note-play-handles
 	virtual bool play( const MidiTime & _start, const fpp_t _frames,
 						const f_cnt_t _frame_base, int _tco_num = -1 ) override;
+
+	// hash everything the output of the notes of given pattern depends
+	// on - returns false if equal notes may sound different each time
+	bool hashPatternOutput( const Pattern * _pattern, uint * _hash );
 	// create new view for me
 	TrackView * createView( TrackContainerView* tcv ) override;
 
@@ -214,6 +219,25 @@ public:
 
 	void setPreviewMode( const bool );
 
+	// a frozen track plays back its pre-rendered output during song
+	// playback instead of running its instrument and effects
+	bool isFrozen() const
+	{
+		return m_frozenBuffer != NULL;
+	}
+
+	// freeze track with given output rendered from the start of the song,
+	// takes over the buffer
+	void freeze( SampleBuffer * _buffer );
+
+	// whether the output of the current period comes from the frozen
+	// buffer
+	bool playsFrozen() const;
+
+
+public slots:
+	void unfreeze();
+
 
 signals:
 	void instrumentChanged();
@@ -238,7 +262,17 @@ protected slots:
 	void updateEffectChannel();
 
 
+private slots:
+	void outputChanged();
+	void frozenModelChanged();
+	void frozenTCOAdded( TrackContentObject * _tco );
+
+
 private:
+	void watchFrozenModel( Model * _model );
+	void watchFrozenModels();
+	void playFrozen( const f_cnt_t _offset );
+
 	MidiPort m_midiPort;
 
 	NotePlayHandle* m_notes[NumKeys];
@@ -275,6 +309,12 @@ private:
 
 	Piano m_piano;
 
+	SampleBuffer * m_frozenBuffer;
+	sampleFrame * m_frozenPeriod;
+
+	// counts changes of the instrument which aren't visible in its models
+	unsigned int m_outputRevision;
+
 
 	friend class InstrumentTrackView;
 	friend class InstrumentTrackWindow;
@@ -338,6 +378,8 @@ private slots:
 	void assignFxLine( int channelIndex );
 	void createFxLine();
 
+	void freezeTrack();
+
 
 private:
 	InstrumentTrackWindow * m_window;
@@ -63,6 +63,17 @@ public:
 
 	void restoreState( const QDomElement & _this ) override;
 
+	//! Objects whose undoable state is a single value can return it here,
+	//! the journal then stores it instead of serializing the whole object
+	virtual bool journalValue( float & /*value*/ ) const
+	{
+		return false;
+	}
+
+	virtual void restoreJournalValue( float /*value*/ )
+	{
+	}
+
 	inline bool isJournalling() const
 	{
 		return m_journalling;
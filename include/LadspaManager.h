@@ -30,7 +30,9 @@
 
 #include <ladspa.h>
 
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
 #include <QtCore/QPair>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
@@ -70,13 +72,22 @@ enum ladspaPluginType
 	OTHER
 };
 
+class QFileInfo;
+struct LadspaManifestLibrary;
+
+
 typedef struct ladspaManagerStorage
 {
+	// NULL until the library is needed if the plugin was found in the
+	// manifest
 	LADSPA_Descriptor_Function descriptorFunction;
 	uint32_t index;
 	ladspaPluginType type;
 	uint16_t inputChannels;
 	uint16_t outputChannels;
+	QString file;
+	// copy of the descriptor without the functions
+	const LADSPA_Descriptor * metadata;
 } ladspaManagerDescription;
 
 
@@ -329,8 +340,16 @@ public:
 						LADSPA_Handle _instance );
 
 private:
-	void  addPlugins( LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file );
+	void  addPlugins( const LadspaManifestLibrary * _library,
+				const QString & _file, const QString & _path );
+	LadspaManifestLibrary * scanLibrary( const QFileInfo & _file );
+	bool  loadLibrary( ladspaManagerDescription * _description,
+						const QString & _label );
+
+	void  readManifest();
+	void  writeManifest() const;
+
+	const LADSPA_Descriptor * getMetadata( const ladspa_key_t & _plugin );
 	uint16_t  getPluginInputs( const LADSPA_Descriptor * _descriptor );
 	uint16_t  getPluginOutputs( const LADSPA_Descriptor * _descriptor );
 
@@ -344,6 +363,11 @@ private:
 	ladspaManagerMapType m_ladspaManagerMap;
 	l_sortable_plugin_t m_sortedPlugins;
 
+	// descriptors of all libraries found, by path - saved so that the
+	// next start doesn't have to load unchanged libraries
+	QHash<QString, LadspaManifestLibrary *> m_manifest;
+	QMutex m_loadMutex;
+
 } ;
 
 #endif
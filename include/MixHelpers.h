@@ -39,6 +39,9 @@ void setNaNHandler( bool use );
 
 bool sanitize( sampleFrame * src, int frames );
 
+/*! \brief Same as sanitize, for planar buffers of DEFAULT_CHANNELS channels */
+bool sanitize( sample_t * const * src, int frames );
+
 /*! \brief Add samples from src to dst */
 void add( sampleFrame* dst, const sampleFrame* src, int frames );
 
@@ -73,6 +76,12 @@ void multiplyAndAddMultiplied( sampleFrame* dst, const sampleFrame* src, float c
 /*! \brief Multiply dst by coeffDst and add samples from srcLeft/srcRight multiplied by coeffSrc */
 void multiplyAndAddMultipliedJoined( sampleFrame* dst, const sample_t* srcLeft, const sample_t* srcRight, float coeffDst, float coeffSrc, int frames );
 
+/*! \brief Sum of the squares of all samples in src */
+float energy( const sampleFrame* src, int frames );
+
+/*! \brief Multiply dst by coeffDst and add samples from src multiplied by coeffSrc, returns the energy of the result */
+float multiplyAndAddMultipliedEnergy( sampleFrame* dst, const sampleFrame* src, float coeffDst, float coeffSrc, int frames );
+
 }
 
 #endif
@@ -179,7 +179,10 @@ public:
 				const struct qualitySettings & _qs,
 				bool _needs_fifo,
 				bool startNow );
+	//! Remember the current audio device and quality settings, e.g.
+	//! before exporting
 	void storeAudioDevice();
+	//! Switch back to the stored device and quality settings
 	void restoreAudioDevice();
 	inline AudioDevice * audioDev()
 	{
@@ -197,6 +200,11 @@ public:
 
 	void removeAudioPort( AudioPort * _port );
 
+	inline const QVector<AudioPort *> & audioPorts() const
+	{
+		return m_audioPorts;
+	}
+
 
 	// MIDI-client-stuff
 	inline const QString & midiClientName() const
@@ -310,6 +318,22 @@ public:
 		return hasFifoWriter() ? m_fifo->read() : renderNextBuffer();
 	}
 
+	// buffers returned by nextBuffer() come from a pool - devices can keep
+	// per-period data of their own in slots alongside the pool buffers
+	inline int bufferPoolDepth() const
+	{
+		return m_poolDepth;
+	}
+
+	// pool slot of the buffer currently being mixed into
+	inline int writeBufferIndex() const
+	{
+		return m_writeBuffer;
+	}
+
+	// pool slot of a buffer returned by nextBuffer(), -1 if unknown
+	int bufferPoolIndex( const surroundSampleFrame * _buf ) const;
+
 	void changeQuality( const struct qualitySettings & _qs );
 
 	inline bool isMetronomeActive() const { return m_metronomeActive; }
@@ -330,7 +354,10 @@ signals:
 
 
 private:
-	typedef fifoBuffer<surroundSampleFrame *> fifo;
+	typedef fifoBuffer<const surroundSampleFrame *> fifo;
+
+	// number of buffers in the pool besides those queued in the FIFO
+	static const int MinimumPoolDepth = 3;
 
 	class fifoWriter : public QThread
 	{
@@ -347,7 +374,7 @@ private:
 
 		void run() override;
 
-		void write( surroundSampleFrame * buffer );
+		void write( const surroundSampleFrame * buffer );
 
 	} ;
 
@@ -403,6 +430,7 @@ private:
 
 
 	struct qualitySettings m_qualitySettings;
+	struct qualitySettings m_oldQualitySettings;
 	float m_masterGain;
 
 	bool m_isProcessing;
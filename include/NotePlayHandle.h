@@ -35,6 +35,7 @@
 #include "MemoryManager.h"
 
 class QReadWriteLock;
+class BBRender;
 class InstrumentTrack;
 class NotePlayHandle;
 
@@ -240,6 +241,9 @@ public:
 		m_bbTrack = t;
 	}
 
+	/*! Attaches the note and its sub-notes to the render of a beat/bassline repetition */
+	void setBBRender( BBRender * render );
+
 	/*! Process note detuning automation */
 	void processMidiTime( const MidiTime& time );
 
@@ -309,6 +313,7 @@ private:
 	bool m_hadChildren;
 	bool m_muted;							// indicates whether note is muted
 	Track* m_bbTrack;						// related BB track
+	BBRender * m_bbRender;					// render the output goes to
 
 	// tempo reaction
 	bpm_t m_origTempo;						// original tempo
@@ -0,0 +1,115 @@
+/*
+ * Oversampler.h - runs parts of effects at a multiple of the sample rate
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef OVERSAMPLER_H
+#define OVERSAMPLER_H
+
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "MemoryManager.h"
+
+
+//! Up- and downsamples stereo audio by a factor of 2, 4 or 8, so that
+//! nonlinear processing in between doesn't alias. Each doubling of the rate
+//! is done by a polyphase halfband filter. The one next to the processing
+//! rate is the steepest, the following ones only have to remove the images
+//! of an already band-limited signal and get by with a few taps.
+class LMMS_EXPORT Oversampler
+{
+	MM_OPERATORS
+public:
+	static const int MaximumFactor = 8;
+
+	Oversampler( int _factor = 1, fpp_t _frames = 0 );
+	Oversampler( const Oversampler & ) = delete;
+	~Oversampler();
+
+	Oversampler & operator=( const Oversampler & ) = delete;
+
+	//! Factor to oversample by for effects which want to process at given
+	//! multiple of the sample rate, taking into account that the engine
+	//! itself may already run at a multiple of it
+	static int localFactor( int _factor );
+
+	int factor() const
+	{
+		return m_factor;
+	}
+
+	//! Sets the factor, which has to be 1, 2, 4 or 8, and clears the
+	//! filter histories if it changes. Returns whether it did.
+	bool setFactor( int _factor );
+
+	//! Makes room for processing periods of given number of frames
+	void reserve( fpp_t _frames );
+
+	//! Clears the filter histories
+	void reset();
+
+	//! Delay caused by up- and downsampling, in frames at the original rate
+	f_cnt_t latency() const
+	{
+		return m_latency;
+	}
+
+	//! Returns a buffer holding _frames * factor() frames upsampled from
+	//! _src, to be processed in place. It stays valid until the next call.
+	sampleFrame * upsample( const sampleFrame * _src, fpp_t _frames );
+
+	//! Downsamples the buffer returned by the last call of upsample() to
+	//! _frames frames in _dst
+	void downsample( sampleFrame * _dst, fpp_t _frames );
+
+
+private:
+	class Stage;
+
+	void allocate();
+	void delay( sample_t * const * _buf, f_cnt_t _frames );
+
+	static void deinterleave( const sampleFrame * _src,
+				sample_t * const * _dst, f_cnt_t _frames );
+	static void interleave( const sample_t * const * _src,
+				sampleFrame * _dst, f_cnt_t _frames );
+
+	int m_factor;
+	fpp_t m_capacity;
+
+	std::vector<Stage *> m_stages;
+	sampleFrame * m_buffer;
+
+	// the stages work on planar audio in these, taking turns as input and
+	// output - they are too large for PlanarBuffer at the highest rate
+	std::vector<sample_t> m_planar[2][DEFAULT_CHANNELS];
+	sample_t * m_channels[2][DEFAULT_CHANNELS];
+
+	// delay at the highest rate rounding the latency up to whole frames
+	f_cnt_t m_padding;
+	std::vector<sample_t> m_paddingHistory[DEFAULT_CHANNELS];
+	f_cnt_t m_latency;
+
+} ;
+
+
+#endif
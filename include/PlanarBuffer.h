@@ -0,0 +1,82 @@
+/*
+ * PlanarBuffer.h - a stereo buffer with one block of samples per channel
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef PLANAR_BUFFER_H
+#define PLANAR_BUFFER_H
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "MemoryManager.h"
+
+
+//! Stereo audio in the planar layout, i.e. the samples of each channel are
+//! stored one after another instead of being interleaved as in sampleFrame
+//! buffers. Used where effects prefer to process each channel on its own.
+class LMMS_EXPORT PlanarBuffer
+{
+	MM_OPERATORS
+public:
+	PlanarBuffer( fpp_t _frames = 0 );
+	PlanarBuffer( const PlanarBuffer & ) = delete;
+	~PlanarBuffer();
+
+	PlanarBuffer & operator=( const PlanarBuffer & ) = delete;
+
+	//! Makes room for at least given number of frames, which drops the
+	//! contents if the buffer has to grow
+	void reserve( fpp_t _frames );
+
+	fpp_t capacity() const
+	{
+		return m_capacity;
+	}
+
+	sample_t * channel( ch_cnt_t _channel )
+	{
+		return m_channels[_channel];
+	}
+
+	const sample_t * channel( ch_cnt_t _channel ) const
+	{
+		return m_channels[_channel];
+	}
+
+	sample_t * const * channels()
+	{
+		return m_channels;
+	}
+
+	void fromInterleaved( const sampleFrame * _src, fpp_t _frames );
+	void toInterleaved( sampleFrame * _dst, fpp_t _frames ) const;
+
+	void clear( fpp_t _frames );
+
+
+private:
+	sample_t * m_data;
+	sample_t * m_channels[DEFAULT_CHANNELS];
+	fpp_t m_capacity;
+
+} ;
+
+
+#endif
@@ -48,7 +48,8 @@ public:
 		TypeNotePlayHandle = 0x01,
 		TypeInstrumentPlayHandle = 0x02,
 		TypeSamplePlayHandle = 0x04,
-		TypePresetPreviewHandle = 0x08
+		TypePresetPreviewHandle = 0x08,
+		TypeBBRenderPlayHandle = 0x10
 	} ;
 	typedef Types Type;
 
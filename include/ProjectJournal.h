@@ -25,6 +25,8 @@
 #ifndef PROJECT_JOURNAL_H
 #define PROJECT_JOURNAL_H
 
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QHash>
 #include <QtCore/QStack>
 
@@ -39,6 +41,11 @@ class ProjectJournal
 {
 public:
 	static const int MAX_UNDO_STATES;
+	//! upper bound for the memory used by the undo history
+	static const int MAX_UNDO_BYTES;
+	//! checkpoints of the same value added within this interval (in
+	//! milliseconds) are merged, e.g. when turning the mouse wheel
+	static const int COALESCE_INTERVAL;
 
 	ProjectJournal();
 	virtual ~ProjectJournal();
@@ -99,21 +106,31 @@ private:
 
 	struct CheckPoint
 	{
-		CheckPoint( jo_id_t initID = 0, const DataFile& initData = DataFile( DataFile::JournalData ) ) :
+		CheckPoint( jo_id_t initID = 0 ) :
 			joID( initID ),
-			data( initData )
+			value( 0 ),
+			isValue( false )
 		{
 		}
 		jo_id_t joID;
-		DataFile data;
+		// serialized state, unless the object provided a single value
+		QByteArray data;
+		float value;
+		bool isValue;
 	} ;
 	typedef QStack<CheckPoint> CheckPointStack;
 
+	static CheckPoint createCheckPoint( JournallingObject * jo );
+	void restoreCheckPoint( JournallingObject * jo, const CheckPoint & c );
+	void trimUndoCheckPoints();
+
 	JoIdMap m_joIDs;
 
 	CheckPointStack m_undoCheckPoints;
 	CheckPointStack m_redoCheckPoints;
 
+	QElapsedTimer m_lastCheckPointTime;
+
 	bool m_journalling;
 
 } ;
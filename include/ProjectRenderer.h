@@ -25,13 +25,19 @@
 #ifndef PROJECT_RENDERER_H
 #define PROJECT_RENDERER_H
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QVector>
+
 #include "AudioFileDevice.h"
+#include "AudioPort.h"
 #include "lmmsconfig.h"
 #include "Mixer.h"
 #include "OutputSettings.h"
 
 #include "lmms_export.h"
 
+class FxChannel;
+
 class LMMS_EXPORT ProjectRenderer : public QThread
 {
 	Q_OBJECT
@@ -56,6 +62,7 @@ public:
 	} ;
 
 
+	// _out_file may be empty if only stems are to be rendered
 	ProjectRenderer( const Mixer::qualitySettings & _qs,
 				const OutputSettings & _os,
 				ExportFileFormats _file_format,
@@ -67,6 +74,21 @@ public:
 		return m_fileDev != NULL;
 	}
 
+	// additionally write the output of given audio port or FX channel
+	// into a file of its own while rendering the song - must be called
+	// before startProcessing()
+	bool addStem( AudioPort * _port, const QString & _out_file,
+						AudioPort::StemTaps _tap );
+	bool addStem( FxChannel * _channel, const QString & _out_file );
+
+	int stemCount() const
+	{
+		return m_stems.size();
+	}
+
+	// rendered song time per elapsed time
+	double realtimeFactor() const;
+
 	static ExportFileFormats getFileFormatFromExtension(
 							const QString & _ext );
 
@@ -86,12 +108,32 @@ signals:
 
 
 private:
+	struct Stem
+	{
+		AudioFileDevice * device;
+		sampleFrame * buffer;
+		AudioPort * port;
+		FxChannel * channel;
+	} ;
+
 	void run() override;
 
+	AudioFileDevice * createFileDevice( const QString & _out_file );
+	bool appendStem( Stem & _stem );
+	void writeStems();
+
 	AudioFileDevice * m_fileDev;
+	// whether m_fileDev receives the mix or only drives the mixer
+	bool m_renderMix;
+	QVector<Stem> m_stems;
+
 	Mixer::qualitySettings m_qualitySettings;
+	OutputSettings m_outputSettings;
+	ExportFileFormats m_fileFormat;
 
 	volatile int m_progress;
+	volatile int m_periodsRendered;
+	QElapsedTimer m_renderTimer;
 	volatile bool m_abort;
 
 } ;
@@ -47,6 +47,18 @@
 
 #include <QtCore/QtGlobal>
 #include <QtCore/QSystemSemaphore>
+#elif defined(LMMS_BUILD_LINUX)
+#define SYNC_WITH_SHM_RING
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <signal.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#else
+#define SYNC_WITH_SOCKET
 #endif
 
 
@@ -82,18 +94,20 @@ typedef int32_t key_t;
 #define LMMS_EXPORT
 #define COMPILE_REMOTE_PLUGIN_BASE
 
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 #include <sys/socket.h>
 #include <sys/un.h>
 #endif
 
 #else
+#include <memory>
+
 #include "lmms_export.h"
 #include <QtCore/QMutex>
 #include <QtCore/QProcess>
 #include <QtCore/QThread>
 
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 #include <poll.h>
 #include <unistd.h>
 #endif
@@ -411,6 +425,213 @@ private:
 #endif
 
 
+#ifdef SYNC_WITH_SHM_RING
+// size of the ring for each direction - bigger messages (e.g. VST parameter
+// dumps) are streamed through the ring in several parts
+const uint32_t SHM_RING_SIZE = 512*1024;
+// cache line size, keeps data written by the two sides apart
+const int SHM_RING_ALIGN = 64;
+// how long to sleep at most before checking whether the peer still exists
+const int SHM_RING_TIMEOUT = 500;
+
+
+// single-producer single-consumer byte ring inside a shared memory segment -
+// the producer only writes head, the consumer only writes tail, so no locks
+// are needed, and a side that has to wait for data or space sleeps on a futex
+// the other side wakes up instead of polling
+class shmRing
+{
+public:
+	struct Data
+	{
+		// written by the producer
+		alignas( SHM_RING_ALIGN ) std::atomic<uint32_t> head;
+		std::atomic<int32_t> dataSeq;		// futex, bumped for new data
+		std::atomic<int32_t> spaceWaiters;
+
+		// written by the consumer
+		alignas( SHM_RING_ALIGN ) std::atomic<uint32_t> tail;
+		std::atomic<int32_t> spaceSeq;		// futex, bumped for free space
+		std::atomic<int32_t> dataWaiters;
+
+		alignas( SHM_RING_ALIGN ) char data[SHM_RING_SIZE];
+	} ;
+
+	shmRing() :
+		m_data( NULL ),
+		m_invalid( true ),
+		m_peer( 0 )
+	{
+	}
+
+	// _peer is the process to watch while waiting, 0 if someone else
+	// takes care of invalidating the ring when the peer dies
+	void attach( Data * _data, pid_t _peer )
+	{
+		m_data = _data;
+		m_peer = _peer;
+		m_invalid = ( _data == NULL );
+	}
+
+	void reset()
+	{
+		m_data->head = 0;
+		m_data->tail = 0;
+		m_data->dataSeq = 0;
+		m_data->spaceSeq = 0;
+		m_data->dataWaiters = 0;
+		m_data->spaceWaiters = 0;
+	}
+
+	inline bool isInvalid() const
+	{
+		return m_invalid;
+	}
+
+	void invalidate()
+	{
+		m_invalid = true;
+		if( m_data != NULL )
+		{
+			// let all threads waiting on this side notice
+			notify( m_data->dataSeq, m_data->dataWaiters, true );
+			notify( m_data->spaceSeq, m_data->spaceWaiters, true );
+		}
+	}
+
+	inline bool isEmpty() const
+	{
+		return m_invalid || m_data->head.load( std::memory_order_acquire ) ==
+				m_data->tail.load( std::memory_order_acquire );
+	}
+
+	bool write( const void * _buf, uint32_t _len )
+	{
+		const char * buf = (const char *) _buf;
+		while( _len > 0 )
+		{
+			if( m_invalid )
+			{
+				return false;
+			}
+			const uint32_t head =
+				m_data->head.load( std::memory_order_relaxed );
+			const uint32_t space = SHM_RING_SIZE - ( head -
+				m_data->tail.load( std::memory_order_acquire ) );
+			if( space == 0 )
+			{
+				wait( m_data->spaceSeq, m_data->spaceWaiters, false );
+				continue;
+			}
+
+			const uint32_t len = _len < space ? _len : space;
+			const uint32_t pos = head % SHM_RING_SIZE;
+			const uint32_t first = SHM_RING_SIZE - pos < len ?
+						SHM_RING_SIZE - pos : len;
+			memcpy( m_data->data + pos, buf, first );
+			memcpy( m_data->data, buf + first, len - first );
+			m_data->head.store( head + len, std::memory_order_release );
+			notify( m_data->dataSeq, m_data->dataWaiters, false );
+
+			buf += len;
+			_len -= len;
+		}
+		return true;
+	}
+
+	bool read( void * _buf, uint32_t _len )
+	{
+		char * buf = (char *) _buf;
+		while( _len > 0 )
+		{
+			if( m_invalid )
+			{
+				return false;
+			}
+			const uint32_t tail =
+				m_data->tail.load( std::memory_order_relaxed );
+			const uint32_t used =
+				m_data->head.load( std::memory_order_acquire ) - tail;
+			if( used == 0 )
+			{
+				wait( m_data->dataSeq, m_data->dataWaiters, true );
+				continue;
+			}
+
+			const uint32_t len = _len < used ? _len : used;
+			const uint32_t pos = tail % SHM_RING_SIZE;
+			const uint32_t first = SHM_RING_SIZE - pos < len ?
+						SHM_RING_SIZE - pos : len;
+			memcpy( buf, m_data->data + pos, first );
+			memcpy( buf + first, m_data->data, len - first );
+			m_data->tail.store( tail + len, std::memory_order_release );
+			notify( m_data->spaceSeq, m_data->spaceWaiters, false );
+
+			buf += len;
+			_len -= len;
+		}
+		return true;
+	}
+
+
+private:
+	// sleep until the other side bumps _seq - the waiter count is raised
+	// before checking the condition once more, so a side publishing its
+	// index at the same time either sees it or we see the new index
+	void wait( std::atomic<int32_t> & _seq, std::atomic<int32_t> & _waiters,
+								bool _forData )
+	{
+		_waiters.fetch_add( 1 );
+		const int32_t seq = _seq.load();
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		const uint32_t used = m_data->head.load() - m_data->tail.load();
+		if( !m_invalid &&
+			( _forData ? used == 0 : used == SHM_RING_SIZE ) )
+		{
+			struct timespec timeout;
+			timeout.tv_sec = SHM_RING_TIMEOUT / 1000;
+			timeout.tv_nsec = ( SHM_RING_TIMEOUT % 1000 ) * 1000000;
+			if( syscall( SYS_futex, (int32_t *) &_seq, FUTEX_WAIT,
+					seq, &timeout, NULL, 0 ) == -1 &&
+				errno == ETIMEDOUT && m_peer != 0 &&
+				kill( m_peer, 0 ) == -1 && errno == ESRCH )
+			{
+				m_invalid = true;
+			}
+		}
+		_waiters.fetch_sub( 1 );
+	}
+
+	void notify( std::atomic<int32_t> & _seq,
+				std::atomic<int32_t> & _waiters, bool _always )
+	{
+		// no syscall as long as nobody sleeps
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		if( _always || _waiters.load() > 0 )
+		{
+			_seq.fetch_add( 1 );
+			syscall( SYS_futex, (int32_t *) &_seq, FUTEX_WAKE,
+						INT_MAX, NULL, NULL, 0 );
+		}
+	}
+
+	Data * m_data;
+	volatile bool m_invalid;
+	pid_t m_peer;
+
+} ;
+
+
+// shared memory connecting host and remote plugin
+struct shmRingPair
+{
+	shmRing::Data hostToClient;
+	shmRing::Data clientToHost;
+	pid_t hostPid;
+} ;
+#endif
+
+
 
 enum RemoteMessageIDs
 {
@@ -439,6 +660,7 @@ enum RemoteMessageIDs
 	IdSavePresetFile,
 	IdLoadPresetFile,
 	IdDebugMessage,
+	IdAddInstance,
 	IdUserBase = 64
 } ;
 
@@ -547,8 +769,10 @@ public:
 
 	inline bool isInvalid() const
 	{
-#ifdef SYNC_WITH_SHM_FIFO
+#if defined(SYNC_WITH_SHM_FIFO)
 		return m_in->isInvalid() || m_out->isInvalid();
+#elif defined(SYNC_WITH_SHM_RING)
+		return m_in.isInvalid() || m_out.isInvalid();
 #else
 		return m_invalid;
 #endif
@@ -604,8 +828,10 @@ public:
 #ifndef BUILD_REMOTE_PLUGIN_CLIENT
 	inline bool messagesLeft()
 	{
-#ifdef SYNC_WITH_SHM_FIFO
+#if defined(SYNC_WITH_SHM_FIFO)
 		return m_in->messagesLeft();
+#elif defined(SYNC_WITH_SHM_RING)
+		return !m_in.isEmpty();
 #else
 		struct pollfd pollin;
 		pollin.fd = m_socket;
@@ -649,19 +875,34 @@ protected:
 	}
 #endif
 
+#ifdef SYNC_WITH_SHM_RING
+	// host side: set up the shared memory for a new remote process
+	void createRings();
+	// remote side: connect to the shared memory set up by the host
+	void attachRings( key_t _key );
+
+	inline key_t ringKey() const
+	{
+		return m_ringKey;
+	}
+#endif
+
 	inline void invalidate()
 	{
-#ifdef SYNC_WITH_SHM_FIFO
+#if defined(SYNC_WITH_SHM_FIFO)
 		m_in->invalidate();
 		m_out->invalidate();
 		m_in->messageSent();
+#elif defined(SYNC_WITH_SHM_RING)
+		m_in.invalidate();
+		m_out.invalidate();
 #else
 		m_invalid = true;
 #endif
 	}
 
 
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 	int m_socket;
 #endif
 
@@ -675,9 +916,46 @@ private:
 	}
 #endif
 
-#ifdef SYNC_WITH_SHM_FIFO
+#if defined(SYNC_WITH_SHM_FIFO)
 	shmFifo * m_in;
 	shmFifo * m_out;
+#elif defined(SYNC_WITH_SHM_RING)
+	void read( void * _buf, int _len )
+	{
+		if( !m_in.read( _buf, _len ) )
+		{
+			invalidate();
+			memset( _buf, 0, _len );
+		}
+	}
+
+	// messages are collected and passed to the ring in one go, so the
+	// receiving side is woken up once per message
+	void write( const void * _buf, int _len )
+	{
+		const char * buf = (const char *) _buf;
+		m_sendBuffer.insert( m_sendBuffer.end(), buf, buf + _len );
+	}
+
+	void flush()
+	{
+		if( !m_out.write( m_sendBuffer.data(), m_sendBuffer.size() ) )
+		{
+			invalidate();
+		}
+		m_sendBuffer.clear();
+	}
+
+	shmRing m_in;
+	shmRing m_out;
+	std::vector<char> m_sendBuffer;
+
+	key_t m_ringKey;
+	int m_ringShmID;
+	shmRingPair * m_rings;
+
+	pthread_mutex_t m_receiveMutex;
+	pthread_mutex_t m_sendMutex;
 #else
 	void read( void * _buf, int _len )
 	{
@@ -746,6 +1024,7 @@ private:
 
 
 class RemotePlugin;
+class RemotePluginGroup;
 
 class ProcessWatcher : public QThread
 {
@@ -781,13 +1060,14 @@ public:
 	RemotePlugin();
 	virtual ~RemotePlugin();
 
-	inline bool isRunning()
+	bool isRunning();
+
+	// plugins of the same executable with the same non-empty group share
+	// one process instead of each starting their own one - has to be set
+	// before init()
+	void setProcessGroup( const QString & _group )
 	{
-#ifdef DEBUG_REMOTE_PLUGIN
-		return true;
-#else
-		return m_process.state() != QProcess::NotRunning;
-#endif
+		m_processGroup = _group;
 	}
 
 	bool init( const QString &pluginExecutable, bool waitForInitDoneMsg, QStringList extraArgs = {} );
@@ -809,6 +1089,18 @@ public:
 
 	void processMidiEvent( const MidiEvent&, const f_cnt_t _offset );
 
+	// let the plugin process a period while the mixer works on the rest
+	// of it - process() then returns the output of the previous period
+	void setPipelined( bool _on );
+
+	inline bool isPipelined() const
+	{
+		return m_pipelined;
+	}
+
+	// frames the output of process() lags behind its input
+	f_cnt_t latency() const;
+
 	void updateSampleRate( sample_rate_t _sr )
 	{
 		lock();
@@ -859,11 +1151,20 @@ protected:
 		m_splitChannels = _on;
 	}
 
+	// called by the watcher once the process is gone
+	virtual void processDied();
+
 
 	bool m_failed;
 private:
 	void resizeSharedProcessingMemory();
 
+	bool processPipelined( const sampleFrame * _in_buf,
+						sampleFrame * _out_buf );
+	bool finishProcessing();
+	void writeInput( const sampleFrame * _in_buf, const fpp_t _frames );
+	void readOutput( sampleFrame * _out_buf, const fpp_t _frames );
+
 
 	QProcess m_process;
 	ProcessWatcher m_watcher;
@@ -871,8 +1172,16 @@ private:
 	QString m_exec;
 	QStringList m_args;
 
+	QString m_processGroup;
+	std::shared_ptr<RemotePluginGroup> m_group;
+
 	QMutex m_commMutex;
 	bool m_splitChannels;
+	bool m_pipelined;
+	// a period was started and its output wasn't collected yet
+	bool m_periodPending;
+	// the plugin didn't report the period to be done yet
+	bool m_processing;
 #ifdef USE_QT_SHMEM
 	QSharedMemory m_shmObj;
 #else
@@ -884,12 +1193,13 @@ private:
 	int m_inputCount;
 	int m_outputCount;
 
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 	int m_server;
 	QString m_socketFile;
 #endif
 
 	friend class ProcessWatcher;
+	friend class RemotePluginGroup;
 
 
 private slots:
@@ -897,6 +1207,35 @@ private slots:
 	void processErrored(QProcess::ProcessError err );
 } ;
 
+
+
+
+// a plugin process hosting several instances, which talk to their remote
+// counterparts through their own channels as usual - it only starts them
+class RemotePluginGroup : public RemotePlugin
+{
+public:
+	RemotePluginGroup();
+	virtual ~RemotePluginGroup() = default;
+
+	// returns the running process of given group, starting it if needed
+	static std::shared_ptr<RemotePluginGroup> get( const QString & _exec,
+							const QString & _group );
+
+	bool addInstance( RemotePlugin * _instance, const QStringList & _args );
+	void removeInstance( RemotePlugin * _instance );
+
+
+protected:
+	void processDied() override;
+
+
+private:
+	QList<RemotePlugin *> m_instances;
+	QMutex m_instancesMutex;
+
+} ;
+
 #endif
 
 
@@ -1015,10 +1354,18 @@ private:
 #endif
 
 
-#ifdef SYNC_WITH_SHM_FIFO
+#if defined(SYNC_WITH_SHM_FIFO)
 RemotePluginBase::RemotePluginBase( shmFifo * _in, shmFifo * _out ) :
 	m_in( _in ),
 	m_out( _out )
+#elif defined(SYNC_WITH_SHM_RING)
+RemotePluginBase::RemotePluginBase() :
+	m_in(),
+	m_out(),
+	m_sendBuffer(),
+	m_ringKey( 0 ),
+	m_ringShmID( -1 ),
+	m_rings( NULL )
 #else
 RemotePluginBase::RemotePluginBase() :
 	m_socket( -1 ),
@@ -1045,6 +1392,18 @@ RemotePluginBase::~RemotePluginBase()
 	delete m_in;
 	delete m_out;
 #else
+#ifdef SYNC_WITH_SHM_RING
+	if( m_rings != NULL )
+	{
+		// the host created the segment, so it removes it
+		const bool master = m_rings->hostPid == getpid();
+		shmdt( m_rings );
+		if( master )
+		{
+			shmctl( m_ringShmID, IPC_RMID, NULL );
+		}
+	}
+#endif
 	pthread_mutex_destroy( &m_receiveMutex );
 	pthread_mutex_destroy( &m_sendMutex );
 #endif
@@ -1053,6 +1412,65 @@ RemotePluginBase::~RemotePluginBase()
 
 
 
+#ifdef SYNC_WITH_SHM_RING
+void RemotePluginBase::createRings()
+{
+	if( m_rings != NULL )
+	{
+		shmdt( m_rings );
+		shmctl( m_ringShmID, IPC_RMID, NULL );
+	}
+
+	static key_t ring_key = 0;
+	while( ( m_ringShmID = shmget( ++ring_key, sizeof( shmRingPair ),
+					IPC_CREAT | IPC_EXCL | 0600 ) ) == -1 )
+	{
+	}
+	m_ringKey = ring_key;
+	m_rings = (shmRingPair *) shmat( m_ringShmID, 0, 0 );
+	assert( m_rings != (shmRingPair *) -1 );
+
+	m_rings->hostPid = getpid();
+	m_in.attach( &m_rings->clientToHost, 0 );
+	m_out.attach( &m_rings->hostToClient, 0 );
+	m_in.reset();
+	m_out.reset();
+}
+
+
+
+
+void RemotePluginBase::attachRings( key_t _key )
+{
+	m_ringKey = _key;
+	m_ringShmID = shmget( _key, 0, 0 );
+	if( m_ringShmID != -1 )
+	{
+		m_rings = (shmRingPair *) shmat( m_ringShmID, 0, 0 );
+		if( m_rings == (shmRingPair *) -1 )
+		{
+			m_rings = NULL;
+		}
+	}
+	if( m_rings == NULL )
+	{
+		fprintf( stderr, "Could not attach to the host.\n" );
+		return;
+	}
+
+	// both sides are attached now, so let the segment go away together
+	// with the last of them, even if the host crashes
+	shmctl( m_ringShmID, IPC_RMID, NULL );
+
+	// the host doesn't tell us when it dies, so watch it while waiting
+	m_in.attach( &m_rings->hostToClient, m_rings->hostPid );
+	m_out.attach( &m_rings->clientToHost, m_rings->hostPid );
+}
+#endif
+
+
+
+
 int RemotePluginBase::sendMessage( const message & _m )
 {
 #ifdef SYNC_WITH_SHM_FIFO
@@ -1077,6 +1495,9 @@ int RemotePluginBase::sendMessage( const message & _m )
 		writeString( _m.data[i] );
 		j += 4 + _m.data[i].size();
 	}
+#ifdef SYNC_WITH_SHM_RING
+	flush();
+#endif
 	pthread_mutex_unlock( &m_sendMutex );
 #endif
 
@@ -1201,7 +1622,10 @@ RemotePluginClient::RemotePluginClient( const char * socketPath ) :
 	m_sampleRate( 44100 ),
 	m_bufferSize( 0 )
 {
-#ifndef SYNC_WITH_SHM_FIFO
+#if defined(SYNC_WITH_SHM_RING)
+	// the host passes the key of the shared memory instead of a socket
+	attachRings( atoi( socketPath ) );
+#elif defined(SYNC_WITH_SOCKET)
 	struct sockaddr_un sa;
 	sa.sun_family = AF_LOCAL;
 
@@ -1297,7 +1721,7 @@ RemotePluginClient::~RemotePluginClient()
 	shmdt( m_shm );
 #endif
 
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 	if ( close( m_socket ) == -1)
 	{
 		fprintf( stderr, "Error freeing resources.\n" );
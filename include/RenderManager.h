@@ -31,11 +31,25 @@
 #include "ProjectRenderer.h"
 #include "OutputSettings.h"
 
+class FxChannel;
+
 
 class RenderManager : public QObject
 {
 	Q_OBJECT
 public:
+	enum StemModes
+	{
+		//! Render the song once per track with all other tracks muted
+		StemsFullMix,
+		//! Single pass, take each track's output after its effects
+		StemsTrackPostEffects,
+		//! Single pass, take each track's output before its effects
+		StemsTrackPreEffects,
+		//! Single pass, take the output of each FX channel
+		StemsFxChannels
+	} ;
+
 	RenderManager(
 		const Mixer::qualitySettings & qualitySettings,
 		const OutputSettings & outputSettings,
@@ -47,11 +61,26 @@ public:
 	/// Export all unmuted tracks into a single file
 	void renderProject();
 
+	/// Export the output of a single track, e.g. for freezing it
+	void renderTrack( Track * track );
+
 	/// Export all unmuted tracks into individual file
-	void renderTracks();
+	void renderTracks( StemModes mode = StemsFullMix );
+
+	/// Number of files rendered in the last single-pass stem export
+	int stemCount() const
+	{
+		return m_stemCount;
+	}
 
 	void abortProcessing();
 
+	/// Rendering speed of the current export relative to realtime
+	double realtimeFactor() const
+	{
+		return m_activeRenderer ? m_activeRenderer->realtimeFactor() : 0;
+	}
+
 signals:
 	void progressChanged( int );
 	void finished();
@@ -62,12 +91,14 @@ private slots:
 
 private:
 	QString pathForTrack( const Track *track, int num );
+	QString pathForFxChannel( const FxChannel *channel, int num );
 	void restoreMutedState();
 
 	void render( QString outputPath );
+	void renderStems( StemModes mode );
+	void startRenderer();
 
 	const Mixer::qualitySettings m_qualitySettings;
-	const Mixer::qualitySettings m_oldQualitySettings;
 	const OutputSettings m_outputSettings;
 	ProjectRenderer::ExportFileFormats m_format;
 	QString m_outputPath;
@@ -76,6 +107,7 @@ private:
 
 	QVector<Track*> m_tracksToRender;
 	QVector<Track*> m_unmuted;
+	int m_stemCount;
 } ;
 
 #endif
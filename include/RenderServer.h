@@ -0,0 +1,85 @@
+/*
+ * RenderServer.h - renders a queue of projects without restarting LMMS
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RENDER_SERVER_H
+#define RENDER_SERVER_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+
+#include "ProjectRenderer.h"
+#include "OutputSettings.h"
+
+class RenderManager;
+
+
+/// Reads jobs from a file or stdin, one per line:
+///
+///     <project>[<tab><output>]
+///
+/// and renders them one after another, reusing the engine that was set
+/// up at startup. Empty lines and lines starting with '#' are skipped.
+/// For every job a single line of JSON describing the result is
+/// printed to stdout.
+class RenderServer : public QObject
+{
+	Q_OBJECT
+public:
+	RenderServer(
+		const Mixer::qualitySettings & qualitySettings,
+		const OutputSettings & outputSettings,
+		ProjectRenderer::ExportFileFormats fmt,
+		bool renderLoop );
+
+	virtual ~RenderServer();
+
+	/// Start processing jobs from given file, or stdin if it is empty
+	bool start( const QString & jobFile );
+
+signals:
+	void finished();
+
+private slots:
+	void nextJob();
+	void jobFinished();
+
+private:
+	bool readJob();
+	void printResult( const QString & status );
+
+	const Mixer::qualitySettings m_qualitySettings;
+	const OutputSettings m_outputSettings;
+	ProjectRenderer::ExportFileFormats m_format;
+	bool m_renderLoop;
+
+	QFile m_jobs;
+	QString m_project;
+	QString m_output;
+
+	RenderManager * m_renderManager;
+	QElapsedTimer m_timer;
+	qint64 m_loadTime;
+	int m_jobCount;
+	int m_failedCount;
+} ;
+
+#endif
@@ -37,10 +37,12 @@
 #include "lmms_math.h"
 #include "shared_object.h"
 #include "MemoryManager.h"
+#include "SamplePeakCache.h"
 
 
 class QPainter;
 class QRect;
+class SampleDataBundle;
 
 // values for buffer margins, used for various libsamplerate interpolation modes
 // the array positions correspond to the converter_type parameter values in libsamplerate
@@ -217,6 +219,17 @@ public:
 
 	QString & toBase64( QString & _dst ) const;
 
+	// store data in a project's sample data bundle instead of base64,
+	// returns the offset to reference it by
+	qint64 addToBundle( SampleDataBundle & _bundle ) const;
+	bool loadFromBundle( const SampleDataBundle & _bundle, qint64 _offset,
+							f_cnt_t _frames );
+
+	// frees the data the buffer was created from and keeps only the copy
+	// that's played back - for large buffers that are never reversed,
+	// resampled or otherwise re-prepared, such as frozen tracks
+	void dropOriginalData();
+
 
 	// protect calls from the GUI to this function with dataReadLock() and
 	// dataUnlock()
@@ -264,13 +277,30 @@ public slots:
 	void setReversed( bool _on );
 	void sampleRateChanged();
 
+private slots:
+	void peakCacheBuilt();
+
 private:
+	class PeakCacheBuilder;
+
 	static sample_rate_t mixerSampleRate();
 
+	void startPeakCacheBuild();
+	void stopPeakCacheBuild();
+
 	void update( bool _keep_settings = false );
 
-	void convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames, int _channels);
-	void directFloatWrite ( sample_t * & _fbuf, f_cnt_t _frames, int _channels);
+	// decodes m_audioFile into newly allocated _data at the processing
+	// rate without changing the buffer, returns the number of frames or 0
+	// if the file couldn't be decoded or exceeds the limits (_tooLarge)
+	f_cnt_t decodeAudioFile( sampleFrame * & _data, bool & _tooLarge );
+	static f_cnt_t resampleData( const sampleFrame * _src, f_cnt_t _frames,
+					const sample_rate_t _src_sr,
+					const sample_rate_t _dst_sr,
+					sampleFrame * & _dst );
+
+	void convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames, int _channels, sampleFrame * & _data ) const;
+	void directFloatWrite ( sample_t * & _fbuf, f_cnt_t _frames, int _channels, sampleFrame * & _data ) const;
 
 	f_cnt_t decodeSampleSF( QString _f, sample_t * & _buf,
 						ch_cnt_t & _channels,
@@ -299,6 +329,17 @@ private:
 	float m_frequency;
 	sample_rate_t m_sampleRate;
 
+	// summary of m_data for visualize(), built in the background on first
+	// use after the data changed
+	SamplePeakCache m_peakCache;
+	PeakCacheBuilder * m_peakCacheBuilder;
+
+	// data for the previous processing rate, kept so switching back after
+	// an export doesn't require decoding and resampling again
+	sampleFrame * m_cachedData;
+	f_cnt_t m_cachedFrames;
+	sample_rate_t m_cachedSampleRate;
+
 	sampleFrame * getSampleFragment( f_cnt_t _index, f_cnt_t _frames,
 						LoopMode _loopmode,
 						sampleFrame * * _tmp,
@@ -310,6 +351,8 @@ private:
 
 signals:
 	void sampleUpdated();
+	// the waveform can be drawn in more detail now
+	void peaksReady();
 
 } ;
 
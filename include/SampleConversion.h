@@ -0,0 +1,108 @@
+/*
+ * SampleConversion.h - conversion of rendered audio into the sample formats
+ *                      of audio devices and file encoders
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SAMPLE_CONVERSION_H
+#define SAMPLE_CONVERSION_H
+
+#include "lmms_export.h"
+#include "lmms_basics.h"
+
+
+//! All functions take frames as rendered by the mixer, apply a gain, clip
+//! to [-1, 1] and write the first `channels` channels of each frame. The
+//! common case of all channels being written without dither is done with
+//! SSE2 if available.
+namespace SampleConversion
+{
+
+enum DitherModes
+{
+	NoDither,
+	//! Triangular PDF noise of +-1 LSB
+	TriangularDither,
+	//! Triangular dither with second order highpass shaping of the
+	//! quantization error, moving it away from the most audible range
+	NoiseShapedDither
+} ;
+
+
+//! Keeps the per-channel state of a dithering conversion between buffers
+class LMMS_EXPORT Ditherer
+{
+public:
+	Ditherer( DitherModes mode = NoDither );
+
+	DitherModes mode() const
+	{
+		return m_mode;
+	}
+
+	void setMode( DitherModes mode );
+
+	//! Mode configured in the "mixer" section, "dither" key
+	static DitherModes configuredMode();
+
+	//! Round value to an integer in [-max, max] with dither applied
+	float quantize( ch_cnt_t chnl, float value, float max );
+
+private:
+	float noise();
+
+	DitherModes m_mode;
+	uint32_t m_seed;
+	float m_error[SURROUND_CHANNELS][2];
+
+} ;
+
+
+//! Interleaved 32 bit float, clipped only if clip is set
+LMMS_EXPORT void toFloat( const surroundSampleFrame * src, int frames,
+				ch_cnt_t channels, float gain, float * dst,
+							bool clip = false );
+
+//! One 32 bit float buffer per channel, dst[chnl] starting at offset
+LMMS_EXPORT void toPlanarFloat( const surroundSampleFrame * src, int frames,
+				ch_cnt_t channels, float gain,
+				float * const * dst, int offset = 0 );
+
+//! Interleaved signed 16 bit
+LMMS_EXPORT void toS16( const surroundSampleFrame * src, int frames,
+				ch_cnt_t channels, float gain, int16_t * dst,
+				bool swapEndian = false,
+				Ditherer * ditherer = nullptr );
+
+//! Interleaved signed 24 bit, stored in the lower three bytes of 32 bits
+LMMS_EXPORT void toS24( const surroundSampleFrame * src, int frames,
+				ch_cnt_t channels, float gain, int32_t * dst,
+				Ditherer * ditherer = nullptr );
+
+//! Interleaved signed 32 bit
+LMMS_EXPORT void toS32( const surroundSampleFrame * src, int frames,
+				ch_cnt_t channels, float gain, int32_t * dst );
+
+//! Swap the byte order of given 16 bit samples
+LMMS_EXPORT void swapEndian( int16_t * buf, int samples );
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * SampleDataBundle.h - side-car file holding sample data of a project
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SAMPLE_DATA_BUNDLE_H
+#define SAMPLE_DATA_BUNDLE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+#include "lmms_export.h"
+#include "lmms_basics.h"
+
+
+//! Stores sample data that isn't backed by a file (recordings, dropped
+//! sample data etc.) next to a project instead of base64-encoding it into
+//! the XML. The data is raw little-endian float PCM in page-aligned chunks,
+//! so the file is mapped on load and only the pages actually referenced
+//! are read. The project refers to a chunk by its offset and frame count.
+class LMMS_EXPORT SampleDataBundle
+{
+public:
+	static const qint64 PageSize = 4096;
+
+	SampleDataBundle();
+	~SampleDataBundle();
+
+	//! Name of the bundle file belonging to given project file
+	static QString fileNameFor( const QString & projectFile );
+
+	// writing
+	//! Queue given data for writing and return the offset it will be
+	//! stored at
+	qint64 add( const sampleFrame * data, f_cnt_t frames );
+	bool isEmpty() const
+	{
+		return m_chunks.isEmpty();
+	}
+	bool writeFile( const QString & fileName ) const;
+
+	// reading
+	bool open( const QString & fileName );
+	bool isOpen() const
+	{
+		return m_map != NULL;
+	}
+	//! Copy a chunk to dst, which must hold at least frames frames
+	bool read( qint64 offset, f_cnt_t frames, sampleFrame * dst ) const;
+
+private:
+	static const char Magic[8];
+	static const quint32 Version = 1;
+
+	QList<QByteArray> m_chunks;
+	qint64 m_writeOffset;
+
+	QFile m_file;
+	const uchar * m_map;
+	qint64 m_mapSize;
+
+} ;
+
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * SamplePeakCache.h - multi-resolution min/max/RMS summary of sample data
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SAMPLE_PEAK_CACHE_H
+#define SAMPLE_PEAK_CACHE_H
+
+#include <vector>
+
+#include "lmms_export.h"
+#include "lmms_basics.h"
+
+
+//! Pyramid of per-block peaks used for drawing waveforms. Level 0 summarizes
+//! BaseBlockSize frames per entry, every following level halves the number of
+//! entries. Querying a frame range costs O(1) block lookups regardless of the
+//! length of the range, so views can draw in O(pixels).
+class LMMS_EXPORT SamplePeakCache
+{
+public:
+	static const f_cnt_t BaseBlockSize = 256;
+
+	struct Peak
+	{
+		sample_t min;
+		sample_t max;
+		float meanSquare;
+
+		float rms() const;
+	} ;
+
+	SamplePeakCache();
+
+	//! Summarizes given data. Can be run on a thread of its own, which
+	//! stops early and leaves the cache invalid if interruption of the
+	//! thread is requested.
+	void build( const sampleFrame * data, f_cnt_t frames );
+	void clear();
+
+	bool isValid() const
+	{
+		return m_valid;
+	}
+
+	f_cnt_t frames() const
+	{
+		return m_frames;
+	}
+
+	//! Returns the peak of channel ch in the frame range [from, to). Ranges
+	//! shorter than a block are evaluated on the raw data, longer ranges
+	//! are snapped to the block grid of the coarsest level that still
+	//! resolves them.
+	Peak query( const sampleFrame * data, f_cnt_t from, f_cnt_t to,
+							ch_cnt_t ch ) const;
+
+private:
+	typedef std::vector<Peak> Level;
+
+	//! Number of frames covered by given block of given level
+	f_cnt_t blockFrames( size_t level, size_t block ) const;
+
+	static Peak merge( const Peak & a, f_cnt_t aFrames,
+					const Peak & b, f_cnt_t bFrames );
+
+	std::vector<Level> m_levels[DEFAULT_CHANNELS];
+	f_cnt_t m_frames;
+	bool m_valid;
+
+} ;
+
+
+#endif
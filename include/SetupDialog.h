@@ -77,6 +77,7 @@ private slots:
 	void toggleMMPZ(bool enabled);
 	void toggleDisableBackup(bool enabled);
 	void toggleOpenLastProject(bool enabled);
+	void toggleSampleBundle(bool enabled);
 	void setLanguage(int lang);
 
 	// Performance settings widget.
@@ -90,6 +91,8 @@ private slots:
 	void vstEmbedMethodChanged();
 	void toggleVSTAlwaysOnTop(bool en);
 	void toggleDisableAutoQuit(bool enabled);
+	void toggleBBRenderCache(bool enabled);
+	void togglePipelineRemotePlugins(bool enabled);
 
 	// Audio settings widget.
 	void audioInterfaceChanged(const QString & driver);
@@ -133,6 +136,7 @@ private:
 	bool m_MMPZ;
 	bool m_disableBackup;
 	bool m_openLastProject;
+	bool m_sampleBundle;
 	QString m_lang;
 	QStringList m_languages;
 
@@ -153,6 +157,8 @@ private:
 	bool m_vstAlwaysOnTop;
 	bool m_syncVSTPlugins;
 	bool m_disableAutoQuit;
+	bool m_bbRenderCache;
+	bool m_pipelineRemotePlugins;
 
 
 	typedef QMap<QString, AudioDeviceSetupWidget *> AswMap;
@@ -39,6 +39,7 @@
 
 class AutomationTrack;
 class Pattern;
+class SampleDataBundle;
 class TimeLineWidget;
 
 
@@ -208,6 +209,11 @@ public:
 		m_exportLoop = exportLoop;
 	}
 
+	inline bool exportLoop() const
+	{
+		return m_exportLoop;
+	}
+
 	inline bool isRecording() const
 	{
 		return m_recording;
@@ -235,6 +241,11 @@ public:
 		m_renderBetweenMarkers = renderBetweenMarkers;
 	}
 
+	inline bool renderBetweenMarkers() const
+	{
+		return m_renderBetweenMarkers;
+	}
+
 	inline PlayModes playMode() const
 	{
 		return m_playMode;
@@ -274,7 +285,8 @@ public:
 	// file management
 	void createNewProject();
 	void createNewProjectFromTemplate( const QString & templ );
-	void loadProject( const QString & filename );
+	// returns false if the file couldn't be read or loading was cancelled
+	bool loadProject( const QString & filename );
 	bool guiSaveProject();
 	bool guiSaveProjectAs( const QString & filename );
 	bool saveProjectFile( const QString & filename );
@@ -339,6 +351,13 @@ public:
 
 	bool isSavingProject() const;
 
+	//! Bundle holding the project's embedded sample data, only valid
+	//! while saving or loading a project that uses one
+	SampleDataBundle * sampleDataBundle() const
+	{
+		return m_sampleDataBundle;
+	}
+
 public slots:
 	void playSong();
 	void record();
@@ -437,6 +456,7 @@ private:
 
 	bool m_savingProject;
 	bool m_loadingProject;
+	SampleDataBundle * m_sampleDataBundle;
 	bool m_isCancelled;
 
 	SaveOptions m_saveOptions;
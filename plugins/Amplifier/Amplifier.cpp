@@ -52,6 +52,7 @@ AmplifierEffect::AmplifierEffect( Model* parent, const Descriptor::SubPluginFeat
 	Effect( &amplifier_plugin_descriptor, parent, key ),
 	m_ampControls( this )
 {
+	setWetOnly( true );
 }
 
 
@@ -64,17 +65,8 @@ AmplifierEffect::~AmplifierEffect()
 
 
 
-bool AmplifierEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+void AmplifierEffect::processWetBuffer( sampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-	
 	const ValueBuffer * volBuf = m_ampControls.m_volumeModel.valueBuffer();
 	const ValueBuffer * panBuf = m_ampControls.m_panModel.valueBuffer();
 	const ValueBuffer * leftBuf = m_ampControls.m_leftModel.valueBuffer();
@@ -83,8 +75,6 @@ bool AmplifierEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	for( fpp_t f = 0; f < frames; ++f )
 	{
 //		qDebug( "offset %d, value %f", f, m_ampControls.m_volumeModel.value( f ) );
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
-	
 		sample_t s[2] = { buf[f][0], buf[f][1] };
 
 		// vol knob
@@ -121,13 +111,9 @@ bool AmplifierEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 		s[0] *= left1 * left2 * 0.01;
 		s[1] *= right1 * right2 * 0.01;
 
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
+		buf[f][0] = s[0];
+		buf[f][1] = s[1];
 	}
-
-	checkGate( outSum / frames );
-
-	return isRunning();
 }
 
 
@@ -36,7 +36,6 @@ class AmplifierEffect : public Effect
 public:
 	AmplifierEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~AmplifierEffect();
-	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 
 	virtual EffectControls* controls()
 	{
@@ -44,6 +43,10 @@ public:
 	}
 
 
+protected:
+	virtual void processWetBuffer( sampleFrame* buf, const fpp_t frames );
+
+
 private:
 	AmplifierControls m_ampControls;
 
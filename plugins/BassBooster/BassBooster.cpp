@@ -53,6 +53,8 @@ BassBoosterEffect::BassBoosterEffect( Model* parent, const Descriptor::SubPlugin
 	m_bbFX( DspEffectLibrary::FastBassBoost( 70.0f, 1.0f, 2.8f ) ),
 	m_bbControls( this )
 {
+	setWetOnly( true );
+
 	changeFrequency();
 	changeGain();
 	changeRatio();
@@ -68,12 +70,8 @@ BassBoosterEffect::~BassBoosterEffect()
 
 
 
-bool BassBoosterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+void BassBoosterEffect::processWetBuffer( sampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
 	// check out changed controls
 	if( m_frequencyChangeNeeded || m_bbControls.m_freqModel.isValueChanged() )
 	{
@@ -86,10 +84,6 @@ bool BassBoosterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 	const float const_gain = m_bbControls.m_gainModel.value();
 	const ValueBuffer *gainBuffer = m_bbControls.m_gainModel.valueBuffer();
 
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-
 	for( fpp_t f = 0; f < frames; ++f )
 	{
 		float gain = const_gain;
@@ -100,18 +94,9 @@ bool BassBoosterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		//float gain = gainBuffer ? gainBuffer[f] : gain;
 		m_bbFX.leftFX().setGain( gain );
 		m_bbFX.rightFX().setGain( gain);
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
 
-		sample_t s[2] = { buf[f][0], buf[f][1] };
-		m_bbFX.nextSample( s[0], s[1] );
-
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
+		m_bbFX.nextSample( buf[f][0], buf[f][1] );
 	}
-
-	checkGate( outSum / frames );
-
-	return isRunning();
 }
 
 
@@ -36,7 +36,6 @@ class BassBoosterEffect : public Effect
 public:
 	BassBoosterEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~BassBoosterEffect();
-	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 
 	virtual EffectControls* controls()
 	{
@@ -45,6 +44,8 @@ public:
 
 
 protected:
+	virtual void processWetBuffer( sampleFrame* buf, const fpp_t frames );
+
 	void changeFrequency();
 	void changeGain();
 	void changeRatio();
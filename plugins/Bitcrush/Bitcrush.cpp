@@ -27,12 +27,9 @@
 #include "embed.h"
 #include "plugin_export.h"
 
-const int OS_RATE = 5;
-const float OS_RATIO = 1.0f / OS_RATE;
+const int OS_RATE = 4;
 const float CUTOFF_RATIO = 0.353553391f;
 const int SILENCEFRAMES = 10;
-const float OS_RESAMPLE [5] = { 0.0001490062883964112, 0.1645978376763992, 0.6705063120704088,
-		0.1645978376763992, 0.0001490062883964112 };
 
 extern "C"
 {
@@ -56,10 +53,14 @@ BitcrushEffect::BitcrushEffect( Model * parent, const Descriptor::SubPluginFeatu
 	Effect( &bitcrush_plugin_descriptor, parent, key ),
 	m_controls( this ),
 	m_sampleRate( Engine::mixer()->processingSampleRate() ),
-	m_filter( m_sampleRate )
+	m_oversampler( Oversampler::localFactor( OS_RATE ),
+				Engine::mixer()->framesPerPeriod() ),
+	m_filter( m_sampleRate * m_oversampler.factor() )
 {
-	m_buffer = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() * OS_RATE );
-	m_filter.setLowpass( m_sampleRate * ( CUTOFF_RATIO * OS_RATIO ) );
+	setWetOnly( true );
+	latencyChanged();
+
+	m_filter.setLowpass( m_sampleRate * CUTOFF_RATIO );
 	m_needsUpdate = true;
 	
 	m_bitCounterL = 0.0f;
@@ -73,15 +74,18 @@ BitcrushEffect::BitcrushEffect( Model * parent, const Descriptor::SubPluginFeatu
 
 BitcrushEffect::~BitcrushEffect()
 {
-	MM_FREE( m_buffer );
 }
 
 
 void BitcrushEffect::sampleRateChanged()
 {
 	m_sampleRate = Engine::mixer()->processingSampleRate();
-	m_filter.setSampleRate( m_sampleRate );
-	m_filter.setLowpass( m_sampleRate * ( CUTOFF_RATIO * OS_RATIO ) );
+	if( m_oversampler.setFactor( Oversampler::localFactor( OS_RATE ) ) )
+	{
+		latencyChanged();
+	}
+	m_filter.setSampleRate( m_sampleRate * m_oversampler.factor() );
+	m_filter.setLowpass( m_sampleRate * CUTOFF_RATIO );
 	m_needsUpdate = true;
 }
 
@@ -96,13 +100,8 @@ inline float BitcrushEffect::noise( float amt )
 	return fastRandf( amt * 2.0f ) - amt;
 }
 
-bool BitcrushEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+void BitcrushEffect::processWetBuffer( sampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-
 	// update values
 	if( m_needsUpdate || m_controls.m_rateEnabled.isValueChanged() )
 	{
@@ -119,8 +118,8 @@ bool BitcrushEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 		const float rate = m_controls.m_rate.value();
 		const float diff = m_controls.m_stereoDiff.value() * 0.005 * rate;
 
-		m_rateCoeffL = ( m_sampleRate * OS_RATE ) / ( rate - diff );
-		m_rateCoeffR = ( m_sampleRate * OS_RATE ) / ( rate + diff );
+		m_rateCoeffL = ( m_sampleRate * m_oversampler.factor() ) / ( rate - diff );
+		m_rateCoeffR = ( m_sampleRate * m_oversampler.factor() ) / ( rate + diff );
 		
 		m_bitCounterL = 0.0f;
 		m_bitCounterR = 0.0f;
@@ -146,98 +145,82 @@ bool BitcrushEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	
 	const float noiseAmt = m_controls.m_inNoise.value() * 0.01f;
 	
-	// read input buffer and write it to oversampled buffer
+	// upsample the input and crush it in place
+	sampleFrame * os = m_oversampler.upsample( buf, frames );
+	const int osFrames = frames * m_oversampler.factor();
+
 	if( m_rateEnabled ) // rate crushing enabled so do that
 	{
-		for( int f = 0; f < frames; ++f )
+		for( int f = 0; f < osFrames; ++f )
 		{
-			for( int o = 0; o < OS_RATE; ++o )
+			const sample_t s[2] = { os[f][0], os[f][1] };
+			os[f][0] = m_left;
+			os[f][1] = m_right;
+			m_bitCounterL += 1.0f;
+			m_bitCounterR += 1.0f;
+			if( m_bitCounterL > m_rateCoeffL )
+			{
+				m_bitCounterL -= m_rateCoeffL;
+				m_left = m_depthEnabled 
+					? depthCrush( s[0] * m_inGain + noise( s[0] * noiseAmt ) ) 
+					: s[0] * m_inGain + noise( s[0] * noiseAmt );
+			}
+			if( m_bitCounterR > m_rateCoeffR )
 			{
-				m_buffer[f * OS_RATE + o][0] = m_left;
-				m_buffer[f * OS_RATE + o][1] = m_right;
-				m_bitCounterL += 1.0f;
-				m_bitCounterR += 1.0f;
-				if( m_bitCounterL > m_rateCoeffL )
-				{
-					m_bitCounterL -= m_rateCoeffL;
-					m_left = m_depthEnabled 
-						? depthCrush( buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt ) ) 
-						: buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt );
-				}
-				if( m_bitCounterR > m_rateCoeffR )
-				{
-					m_bitCounterR -= m_rateCoeffR;
-					m_right = m_depthEnabled 
-						? depthCrush( buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt ) ) 
-						: buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt );
-				}
+				m_bitCounterR -= m_rateCoeffR;
+				m_right = m_depthEnabled 
+					? depthCrush( s[1] * m_inGain + noise( s[1] * noiseAmt ) ) 
+					: s[1] * m_inGain + noise( s[1] * noiseAmt );
 			}
 		}
 	}
-	else // rate crushing disabled: simply oversample with zero-order hold
+	else // rate crushing disabled
 	{
-		for( int f = 0; f < frames; ++f )
+		for( int f = 0; f < osFrames; ++f )
 		{
-			for( int o = 0; o < OS_RATE; ++o )
-			{
-				m_buffer[f * OS_RATE + o][0] = m_depthEnabled
-					? depthCrush( buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt ) ) 
-					: buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt );
-				m_buffer[f * OS_RATE + o][1] = m_depthEnabled
-					? depthCrush( buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt ) ) 
-					: buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt );
-			}
+			os[f][0] = m_depthEnabled
+				? depthCrush( os[f][0] * m_inGain + noise( os[f][0] * noiseAmt ) ) 
+				: os[f][0] * m_inGain + noise( os[f][0] * noiseAmt );
+			os[f][1] = m_depthEnabled
+				? depthCrush( os[f][1] * m_inGain + noise( os[f][1] * noiseAmt ) ) 
+				: os[f][1] * m_inGain + noise( os[f][1] * noiseAmt );
 		}
 	}
 	
 	// the oversampled buffer is now written, so filter it to reduce aliasing
 	
-	for( int f = 0; f < frames * OS_RATE; ++f )
+	for( int f = 0; f < osFrames; ++f )
 	{
-		if( qMax( qAbs( m_buffer[f][0] ), qAbs( m_buffer[f][1] ) ) >= 1.0e-10f )
+		if( qMax( qAbs( os[f][0] ), qAbs( os[f][1] ) ) >= 1.0e-10f )
 		{
 			m_silenceCounter = 0;
-			m_buffer[f][0] = m_filter.update( m_buffer[f][0], 0 );
-			m_buffer[f][1] = m_filter.update( m_buffer[f][1], 1 );
+			os[f][0] = m_filter.update( os[f][0], 0 );
+			os[f][1] = m_filter.update( os[f][1], 1 );
 		}
 		else
 		{
 			if( m_silenceCounter > SILENCEFRAMES )
 			{
-				m_buffer[f][0] = m_buffer[f][1] = 0.0f;
+				os[f][0] = os[f][1] = 0.0f;
 			}
 			else
 			{
 				++m_silenceCounter;
-				m_buffer[f][0] = m_filter.update( m_buffer[f][0], 0 );
-				m_buffer[f][1] = m_filter.update( m_buffer[f][1], 1 );
+				os[f][0] = m_filter.update( os[f][0], 0 );
+				os[f][1] = m_filter.update( os[f][1], 1 );
 			}
 		}
 	}
 	
 	
 	// now downsample and write it back to main buffer
-	
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
+	m_oversampler.downsample( buf, frames );
+
 	for( int f = 0; f < frames; ++f )
 	{
-		float lsum = 0.0f;
-		float rsum = 0.0f;
-		for( int o = 0; o < OS_RATE; ++o )
-		{
-			lsum += m_buffer[f * OS_RATE + o][0] * OS_RESAMPLE[o];
-			rsum += m_buffer[f * OS_RATE + o][1] * OS_RESAMPLE[o];
-		}
-		buf[f][0] = d * buf[f][0] + w * qBound( -m_outClip, lsum, m_outClip ) * m_outGain;
-		buf[f][1] = d * buf[f][1] + w * qBound( -m_outClip, rsum, m_outClip ) * m_outGain;
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
+		buf[f][0] = qBound( -m_outClip, buf[f][0], m_outClip ) * m_outGain;
+		buf[f][1] = qBound( -m_outClip, buf[f][1], m_outClip ) * m_outGain;
 	}
-	
-	checkGate( outSum / frames );
-
-	return isRunning();
 }
 
 
@@ -32,19 +32,27 @@
 #include "ValueBuffer.h"
 #include "lmms_math.h"
 #include "BasicFilters.h"
+#include "Oversampler.h"
 
 class BitcrushEffect : public Effect
 {
 public:
 	BitcrushEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~BitcrushEffect();
-	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 
 	virtual EffectControls* controls()
 	{
 		return &m_controls;
 	}
+
+	virtual f_cnt_t latency() const
+	{
+		return m_oversampler.latency();
+	}
 	
+protected:
+	virtual void processWetBuffer( sampleFrame* buf, const fpp_t frames );
+
 private:
 	void sampleRateChanged();
 	float depthCrush( float in );
@@ -52,8 +60,8 @@ private:
 
 	BitcrushControls m_controls;
 	
-	sampleFrame * m_buffer;
 	float m_sampleRate;
+	Oversampler m_oversampler;
 	StereoLinkwitzRiley m_filter;
 	
 	float m_bitCounterL;
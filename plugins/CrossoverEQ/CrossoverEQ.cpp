@@ -60,6 +60,8 @@ CrossoverEQEffect::CrossoverEQEffect( Model* parent, const Descriptor::SubPlugin
 	m_hp4( m_sampleRate ),
 	m_needsUpdate( true )
 {
+	setWetOnly( true );
+
 	m_tmp1 = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() );
 	m_tmp2 = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() );
 	m_work = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() );
@@ -85,13 +87,8 @@ void CrossoverEQEffect::sampleRateChanged()
 }
 
 
-bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+void CrossoverEQEffect::processWetBuffer( sampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-	
 	// filters update
 	if( m_needsUpdate || m_controls.m_xover12.isValueChanged() )
 	{
@@ -186,19 +183,7 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		}
 	}
 	
-	const float d = dryLevel();
-	const float w = wetLevel();
-	double outSum = 0.0;
-	for( int f = 0; f < frames; ++f )
-	{
-		outSum = buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
-		buf[f][0] = d * buf[f][0] + w * m_work[f][0];
-		buf[f][1] = d * buf[f][1] + w * m_work[f][1];
-	}
-	
-	checkGate( outSum );
-	
-	return isRunning();
+	memcpy( buf, m_work, sizeof( sampleFrame ) * frames );
 }
 
 void CrossoverEQEffect::clearFilterHistories()
@@ -38,7 +38,6 @@ class CrossoverEQEffect : public Effect
 public:
 	CrossoverEQEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~CrossoverEQEffect();
-	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 
 	virtual EffectControls* controls()
 	{
@@ -47,6 +46,9 @@ public:
 
 	void clearFilterHistories();
 	
+protected:
+	virtual void processWetBuffer( sampleFrame* buf, const fpp_t frames );
+
 private:
 	CrossoverEQControls m_controls;
 
@@ -55,6 +55,7 @@ DelayEffect::DelayEffect( Model* parent, const Plugin::Descriptor::SubPluginFeat
 	m_delay = new StereoDelay( 20, Engine::mixer()->processingSampleRate() );
 	m_lfo = new Lfo( Engine::mixer()->processingSampleRate() );
 	m_outGain = 1.0;
+	setWetOnly( true );
 }
 
 
@@ -75,17 +76,21 @@ DelayEffect::~DelayEffect()
 
 
 
-bool DelayEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+f_cnt_t DelayEffect::tailLength() const
+{
+	// the output is silent between echoes for up to the modulated length
+	// of the delay
+	return ( m_delayControls.m_delayTimeModel.value() +
+			m_delayControls.m_lfoAmountModel.value() ) *
+				Engine::mixer()->processingSampleRate();
+}
+
+
+
+
+void DelayEffect::processWetBuffer( sampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-	double outSum = 0.0;
 	const float sr = Engine::mixer()->processingSampleRate();
-	const float d = dryLevel();
-	const float w = wetLevel();
-	sample_t dryS[2];
 	float lPeak = 0.0;
 	float rPeak = 0.0;
 	float length = m_delayControls.m_delayTimeModel.value();
@@ -112,9 +117,6 @@ bool DelayEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	int sampleLength;
 	for( fpp_t f = 0; f < frames; ++f )
 	{
-		dryS[0] = buf[f][0];
-		dryS[1] = buf[f][1];
-
 		m_delay->setFeedback( *feedbackPtr );
 		m_lfo->setFrequency( *lfoTimePtr );
 		sampleLength = *lengthPtr * Engine::mixer()->processingSampleRate();
@@ -128,20 +130,13 @@ bool DelayEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 		lPeak = buf[f][0] > lPeak ? buf[f][0] : lPeak;
 		rPeak = buf[f][1] > rPeak ? buf[f][1] : rPeak;
 
-		buf[f][0] = ( d * dryS[0] ) + ( w * buf[f][0] );
-		buf[f][1] = ( d * dryS[1] ) + ( w * buf[f][1] );
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
-
 		lengthPtr += lengthInc;
 		amplitudePtr += amplitudeInc;
 		lfoTimePtr += lfoTimeInc;
 		feedbackPtr += feedbackInc;
 	}
-	checkGate( outSum / frames );
 	m_delayControls.m_outPeakL = lPeak;
 	m_delayControls.m_outPeakR = rPeak;
-
-	return isRunning();
 }
 
 void DelayEffect::changeSampleRate()
@@ -36,13 +36,17 @@ class DelayEffect : public Effect
 public:
 	DelayEffect(Model* parent , const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~DelayEffect();
-	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 	virtual EffectControls* controls()
 	{
 		return &m_delayControls;
 	}
 	void changeSampleRate();
 
+	virtual f_cnt_t tailLength() const;
+
+protected:
+	virtual void processWetBuffer( sampleFrame* buf, const fpp_t frames );
+
 private:
 	DelayControls m_delayControls;
 	StereoDelay* m_delay;
@@ -59,6 +59,8 @@ DualFilterEffect::DualFilterEffect( Model* parent, const Descriptor::SubPluginFe
 	// ensure filters get updated
 	m_filter1changed = true;
 	m_filter2changed = true;
+
+	setWetOnly( true );
 }
 
 
@@ -73,17 +75,8 @@ DualFilterEffect::~DualFilterEffect()
 
 
 
-bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+void DualFilterEffect::processWetBuffer( sampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-
     if( m_dfControls.m_filter1Model.isValueChanged() || m_filter1changed )
 	{
 		m_filter1->setFilterType( m_dfControls.m_filter1Model.value() );
@@ -193,11 +186,9 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 			s[0] += ( s2[0] * mix2 );
 			s[1] += ( s2[1] * mix2 );
 		}
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
 
-		// do another mix with dry signal
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
+		buf[f][0] = s[0];
+		buf[f][1] = s[1];
 
 		//increment pointers
 		cut1Ptr += cut1Inc;
@@ -208,10 +199,6 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		gain2Ptr += gain2Inc;
 		mixPtr += mixInc;
 	}
-
-	checkGate( outSum / frames );
-
-	return isRunning();
 }
 
 
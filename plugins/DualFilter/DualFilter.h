@@ -36,7 +36,6 @@ class DualFilterEffect : public Effect
 public:
 	DualFilterEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~DualFilterEffect();
-	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 
 	virtual EffectControls* controls()
 	{
@@ -44,6 +43,9 @@ public:
 	}
 
 
+protected:
+	virtual void processWetBuffer( sampleFrame* buf, const fpp_t frames );
+
 private:
 	DualFilterControls m_dfControls;
 
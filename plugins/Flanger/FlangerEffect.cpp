@@ -55,6 +55,7 @@ FlangerEffect::FlangerEffect( Model *parent, const Plugin::Descriptor::SubPlugin
 	m_lDelay = new MonoDelay( 1, Engine::mixer()->processingSampleRate() );
 	m_rDelay = new MonoDelay( 1, Engine::mixer()->processingSampleRate() );
 	m_noise = new Noise;
+	setWetOnly( true );
 }
 
 
@@ -83,15 +84,8 @@ FlangerEffect::~FlangerEffect()
 
 
 
-bool FlangerEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
+void FlangerEffect::processWetBuffer( sampleFrame *buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
 	const float length = m_flangerControls.m_delayTimeModel.value() * Engine::mixer()->processingSampleRate();
 	const float noise = m_flangerControls.m_whiteNoiseAmountModel.value();
 	float amplitude = m_flangerControls.m_lfoAmountModel.value() * Engine::mixer()->processingSampleRate();
@@ -99,15 +93,12 @@ bool FlangerEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 	m_lfo->setFrequency(  1.0/m_flangerControls.m_lfoFrequencyModel.value() );
 	m_lDelay->setFeedback( m_flangerControls.m_feedbackModel.value() );
 	m_rDelay->setFeedback( m_flangerControls.m_feedbackModel.value() );
-	sample_t dryS[2];
 	float leftLfo;
 	float rightLfo;
 	for( fpp_t f = 0; f < frames; ++f )
 	{
 		buf[f][0] += m_noise->tick() * noise;
 		buf[f][1] += m_noise->tick() * noise;
-		dryS[0] = buf[f][0];
-		dryS[1] = buf[f][1];
 		m_lfo->tick(&leftLfo, &rightLfo);
 		m_lDelay->setLength( ( float )length + amplitude * (leftLfo+1.0)  );
 		m_rDelay->setLength( ( float )length + amplitude * (rightLfo+1.0)  );
@@ -120,13 +111,7 @@ bool FlangerEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 			m_lDelay->tick( &buf[f][0] );
 			m_rDelay->tick( &buf[f][1] );
 		}
-
-		buf[f][0] = ( d * dryS[0] ) + ( w * buf[f][0] );
-		buf[f][1] = ( d * dryS[1] ) + ( w * buf[f][1] );
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
 	}
-	checkGate( outSum / frames );
-	return isRunning();
 }
 
 
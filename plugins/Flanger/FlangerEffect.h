@@ -38,7 +38,6 @@ class FlangerEffect : public Effect
 public:
 	FlangerEffect( Model* parent , const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~FlangerEffect();
-	virtual bool processAudioBuffer( sampleFrame *buf, const fpp_t frames );
 	virtual EffectControls* controls()
 	{
 		return &m_flangerControls;
@@ -46,6 +45,9 @@ public:
 	void changeSampleRate();
 	void restartLFO();
 
+protected:
+	virtual void processWetBuffer( sampleFrame *buf, const fpp_t frames );
+
 private:
 	FlangerControls m_flangerControls;
 	MonoDelay* m_lDelay;
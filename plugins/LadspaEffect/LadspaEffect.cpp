@@ -24,6 +24,7 @@
  */
 
 
+#include <algorithm>
 #include <QtCore/QVarLengthArray>
 #include <QMessageBox>
 
@@ -72,7 +73,11 @@ LadspaEffect::LadspaEffect( Model * _parent,
 	Effect( &ladspaeffect_plugin_descriptor, _parent, _key ),
 	m_controls( NULL ),
 	m_maxSampleRate( 0 ),
-	m_key( LadspaSubPluginFeatures::subPluginKeyToLadspaKey( _key ) )
+	m_key( LadspaSubPluginFeatures::subPluginKeyToLadspaKey( _key ) ),
+	m_audioRateFrames( 0 ),
+	m_connectedBuffer( NULL ),
+	m_latencyPort( NULL ),
+	m_latency( 0 )
 {
 	Ladspa2LMMS * manager = Engine::getLADSPAManager();
 	if( manager->getDescription( m_key ) == NULL )
@@ -151,107 +156,68 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 				Engine::mixer()->processingSampleRate();
 	}
 
-	// Copy the LMMS audio buffer to the LADSPA input buffer and initialize
-	// the control ports.  
-	ch_cnt_t channel = 0;
-	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
+	// Copy the LMMS audio buffer to the LADSPA input buffers, all channels
+	// in one pass
+	const int channels = m_inputPorts.size();
+	if( channels == DEFAULT_CHANNELS )
 	{
-		for( int port = 0; port < m_portCount; ++port )
+		LADSPA_Data * left = m_inputPorts[0]->buffer;
+		LADSPA_Data * right = m_inputPorts[1]->buffer;
+		for( fpp_t frame = 0; frame < frames; ++frame )
 		{
-			port_desc_t * pp = m_ports.at( proc ).at( port );
-			switch( pp->rate )
+			left[frame] = _buf[frame][0];
+			right[frame] = _buf[frame][1];
+		}
+	}
+	else
+	{
+		for( int channel = 0; channel < channels; ++channel )
+		{
+			LADSPA_Data * in = m_inputPorts[channel]->buffer;
+			for( fpp_t frame = 0; frame < frames; ++frame )
 			{
-				case CHANNEL_IN:
-					for( fpp_t frame = 0; 
-						frame < frames; ++frame )
-					{
-						pp->buffer[frame] = 
-							_buf[frame][channel];
-					}
-					++channel;
-					break;
-				case AUDIO_RATE_INPUT:
-				{
-					ValueBuffer * vb = pp->control->valueBuffer();
-					if( vb )
-					{
-						memcpy( pp->buffer, vb->values(), frames * sizeof(float) );
-					}
-					else
-					{
-						pp->value = static_cast<LADSPA_Data>( 
-											pp->control->value() / pp->scale );
-						// This only supports control rate ports, so the audio rates are
-						// treated as though they were control rate by setting the
-						// port buffer to all the same value.
-						for( fpp_t frame = 0; 
-							frame < frames; ++frame )
-						{
-							pp->buffer[frame] = 
-								pp->value;
-						}
-					}
-					break;
-				}
-				case CONTROL_RATE_INPUT:
-					if( pp->control == NULL )
-					{
-						break;
-					}
-					pp->value = static_cast<LADSPA_Data>( 
-										pp->control->value() / pp->scale );
-					pp->buffer[0] = 
-						pp->value;
-					break;
-				case CHANNEL_OUT:
-				case AUDIO_RATE_OUTPUT:
-				case CONTROL_RATE_OUTPUT:
-					break;
-				default:
-					break;
+				in[frame] = _buf[frame][channel];
 			}
 		}
 	}
 
+	connectChannelPorts( NULL );
+	updateControls( frames );
 
 	// Process the buffers.
 	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
 	{
 		(m_descriptor->run)( m_handles[proc], frames );
 	}
+	updateLatency();
 
 	// Copy the LADSPA output buffers to the LMMS buffer.
 	double out_sum = 0.0;
-	channel = 0;
 	const float d = dryLevel();
 	const float w = wetLevel();
-	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
+	for( int channel = 0; channel < m_outputPorts.size(); ++channel )
 	{
-		for( int port = 0; port < m_portCount; ++port )
+		const LADSPA_Data * out = m_outputPorts[channel]->buffer;
+		float channelSum = 0.0f;
+		if( d == 0.0f && w == 1.0f )
 		{
-			port_desc_t * pp = m_ports.at( proc ).at( port );
-			switch( pp->rate )
+			for( fpp_t frame = 0; frame < frames; ++frame )
 			{
-				case CHANNEL_IN:
-				case AUDIO_RATE_INPUT:
-				case CONTROL_RATE_INPUT:
-					break;
-				case CHANNEL_OUT:
-					for( fpp_t frame = 0; 
-						frame < frames; ++frame )
-					{
-						_buf[frame][channel] = d * _buf[frame][channel] + w * pp->buffer[frame];
-						out_sum += _buf[frame][channel] * _buf[frame][channel];
-					}
-					++channel;
-					break;
-				case AUDIO_RATE_OUTPUT:
-				case CONTROL_RATE_OUTPUT:
-					break;
-				default:
-					break;
+				_buf[frame][channel] = out[frame];
+				channelSum += out[frame] * out[frame];
+			}
+		}
+		else
+		{
+			for( fpp_t frame = 0; frame < frames; ++frame )
+			{
+				const sample_t s = d * _buf[frame][channel] +
+								w * out[frame];
+				_buf[frame][channel] = s;
+				channelSum += s * s;
 			}
 		}
+		out_sum += channelSum;
 	}
 
 	if( o_buf != NULL )
@@ -270,6 +236,196 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 
 
 
+bool LadspaEffect::processPlanarBuffer( PlanarBuffer & _buf,
+							const fpp_t _frames )
+{
+	if( preferredLayout() != PlanarLayout )
+	{
+		return Effect::processPlanarBuffer( _buf, _frames );
+	}
+
+	m_pluginMutex.lock();
+	if( !isOkay() || dontRun() || !isRunning() || !isEnabled() )
+	{
+		m_pluginMutex.unlock();
+		return( false );
+	}
+
+	// Without dry signal to mix in, the plugin can run on the buffers of
+	// the effect chain directly.
+	const float d = dryLevel();
+	const float w = wetLevel();
+	const bool direct = d == 0.0f && w == 1.0f;
+	if( direct )
+	{
+		connectChannelPorts( &_buf );
+	}
+	else
+	{
+		connectChannelPorts( NULL );
+		for( int channel = 0; channel < m_inputPorts.size(); ++channel )
+		{
+			memcpy( m_inputPorts[channel]->buffer,
+					_buf.channel( channel ),
+					_frames * sizeof( LADSPA_Data ) );
+		}
+	}
+	updateControls( _frames );
+
+	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
+	{
+		(m_descriptor->run)( m_handles[proc], _frames );
+	}
+	updateLatency();
+
+	double out_sum = 0.0;
+	for( int channel = 0; channel < m_outputPorts.size(); ++channel )
+	{
+		sample_t * buf = _buf.channel( channel );
+		const LADSPA_Data * out = m_outputPorts[channel]->buffer;
+		float channelSum = 0.0f;
+		if( !direct )
+		{
+			for( fpp_t frame = 0; frame < _frames; ++frame )
+			{
+				buf[frame] = d * buf[frame] + w * out[frame];
+				channelSum += buf[frame] * buf[frame];
+			}
+		}
+		else if( m_inPlaceBroken )
+		{
+			for( fpp_t frame = 0; frame < _frames; ++frame )
+			{
+				buf[frame] = out[frame];
+				channelSum += out[frame] * out[frame];
+			}
+		}
+		else
+		{
+			for( fpp_t frame = 0; frame < _frames; ++frame )
+			{
+				channelSum += buf[frame] * buf[frame];
+			}
+		}
+		out_sum += channelSum;
+	}
+
+	checkGate( out_sum / _frames );
+
+
+	bool is_running = isRunning();
+	m_pluginMutex.unlock();
+	return( is_running );
+}
+
+
+
+
+Effect::BufferLayouts LadspaEffect::preferredLayout() const
+{
+	// plugins running at a lower sample rate are resampled in the
+	// interleaved layout
+	return m_maxSampleRate < Engine::mixer()->processingSampleRate() ?
+						InterleavedLayout : PlanarLayout;
+}
+
+
+
+
+void LadspaEffect::connectChannelPorts( PlanarBuffer * _buf )
+{
+	const sample_t * target = _buf ? _buf->channel( 0 ) : NULL;
+	if( target == m_connectedBuffer )
+	{
+		return;
+	}
+
+	for( int channel = 0; channel < m_inputPorts.size(); ++channel )
+	{
+		port_desc_t * pp = m_inputPorts[channel];
+		( m_descriptor->connect_port )( m_handles[pp->proc], pp->port_id,
+				_buf ? _buf->channel( channel ) : pp->buffer );
+	}
+	// outputs sharing the buffers of the inputs process in place
+	if( !m_inPlaceBroken )
+	{
+		for( int channel = 0; channel < m_outputPorts.size(); ++channel )
+		{
+			port_desc_t * pp = m_outputPorts[channel];
+			( m_descriptor->connect_port )( m_handles[pp->proc],
+					pp->port_id,
+					_buf ? _buf->channel( channel ) : pp->buffer );
+		}
+	}
+	m_connectedBuffer = target;
+}
+
+
+
+
+void LadspaEffect::updateLatency()
+{
+	if( m_latencyPort == NULL )
+	{
+		return;
+	}
+
+	// the port counts frames at the sample rate the plugin runs at
+	const f_cnt_t frames = static_cast<f_cnt_t>(
+				m_latencyPort->buffer[0] *
+				Engine::mixer()->processingSampleRate() /
+							m_maxSampleRate );
+	if( frames != m_latency )
+	{
+		m_latency = frames;
+		latencyChanged();
+	}
+}
+
+
+
+
+void LadspaEffect::updateControls( int _frames )
+{
+	// Constant values are only written when they changed.
+	if( _frames != m_audioRateFrames )
+	{
+		m_audioRateValid.fill( false );
+		m_audioRateFrames = _frames;
+	}
+	for( int i = 0; i < m_audioRateInputs.size(); ++i )
+	{
+		port_desc_t * pp = m_audioRateInputs[i];
+		ValueBuffer * vb = pp->control->valueBuffer();
+		if( vb )
+		{
+			memcpy( pp->buffer, vb->values(), _frames * sizeof(float) );
+			m_audioRateValid[i] = false;
+			continue;
+		}
+
+		pp->value = static_cast<LADSPA_Data>(
+					pp->control->value() / pp->scale );
+		if( !m_audioRateValid[i] || pp->buffer[0] != pp->value )
+		{
+			// This only supports control rate ports, so the audio
+			// rates are treated as though they were control rate by
+			// setting the port buffer to all the same value.
+			std::fill( pp->buffer, pp->buffer + _frames, pp->value );
+			m_audioRateValid[i] = true;
+		}
+	}
+	for( port_desc_t * pp : m_controlRateInputs )
+	{
+		pp->value = static_cast<LADSPA_Data>(
+					pp->control->value() / pp->scale );
+		pp->buffer[0] = pp->value;
+	}
+}
+
+
+
+
 void LadspaEffect::setControl( int _control, LADSPA_Data _value )
 {
 	if( !isOkay() )
@@ -473,6 +629,48 @@ void LadspaEffect::pluginInstantiation()
 		m_ports.append( ports );
 	}
 
+	// Sort the ports once so that processing doesn't have to look at each
+	// of them every period.
+	m_latencyPort = NULL;
+	for( const multi_proc_t & ports : m_ports )
+	{
+		for( port_desc_t * p : ports )
+		{
+			switch( p->rate )
+			{
+				case CHANNEL_IN:
+					m_inputPorts.append( p );
+					break;
+				case CHANNEL_OUT:
+					m_outputPorts.append( p );
+					break;
+				case AUDIO_RATE_INPUT:
+					m_audioRateInputs.append( p );
+					break;
+				case CONTROL_RATE_INPUT:
+					if( p->control != NULL )
+					{
+						m_controlRateInputs.append( p );
+					}
+					break;
+				case CONTROL_RATE_OUTPUT:
+					// plugins report their latency in an
+					// output port named "latency"
+					if( p->name.toLower() == "latency" &&
+							m_latencyPort == NULL )
+					{
+						m_latencyPort = p;
+					}
+					break;
+				default:
+					break;
+			}
+		}
+	}
+	m_audioRateValid.fill( false, m_audioRateInputs.size() );
+	m_audioRateFrames = 0;
+	m_connectedBuffer = NULL;
+
 	// Instantiate the processing units.
 	m_descriptor = manager->getDescriptor( m_key );
 	if( m_descriptor == NULL )
@@ -564,6 +762,10 @@ void LadspaEffect::pluginDestruction()
 	m_ports.clear();
 	m_handles.clear();
 	m_portControls.clear();
+	m_inputPorts.clear();
+	m_outputPorts.clear();
+	m_audioRateInputs.clear();
+	m_controlRateInputs.clear();
 }
 
 
@@ -31,6 +31,7 @@
 #include "Effect.h"
 #include "LadspaBase.h"
 #include "LadspaControls.h"
+#include "PlanarBuffer.h"
 
 
 typedef QVector<port_desc_t *> multi_proc_t;
@@ -45,6 +46,14 @@ public:
 
 	virtual bool processAudioBuffer( sampleFrame * _buf,
 							const fpp_t _frames );
+	virtual bool processPlanarBuffer( PlanarBuffer & _buf,
+							const fpp_t _frames );
+	virtual BufferLayouts preferredLayout() const;
+
+	virtual f_cnt_t latency() const
+	{
+		return m_latency;
+	}
 	
 	void setControl( int _control, LADSPA_Data _data );
 
@@ -67,6 +76,12 @@ private:
 	void pluginInstantiation();
 	void pluginDestruction();
 
+	// connects the channel ports to given buffer, or to their own buffers
+	// if it's NULL
+	void connectChannelPorts( PlanarBuffer * _buf );
+	void updateControls( int _frames );
+	void updateLatency();
+
 	static sample_rate_t maxSamplerate( const QString & _name );
 
 
@@ -84,6 +99,20 @@ private:
 	QVector<multi_proc_t> m_ports;
 	multi_proc_t m_portControls;
 
+	// ports of all processors by kind, in channel order
+	multi_proc_t m_inputPorts;
+	multi_proc_t m_outputPorts;
+	multi_proc_t m_audioRateInputs;
+	multi_proc_t m_controlRateInputs;
+	// whether the buffer of an audio rate input holds its current value
+	QVector<bool> m_audioRateValid;
+	fpp_t m_audioRateFrames;
+	// first channel of the buffer the channel ports are connected to
+	const sample_t * m_connectedBuffer;
+
+	port_desc_t * m_latencyPort;
+	f_cnt_t m_latency;
+
 } ;
 
 #endif
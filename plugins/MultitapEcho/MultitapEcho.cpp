@@ -58,6 +58,7 @@ MultitapEchoEffect::MultitapEchoEffect( Model* parent, const Descriptor::SubPlug
 	m_buffer.reset();
 	m_stages = static_cast<int>( m_controls.m_stages.value() );
 	updateFilters( 0, 19 );
+	setWetOnly( true );
 }
 
 
@@ -89,17 +90,18 @@ void MultitapEchoEffect::runFilter( sampleFrame * dst, sampleFrame * src, Stereo
 }
 
 
-bool MultitapEchoEffect::processAudioBuffer( sampleFrame * buf, const fpp_t frames )
+f_cnt_t MultitapEchoEffect::tailLength() const
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-	
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
+	// the last tap comes after all steps
+	return m_controls.m_steps.value() * m_controls.m_stepLength.value() *
+							m_sampleRate / 1000.0f;
+}
+
+
+
 
+void MultitapEchoEffect::processWetBuffer( sampleFrame * buf, const fpp_t frames )
+{
 	// get processing vars
 	const int steps = m_controls.m_steps.value();
 	const float stepLength = m_controls.m_stepLength.value();
@@ -144,19 +146,9 @@ bool MultitapEchoEffect::processAudioBuffer( sampleFrame * buf, const fpp_t fram
 		}
 	}
 	
-	// pop the buffer and mix it into output
+	// pop the buffer and write it to output
 	m_buffer.pop( m_work );
-
-	for( int f = 0; f < frames; ++f )
-	{
-		buf[f][0] = d * buf[f][0] + w * m_work[f][0];
-		buf[f][1] = d * buf[f][1] + w * m_work[f][1];
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
-	}
-	
-	checkGate( outSum / frames );
-
-	return isRunning();	
+	memcpy( buf, m_work, sizeof( sampleFrame ) * frames );
 }
 
 
@@ -38,13 +38,17 @@ class MultitapEchoEffect : public Effect
 public:
 	MultitapEchoEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~MultitapEchoEffect();
-	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 
 	virtual EffectControls* controls()
 	{
 		return &m_controls;
 	}
 
+	virtual f_cnt_t tailLength() const;
+
+protected:
+	virtual void processWetBuffer( sampleFrame* buf, const fpp_t frames );
+
 private:
 	void updateFilters( int begin, int end );
 	void runFilter( sampleFrame * dst, sampleFrame * src, StereoOnePole & filter, const fpp_t frames );
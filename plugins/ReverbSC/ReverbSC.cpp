@@ -61,6 +61,8 @@ ReverbSCEffect::ReverbSCEffect( Model* parent, const Descriptor::SubPluginFeatur
 	
 	sp_dcblock_init(sp, dcblk[0], Engine::mixer()->currentQualitySettings().sampleRateMultiplier() );
 	sp_dcblock_init(sp, dcblk[1], Engine::mixer()->currentQualitySettings().sampleRateMultiplier() );
+
+	setWetOnly( true );
 }
 
 ReverbSCEffect::~ReverbSCEffect()
@@ -71,17 +73,18 @@ ReverbSCEffect::~ReverbSCEffect()
 	sp_destroy(&sp);
 }
 
-bool ReverbSCEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+f_cnt_t ReverbSCEffect::tailLength() const
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
+	// the longest delay line of the reverb including its modulation, see
+	// reverbParams in revsc.c
+	return 0.1f * Engine::mixer()->processingSampleRate();
+}
+
+
 
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
 
+void ReverbSCEffect::processWetBuffer( sampleFrame* buf, const fpp_t frames )
+{
 	SPFLOAT tmpL, tmpR;
 	SPFLOAT dcblkL, dcblkR;
 	
@@ -115,16 +118,9 @@ bool ReverbSCEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 		sp_revsc_compute(sp, revsc, &s[0], &s[1], &tmpL, &tmpR);
 		sp_dcblock_compute(sp, dcblk[0], &tmpL, &dcblkL);
 		sp_dcblock_compute(sp, dcblk[1], &tmpR, &dcblkR);
-		buf[f][0] = d * buf[f][0] + w * dcblkL * outGain;
-		buf[f][1] = d * buf[f][1] + w * dcblkR * outGain;
-
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
+		buf[f][0] = dcblkL * outGain;
+		buf[f][1] = dcblkR * outGain;
 	}
-
-
-	checkGate( outSum / frames );
-
-	return isRunning();
 }
 	
 void ReverbSCEffect::changeSampleRate()
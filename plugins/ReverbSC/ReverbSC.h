@@ -41,7 +41,6 @@ class ReverbSCEffect : public Effect
 public:
 	ReverbSCEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	virtual ~ReverbSCEffect();
-	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 
 	virtual EffectControls* controls()
 	{
@@ -50,6 +49,11 @@ public:
 
 	void changeSampleRate();
 
+	virtual f_cnt_t tailLength() const;
+
+protected:
+	virtual void processWetBuffer( sampleFrame* buf, const fpp_t frames );
+
 private:
 	ReverbSCControls m_reverbSCControls;
 	sp_data *sp;
@@ -59,6 +59,7 @@ VstEffect::VstEffect( Model * _parent,
 	Effect( &vsteffect_plugin_descriptor, _parent, _key ),
 	m_pluginMutex(),
 	m_key( *_key ),
+	m_latency( 0 ),
 	m_vstControls( this )
 {
 	if( !m_key.attributes["file"].isEmpty() )
@@ -148,6 +149,8 @@ void VstEffect::openPlugin( const QString & _plugin )
 	delete tf;
 
 	m_key.attributes["file"] = _plugin;
+	m_latency = m_plugin->latency();
+	latencyChanged();
 }
 
 
@@ -54,6 +54,11 @@ public:
 		return m_plugin->name();
 	}
 
+	virtual f_cnt_t latency() const
+	{
+		return m_latency;
+	}
+
 
 private:
 	void openPlugin( const QString & _plugin );
@@ -62,6 +67,7 @@ private:
 	QSharedPointer<VstPlugin> m_plugin;
 	QMutex m_pluginMutex;
 	EffectKey m_key;
+	f_cnt_t m_latency;
 
 	VstEffectControls m_vstControls;
 
@@ -43,6 +43,7 @@
 #include "ToolTip.h"
 #include "StringPairDrag.h"
 #include "DataFile.h"
+#include "SampleDataBundle.h"
 
 #include "embed.h"
 #include "plugin_export.h"
@@ -213,9 +214,19 @@ void audioFileProcessor::saveSettings( QDomDocument & _doc,
 	_this.setAttribute( "src", m_sampleBuffer.audioFile() );
 	if( m_sampleBuffer.audioFile() == "" )
 	{
-		QString s;
-		_this.setAttribute( "sampledata",
+		SampleDataBundle * bundle = Engine::getSong()->sampleDataBundle();
+		if( bundle )
+		{
+			_this.setAttribute( "dataref",
+					m_sampleBuffer.addToBundle( *bundle ) );
+			_this.setAttribute( "dataframes", m_sampleBuffer.frames() );
+		}
+		else
+		{
+			QString s;
+			_this.setAttribute( "sampledata",
 						m_sampleBuffer.toBase64( s ) );
+		}
 	}
 	m_reverseModel.saveSettings( _doc, _this, "reversed" );
 	m_loopModel.saveSettings( _doc, _this, "looped" );
@@ -245,6 +256,20 @@ void audioFileProcessor::loadSettings( const QDomElement & _this )
 			Engine::getSong()->collectError( message );
 		}
 	}
+	else if( _this.hasAttribute( "dataref" ) )
+	{
+		SampleDataBundle * bundle = Engine::getSong()->sampleDataBundle();
+		if( bundle == NULL || !m_sampleBuffer.loadFromBundle( *bundle,
+					_this.attribute( "dataref" ).toLongLong(),
+					_this.attribute( "dataframes" ).toInt() ) )
+		{
+			QString message = tr( "Sample data missing from %1" ).arg(
+					SampleDataBundle::fileNameFor(
+				Engine::getSong()->projectFileName() ) );
+
+			Engine::getSong()->collectError( message );
+		}
+	}
 	else if( _this.attribute( "sampledata" ) != "" )
 	{
 		m_sampleBuffer.loadFromBase64( _this.attribute( "srcdata" ) );
@@ -754,6 +779,9 @@ AudioFileProcessorWaveView::AudioFileProcessorWaveView( QWidget * _parent, int _
 	m_graph.fill( Qt::transparent );
 	update();
 	updateCursor();
+
+	connect( &m_sampleBuffer, SIGNAL( peaksReady() ),
+					this, SLOT( peaksReady() ) );
 }
 
 
@@ -768,6 +796,16 @@ void AudioFileProcessorWaveView::isPlaying( f_cnt_t _current_frame )
 
 
 
+void AudioFileProcessorWaveView::peaksReady()
+{
+	// the graph was drawn without the peak cache, so draw it again
+	m_last_to = 0;
+	update();
+}
+
+
+
+
 void AudioFileProcessorWaveView::enterEvent( QEvent * _e )
 {
 	updateCursor();
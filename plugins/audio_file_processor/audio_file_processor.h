@@ -59,6 +59,12 @@ public:
 
 	virtual int getBeatLen( NotePlayHandle * _n ) const;
 
+	virtual Flags flags() const
+	{
+		// with stutter, notes continue where the previous one stopped
+		return m_stutterModel.value() ? NoFlags : IsDeterministic;
+	}
+
 	virtual f_cnt_t desiredReleaseFrames() const
 	{
 		return 128;
@@ -224,6 +230,10 @@ public slots:
 	void isPlaying( f_cnt_t _current_frame );
 
 
+private slots:
+	void peaksReady();
+
+
 private:
 	static const int s_padding = 2;
 
@@ -25,8 +25,10 @@
 
 
 #include "dynamics_processor.h"
+#include "BufferManager.h"
 #include "lmms_math.h"
 #include "interpolation.h"
+#include "MixHelpers.h"
 
 #include "embed.h"
 #include "plugin_export.h"
@@ -52,15 +54,20 @@ Plugin::Descriptor PLUGIN_EXPORT dynamicsprocessor_plugin_descriptor =
 
 const float DYN_NOISE_FLOOR = 0.00001f; // -100dBFS noise floor
 const double DNF_LOG = 5.0;
+// the rate the gain is applied at, as multiple of the processing rate
+const int OS_RATE = 2;
 
 dynProcEffect::dynProcEffect( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Effect( &dynamicsprocessor_plugin_descriptor, _parent, _key ),
-	m_dpControls( this )
+	m_dpControls( this ),
+	m_oversampler( Oversampler::localFactor( OS_RATE ),
+				Engine::mixer()->framesPerPeriod() )
 {
 	m_currentPeak[0] = m_currentPeak[1] = DYN_NOISE_FLOOR;
-	m_rms[0] = new RmsHelper( 64 * Engine::mixer()->processingSampleRate() / 44100 );
-	m_rms[1] = new RmsHelper( 64 * Engine::mixer()->processingSampleRate() / 44100 );
+	m_rms[0] = new RmsHelper( 64 * oversampledRate() / 44100 );
+	m_rms[1] = new RmsHelper( 64 * oversampledRate() / 44100 );
+	m_dryDelay.setDelay( m_oversampler.latency() );
 	calcAttack();
 	calcRelease();
 }
@@ -77,12 +84,27 @@ dynProcEffect::~dynProcEffect()
 
 inline void dynProcEffect::calcAttack()
 {
-	m_attCoeff = exp10( ( DNF_LOG / ( m_dpControls.m_attackModel.value() * 0.001 ) ) / Engine::mixer()->processingSampleRate() );
+	m_attCoeff = exp10( ( DNF_LOG / ( m_dpControls.m_attackModel.value() * 0.001 ) ) / oversampledRate() );
 }
 
 inline void dynProcEffect::calcRelease()
 {
-	m_relCoeff = exp10( ( -DNF_LOG / ( m_dpControls.m_releaseModel.value() * 0.001 ) ) / Engine::mixer()->processingSampleRate() );
+	m_relCoeff = exp10( ( -DNF_LOG / ( m_dpControls.m_releaseModel.value() * 0.001 ) ) / oversampledRate() );
+}
+
+void dynProcEffect::changeSampleRate()
+{
+	if( m_oversampler.setFactor( Oversampler::localFactor( OS_RATE ) ) )
+	{
+		m_dryDelay.setDelay( m_oversampler.latency() );
+		latencyChanged();
+	}
+	m_needsUpdate = true;
+}
+
+float dynProcEffect::oversampledRate() const
+{
+	return Engine::mixer()->processingSampleRate() * m_oversampler.factor();
 }
 
 
@@ -103,7 +125,6 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 	float sm_peak[2] = { 0.0f, 0.0f };
 	float gain;
 
-	double out_sum = 0.0;
 	const float d = dryLevel();
 	const float w = wetLevel();
 	
@@ -118,8 +139,8 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 
 	if( m_needsUpdate )
 	{
-		m_rms[0]->setSize( 64 * Engine::mixer()->processingSampleRate() / 44100 );
-		m_rms[1]->setSize( 64 * Engine::mixer()->processingSampleRate() / 44100 );
+		m_rms[0]->setSize( 64 * oversampledRate() / 44100 );
+		m_rms[1]->setSize( 64 * oversampledRate() / 44100 );
 		calcAttack();
 		calcRelease();
 		m_needsUpdate = false;
@@ -136,9 +157,13 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 		}
 	}
 
-	for( fpp_t f = 0; f < _frames; ++f )
+	// apply the gain at a higher rate so that its changes don't alias
+	sampleFrame * buf = m_oversampler.upsample( _buf, _frames );
+	const f_cnt_t frames = _frames * m_oversampler.factor();
+
+	for( f_cnt_t f = 0; f < frames; ++f )
 	{
-		double s[2] = { _buf[f][0], _buf[f][1] };
+		double s[2] = { buf[f][0], buf[f][1] };
 
 // apply input gain
 		s[0] *= inputGain;
@@ -215,12 +240,18 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 		s[0] *= outputGain;
 		s[1] *= outputGain;
 
-		out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
-// mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
+		buf[f][0] = s[0];
+		buf[f][1] = s[1];
 	}
 
+// mix wet/dry signals, with the dry one delayed by the oversampling
+	sampleFrame * wet = BufferManager::acquire();
+	m_oversampler.downsample( wet, _frames );
+	m_dryDelay.process( _buf, true );
+	const float out_sum = MixHelpers::multiplyAndAddMultipliedEnergy(
+						_buf, wet, d, w, _frames );
+	BufferManager::release( wet );
+
 	checkGate( out_sum / _frames );
 
 	return( isRunning() );
@@ -27,8 +27,10 @@
 #ifndef DYNPROC_H
 #define DYNPROC_H
 
+#include "CompensationDelay.h"
 #include "Effect.h"
 #include "dynamics_processor_controls.h"
+#include "Oversampler.h"
 #include "RmsHelper.h"
 
 
@@ -46,10 +48,18 @@ public:
 		return( &m_dpControls );
 	}
 
+	virtual f_cnt_t latency() const
+	{
+		return m_oversampler.latency();
+	}
+
 
 private:
 	void calcAttack();
 	void calcRelease();
+	void changeSampleRate();
+	// the rate the dynamics are processed at
+	float oversampledRate() const;
 
 	dynProcControls m_dpControls;
 
@@ -62,6 +72,10 @@ private:
 	
 	RmsHelper * m_rms [2];
 
+	Oversampler m_oversampler;
+	// lines up the dry signal with the oversampled wet one
+	CompensationDelay m_dryDelay;
+
 	friend class dynProcControls;
 
 } ;
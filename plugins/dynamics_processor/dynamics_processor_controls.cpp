@@ -57,7 +57,7 @@ dynProcControls::dynProcControls( dynProcEffect * _eff ) :
 
 void dynProcControls::sampleRateChanged()
 {
-	m_effect->m_needsUpdate = true;
+	m_effect->changeSampleRate();
 }
 
 
@@ -60,7 +60,8 @@ public:
 
 	virtual Flags flags() const
 	{
-		return IsNotBendable;
+		return m_noiseModel.value() > 0 ?
+			Flags( IsNotBendable ) : IsNotBendable | IsDeterministic;
 	}
 
 	virtual f_cnt_t desiredReleaseFrames() const
@@ -35,8 +35,6 @@ public:
 	stereoMatrixEffect( Model * parent, 
 	                      const Descriptor::SubPluginFeatures::Key * _key );
 	virtual ~stereoMatrixEffect();
-	virtual bool processAudioBuffer( sampleFrame * _buf,
-		                                          const fpp_t _frames );
 
 	virtual EffectControls * controls()
 	{
@@ -44,6 +42,11 @@ public:
 	}
 
 
+protected:
+	virtual void processWetBuffer( sampleFrame * _buf,
+							const fpp_t _frames );
+
+
 private:
 	stereoMatrixControls m_smControls;
 
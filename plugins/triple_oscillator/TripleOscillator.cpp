@@ -384,6 +384,24 @@ void TripleOscillator::deleteNotePluginData( NotePlayHandle * _n )
 
 
 
+Instrument::Flags TripleOscillator::flags() const
+{
+	for( int i = 0; i < NUM_OF_OSCILLATORS; ++i )
+	{
+		// noise is random and user defined waves aren't part of the models
+		const int shape = m_osc[i]->m_waveShapeModel.value();
+		if( shape == Oscillator::WhiteNoise ||
+				shape == Oscillator::UserDefinedWave )
+		{
+			return NoFlags;
+		}
+	}
+	return IsDeterministic;
+}
+
+
+
+
 PluginView * TripleOscillator::instantiateView( QWidget * _parent )
 {
 	return new TripleOscillatorView( this, _parent );
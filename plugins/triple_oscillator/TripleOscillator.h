@@ -112,6 +112,8 @@ public:
 		return( 128 );
 	}
 
+	virtual Flags flags() const;
+
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
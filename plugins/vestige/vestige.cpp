@@ -146,6 +146,7 @@ vestigeInstrument::vestigeInstrument( InstrumentTrack * _instrument_track ) :
 	Instrument( _instrument_track, &vestige_plugin_descriptor ),
 	m_plugin( NULL ),
 	m_pluginMutex(),
+	m_latency( 0 ),
 	m_subWindow( NULL ),
 	m_scrollArea( NULL ),
 	knobFModel( NULL ),
@@ -362,8 +363,11 @@ void vestigeInstrument::loadFile( const QString & _file )
 		instrumentTrack()->setName( m_plugin->name() );
 	}
 
+	m_latency = m_plugin->latency();
 	m_pluginMutex.unlock();
 
+	latencyChanged();
+
 	emit dataChanged();
 
 	delete tf;
@@ -452,7 +456,10 @@ void vestigeInstrument::closePlugin( void )
 	m_pluginMutex.lock();
 	delete m_plugin;
 	m_plugin = NULL;
+	m_latency = 0;
 	m_pluginMutex.unlock();
+
+	latencyChanged();
 }
 
 
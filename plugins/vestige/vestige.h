@@ -69,6 +69,11 @@ public:
 
 	virtual bool handleMidiEvent( const MidiEvent& event, const MidiTime& time, f_cnt_t offset = 0 );
 
+	virtual f_cnt_t latency() const
+	{
+		return m_latency;
+	}
+
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 protected slots:
@@ -82,6 +87,7 @@ private:
 
 	VstPlugin * m_plugin;
 	QMutex m_pluginMutex;
+	f_cnt_t m_latency;
 
 	QString m_pluginDLL;
 	QMdiSubWindow * m_subWindow;
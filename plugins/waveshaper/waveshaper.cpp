@@ -31,6 +31,9 @@
 
 #include "plugin_export.h"
 
+// the rate shaping is done at, as multiple of the processing rate
+const int OS_RATE = 4;
+
 extern "C"
 {
 
@@ -55,8 +58,12 @@ Plugin::Descriptor PLUGIN_EXPORT waveshaper_plugin_descriptor =
 waveShaperEffect::waveShaperEffect( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Effect( &waveshaper_plugin_descriptor, _parent, _key ),
-	m_wsControls( this )
+	m_wsControls( this ),
+	m_oversampler( Oversampler::localFactor( OS_RATE ),
+				Engine::mixer()->framesPerPeriod() )
 {
+	setWetOnly( true );
+	latencyChanged();
 }
 
 
@@ -69,20 +76,23 @@ waveShaperEffect::~waveShaperEffect()
 
 
 
-bool waveShaperEffect::processAudioBuffer( sampleFrame * _buf,
-							const fpp_t _frames )
+void waveShaperEffect::changeSampleRate()
 {
-	if( !isEnabled() || !isRunning () )
+	if( m_oversampler.setFactor( Oversampler::localFactor( OS_RATE ) ) )
 	{
-		return( false );
+		latencyChanged();
 	}
+}
+
+
+
 
+void waveShaperEffect::processWetBuffer( sampleFrame * _buf,
+							const fpp_t _frames )
+{
 // variables for effect
 	int i = 0;
 
-	double out_sum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
 	float input = m_wsControls.m_inputModel.value();
 	float output = m_wsControls.m_outputModel.value();
 	const float * samples = m_wsControls.m_wavegraphModel.samples();
@@ -97,9 +107,15 @@ bool waveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 	const float *inputPtr = inputBuffer ? &( inputBuffer->values()[ 0 ] ) : &input;
 	const float *outputPtr = outputBufer ? &( outputBufer->values()[ 0 ] ) : &output;
 
-	for( fpp_t f = 0; f < _frames; ++f )
+	// shape the signal at a higher rate so that the harmonics it adds
+	// don't alias
+	sampleFrame * buf = m_oversampler.upsample( _buf, _frames );
+	const int factor = m_oversampler.factor();
+	const f_cnt_t frames = _frames * factor;
+
+	for( f_cnt_t f = 0; f < frames; ++f )
 	{
-		float s[2] = { _buf[f][0], _buf[f][1] };
+		float s[2] = { buf[f][0], buf[f][1] };
 
 // apply input gain
 		s[0] *= *inputPtr;
@@ -140,18 +156,18 @@ bool waveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 		s[0] *= *outputPtr;
 		s[1] *= *outputPtr;
 
-		out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
-// mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
+		buf[f][0] = s[0];
+		buf[f][1] = s[1];
 
-		outputPtr += outputInc;
-		inputPtr += inputInc;
+		// the gains change at the processing rate
+		if( f % factor == factor - 1 )
+		{
+			outputPtr += outputInc;
+			inputPtr += inputInc;
+		}
 	}
 
-	checkGate( out_sum / _frames );
-
-	return( isRunning() );
+	m_oversampler.downsample( _buf, _frames );
 }
 
 
@@ -28,6 +28,7 @@
 #define _WAVESHAPER_H
 
 #include "Effect.h"
+#include "Oversampler.h"
 #include "waveshaper_controls.h"
 
 
@@ -38,18 +39,29 @@ public:
 	waveShaperEffect( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key );
 	virtual ~waveShaperEffect();
-	virtual bool processAudioBuffer( sampleFrame * _buf,
-							const fpp_t _frames );
 
 	virtual EffectControls * controls()
 	{
 		return( &m_wsControls );
 	}
 
+	virtual f_cnt_t latency() const
+	{
+		return m_oversampler.latency();
+	}
+
+	void changeSampleRate();
+
+
+protected:
+	virtual void processWetBuffer( sampleFrame * _buf,
+							const fpp_t _frames );
+
 
 private:
 
 	waveShaperControls m_wsControls;
+	Oversampler m_oversampler;
 
 	friend class waveShaperControls;
 
@@ -46,6 +46,8 @@ waveShaperControls::waveShaperControls( waveShaperEffect * _eff ) :
 {
 	connect( &m_wavegraphModel, SIGNAL( samplesChanged( int, int ) ),
 			this, SLOT( samplesChanged( int, int ) ) );
+	connect( Engine::mixer(), SIGNAL( sampleRateChanged() ),
+			this, SLOT( sampleRateChanged() ) );
 
 	setDefaultShape();
 }
@@ -61,6 +63,14 @@ void waveShaperControls::samplesChanged( int _begin, int _end)
 
 
 
+void waveShaperControls::sampleRateChanged()
+{
+	m_effect->changeSampleRate();
+}
+
+
+
+
 void waveShaperControls::loadSettings( const QDomElement & _this )
 {
 //load input, output knobs
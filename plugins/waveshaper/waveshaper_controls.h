@@ -65,6 +65,7 @@ public:
 
 private slots:
 	void samplesChanged( int, int );
+	void sampleRateChanged();
 
 	void resetClicked();
 	void smoothClicked();
@@ -26,6 +26,7 @@
 
 #include "zynaddsubfx/src/Misc/Util.h"
 #include <unistd.h>
+#include <cstring>
 #include <ctime>
 
 #include "LocalZynAddSubFx.h"
@@ -43,8 +44,15 @@ int LocalZynAddSubFx::s_instanceCount = 0;
 
 LocalZynAddSubFx::LocalZynAddSubFx() :
 	m_master( NULL ),
-	m_ioEngine( NULL )
+	m_ioEngine( NULL ),
+	m_renderAhead( false ),
+	m_rendering( false ),
+	m_quitRendering( false ),
+	m_renderBuffer( NULL )
 {
+	pthread_mutex_init( &m_renderMutex, NULL );
+	pthread_cond_init( &m_renderCond, NULL );
+
 	for( int i = 0; i < NumKeys; ++i )
 	{
 		m_runningNotes[i] = 0;
@@ -88,6 +96,10 @@ LocalZynAddSubFx::LocalZynAddSubFx() :
 
 LocalZynAddSubFx::~LocalZynAddSubFx()
 {
+	setRenderAhead( false );
+	pthread_cond_destroy( &m_renderCond );
+	pthread_mutex_destroy( &m_renderMutex );
+
 	delete m_master;
 	delete m_ioEngine;
 
@@ -112,6 +124,7 @@ void LocalZynAddSubFx::initConfig()
 
 void LocalZynAddSubFx::setSampleRate( int sampleRate )
 {
+	finishRendering();
 	synth->samplerate = sampleRate;
 	synth->alias();
 }
@@ -121,8 +134,15 @@ void LocalZynAddSubFx::setSampleRate( int sampleRate )
 
 void LocalZynAddSubFx::setBufferSize( int bufferSize )
 {
+	finishRendering();
 	synth->buffersize = bufferSize;
 	synth->alias();
+
+	if( m_renderBuffer != NULL )
+	{
+		delete[] m_renderBuffer;
+		m_renderBuffer = new sampleFrame[bufferSize]();
+	}
 }
 
 
@@ -130,6 +150,8 @@ void LocalZynAddSubFx::setBufferSize( int bufferSize )
 
 void LocalZynAddSubFx::saveXML( const std::string & _filename )
 {
+	finishRendering();
+
 	char * name = strdup( _filename.c_str() );
 	m_master->saveXML( name );
 	free( name );
@@ -140,6 +162,8 @@ void LocalZynAddSubFx::saveXML( const std::string & _filename )
 
 void LocalZynAddSubFx::loadXML( const std::string & _filename )
 {
+	finishRendering();
+
 	char * f = strdup( _filename.c_str() );
 
 	pthread_mutex_lock( &m_master->mutex );
@@ -158,6 +182,8 @@ void LocalZynAddSubFx::loadXML( const std::string & _filename )
 
 void LocalZynAddSubFx::loadPreset( const std::string & _filename, int _part )
 {
+	finishRendering();
+
 	char * f = strdup( _filename.c_str() );
 
 	pthread_mutex_lock( &m_master->mutex );
@@ -208,6 +234,8 @@ void LocalZynAddSubFx::setLmmsWorkingDir( const std::string & _dir )
 
 void LocalZynAddSubFx::setPitchWheelBendRange( int semitones )
 {
+	finishRendering();
+
 	for( int i = 0; i < NUM_MIDI_PARTS; ++i )
 	{
 		m_master->part[i]->ctl.setpitchwheelbendrange( semitones * 100 );
@@ -217,6 +245,24 @@ void LocalZynAddSubFx::setPitchWheelBendRange( int semitones )
 
 
 void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
+{
+	pthread_mutex_lock( &m_renderMutex );
+	if( m_rendering )
+	{
+		// applied before rendering the next period
+		m_queuedEvents.push_back( event );
+	}
+	else
+	{
+		applyMidiEvent( event );
+	}
+	pthread_mutex_unlock( &m_renderMutex );
+}
+
+
+
+
+void LocalZynAddSubFx::applyMidiEvent( const MidiEvent& event )
 {
 	switch( event.type() )
 	{
@@ -260,6 +306,123 @@ void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
 
 
 void LocalZynAddSubFx::processAudio( sampleFrame * _out )
+{
+	if( !m_renderAhead )
+	{
+		render( _out );
+		return;
+	}
+
+	pthread_mutex_lock( &m_renderMutex );
+	while( m_rendering )
+	{
+		pthread_cond_wait( &m_renderCond, &m_renderMutex );
+	}
+
+	memcpy( _out, m_renderBuffer, synth->buffersize * sizeof( sampleFrame ) );
+
+	for( const MidiEvent & event : m_queuedEvents )
+	{
+		applyMidiEvent( event );
+	}
+	m_queuedEvents.clear();
+
+	m_rendering = true;
+	pthread_cond_broadcast( &m_renderCond );
+	pthread_mutex_unlock( &m_renderMutex );
+}
+
+
+
+
+void LocalZynAddSubFx::setRenderAhead( bool _on )
+{
+	if( _on == m_renderAhead )
+	{
+		return;
+	}
+
+	if( _on )
+	{
+		m_renderBuffer = new sampleFrame[synth->buffersize]();
+		m_quitRendering = false;
+		m_renderAhead = true;
+		pthread_create( &m_renderThread, NULL, renderLoop, this );
+		return;
+	}
+
+	pthread_mutex_lock( &m_renderMutex );
+	m_quitRendering = true;
+	pthread_cond_broadcast( &m_renderCond );
+	pthread_mutex_unlock( &m_renderMutex );
+	pthread_join( m_renderThread, NULL );
+
+	// nothing renders anymore, so there's nothing left to queue events for
+	for( const MidiEvent & event : m_queuedEvents )
+	{
+		applyMidiEvent( event );
+	}
+	m_queuedEvents.clear();
+
+	m_renderAhead = false;
+	delete[] m_renderBuffer;
+	m_renderBuffer = NULL;
+}
+
+
+
+
+void LocalZynAddSubFx::finishRendering()
+{
+	pthread_mutex_lock( &m_renderMutex );
+	while( m_rendering )
+	{
+		pthread_cond_wait( &m_renderCond, &m_renderMutex );
+	}
+	pthread_mutex_unlock( &m_renderMutex );
+}
+
+
+
+
+void * LocalZynAddSubFx::renderLoop( void * _arg )
+{
+	static_cast<LocalZynAddSubFx *>( _arg )->renderLoop();
+	return NULL;
+}
+
+
+
+
+void LocalZynAddSubFx::renderLoop()
+{
+	pthread_mutex_lock( &m_renderMutex );
+	while( true )
+	{
+		while( !m_rendering && !m_quitRendering )
+		{
+			pthread_cond_wait( &m_renderCond, &m_renderMutex );
+		}
+		// finish the period processAudio() started before quitting
+		if( !m_rendering )
+		{
+			break;
+		}
+		pthread_mutex_unlock( &m_renderMutex );
+
+		render( m_renderBuffer );
+
+		pthread_mutex_lock( &m_renderMutex );
+		m_rendering = false;
+		pthread_cond_broadcast( &m_renderCond );
+	}
+	pthread_mutex_unlock( &m_renderMutex );
+}
+
+
+
+
+void LocalZynAddSubFx::render( sampleFrame * _out )
 {
 	float outputl[synth->buffersize];
 	float outputr[synth->buffersize];
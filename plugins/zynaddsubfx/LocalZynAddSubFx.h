@@ -25,6 +25,9 @@
 #ifndef LOCAL_ZYNADDSUBFX_H
 #define LOCAL_ZYNADDSUBFX_H
 
+#include <pthread.h>
+#include <vector>
+
 #include "MidiEvent.h"
 #include "Note.h"
 
@@ -56,6 +59,12 @@ public:
 
 	void processAudio( sampleFrame * _out );
 
+	// render each period on a thread of its own while the mixer works on
+	// everything else - processAudio() then returns the previous period
+	// and MIDI events are queued while a period is being rendered, calls
+	// to processAudio() must not overlap with any of the other functions
+	void setRenderAhead( bool _on );
+
 	inline Master * master()
 	{
 		return m_master;
@@ -63,6 +72,12 @@ public:
 
 
 protected:
+	void applyMidiEvent( const MidiEvent& event );
+	void render( sampleFrame * _out );
+
+	// waits for the period being rendered ahead, if any
+	void finishRendering();
+
 	static int s_instanceCount;
 
 	std::string m_presetsDir;
@@ -71,6 +86,20 @@ protected:
 	Master * m_master;
 	NulEngine* m_ioEngine;
 
+
+private:
+	static void * renderLoop( void * _arg );
+	void renderLoop();
+
+	bool m_renderAhead;
+	bool m_rendering;
+	bool m_quitRendering;
+	pthread_t m_renderThread;
+	pthread_mutex_t m_renderMutex;
+	pthread_cond_t m_renderCond;
+	sampleFrame * m_renderBuffer;
+	std::vector<MidiEvent> m_queuedEvents;
+
 } ;
 
 #endif
@@ -27,6 +27,7 @@
 #include <winsock2.h>
 #endif
 
+#include <list>
 #include <queue>
 
 #define BUILD_REMOTE_PLUGIN_CLIENT
@@ -52,11 +53,10 @@ public:
 		RemotePluginClient( socketPath ),
 #endif
 		LocalZynAddSubFx(),
-		m_guiSleepTime( 100 ),
+		m_ui( NULL ),
+		m_exitProgram( 0 ),
 		m_guiExit( false )
 	{
-		Nio::start();
-
 		setInputCount( 0 );
 		sendMessage( IdInitDone );
 		waitForMessage( IdInitDone );
@@ -67,7 +67,9 @@ public:
 
 	virtual ~RemoteZynAddSubFx()
 	{
-		Nio::stop();
+		pthread_join( m_messageThreadHandle, NULL );
+		Fl::flush();
+		delete m_ui;
 	}
 
 	virtual void updateSampleRate()
@@ -83,7 +85,7 @@ public:
 	void messageLoop()
 	{
 		message m;
-		while( ( m = receiveMessage() ).id != IdQuit )
+		while( ( m = receiveMessage() ).id != IdQuit && !isInvalid() )
 		{
 			pthread_mutex_lock( &m_master->mutex );
 			processMessage( m );
@@ -156,13 +158,28 @@ public:
 	}
 
 	void guiLoop();
+	void processGuiMessages();
+
+	bool hasUI() const
+	{
+		return m_ui != NULL;
+	}
+
+	bool guiExited() const
+	{
+		return m_guiExit;
+	}
+
+	static void guiWait( bool _ui );
 
 private:
-	const int m_guiSleepTime;
+	static const int s_guiSleepTime = 100;
 
 	pthread_t m_messageThreadHandle;
 	pthread_mutex_t m_guiMutex;
 	std::queue<RemotePluginClient::message> m_guiMessages;
+	MasterUI * m_ui;
+	int m_exitProgram;
 	bool m_guiExit;
 
 } ;
@@ -170,88 +187,235 @@ private:
 
 
 
-void RemoteZynAddSubFx::guiLoop()
+// runs several instances in one process - LMMS talks to each of them through
+// its own channel, this one is only used to add instances
+class RemoteZynAddSubFxGroup : public RemotePluginClient
 {
-	int exitProgram = 0;
-	MasterUI * ui = NULL;
+public:
+#ifdef SYNC_WITH_SHM_FIFO
+	RemoteZynAddSubFxGroup( int _shm_in, int _shm_out ) :
+		RemotePluginClient( _shm_in, _shm_out ),
+#else
+	RemoteZynAddSubFxGroup( const char * socketPath ) :
+		RemotePluginClient( socketPath ),
+#endif
+		m_quit( false )
+	{
+		sendMessage( IdInitDone );
+		waitForMessage( IdInitDone );
 
-	while( !m_guiExit )
+		pthread_mutex_init( &m_requestMutex, NULL );
+		pthread_create( &m_messageThreadHandle, NULL, messageLoop,
+									this );
+	}
+
+	virtual ~RemoteZynAddSubFxGroup()
 	{
-		if( ui )
+		pthread_join( m_messageThreadHandle, NULL );
+	}
+
+	virtual bool processMessage( const message & _m )
+	{
+		if( _m.id == IdAddInstance )
 		{
-			Fl::wait( m_guiSleepTime / 1000.0 );
+			pthread_mutex_lock( &m_requestMutex );
+			m_requests.push( _m );
+			pthread_mutex_unlock( &m_requestMutex );
+			return true;
 		}
-		else
+		return RemotePluginClient::processMessage( _m );
+	}
+
+	virtual void process( const sampleFrame *, sampleFrame * )
+	{
+	}
+
+	void messageLoop()
+	{
+		message m;
+		while( ( m = receiveMessage() ).id != IdQuit && !isInvalid() )
 		{
+			processMessage( m );
+		}
+		m_quit = true;
+	}
+
+	static void * messageLoop( void * _arg )
+	{
+		static_cast<RemoteZynAddSubFxGroup *>( _arg )->messageLoop();
+		return NULL;
+	}
+
+	void guiLoop();
+
+
+private:
+	void addInstances();
+
+	pthread_t m_messageThreadHandle;
+	pthread_mutex_t m_requestMutex;
+	std::queue<RemotePluginClient::message> m_requests;
+	std::list<RemoteZynAddSubFx *> m_instances;
+	bool m_quit;
+
+} ;
+
+
+
+
+void RemoteZynAddSubFx::guiWait( bool _ui )
+{
+	if( _ui )
+	{
+		Fl::wait( s_guiSleepTime / 1000.0 );
+	}
+	else
+	{
 #ifdef LMMS_BUILD_WIN32
-			Sleep( m_guiSleepTime );
+		Sleep( s_guiSleepTime );
 #else
-			usleep( m_guiSleepTime*1000 );
+		usleep( s_guiSleepTime*1000 );
 #endif
-		}
-		if( exitProgram == 1 )
-		{
-			pthread_mutex_lock( &m_master->mutex );
-			sendMessage( IdHideUI );
-			exitProgram = 0;
-			pthread_mutex_unlock( &m_master->mutex );
-		}
-		pthread_mutex_lock( &m_guiMutex );
-		while( m_guiMessages.size() )
+	}
+}
+
+
+
+
+void RemoteZynAddSubFx::guiLoop()
+{
+	while( !m_guiExit )
+	{
+		guiWait( m_ui != NULL );
+		processGuiMessages();
+	}
+}
+
+
+
+
+void RemoteZynAddSubFx::processGuiMessages()
+{
+	if( m_exitProgram == 1 )
+	{
+		pthread_mutex_lock( &m_master->mutex );
+		sendMessage( IdHideUI );
+		m_exitProgram = 0;
+		pthread_mutex_unlock( &m_master->mutex );
+	}
+	pthread_mutex_lock( &m_guiMutex );
+	while( m_guiMessages.size() )
+	{
+		RemotePluginClient::message m = m_guiMessages.front();
+		m_guiMessages.pop();
+		switch( m.id )
 		{
-			RemotePluginClient::message m = m_guiMessages.front();
-			m_guiMessages.pop();
-			switch( m.id )
+			case IdShowUI:
+				// we only create GUI
+				if( !m_ui )
+				{
+					Fl::scheme( "plastic" );
+					m_ui = new MasterUI( m_master, &m_exitProgram );
+				}
+				m_ui->showUI();
+				m_ui->refresh_master_ui();
+				break;
+
+			case IdLoadSettingsFromFile:
 			{
-				case IdShowUI:
-					// we only create GUI
-					if( !ui )
-					{
-						Fl::scheme( "plastic" );
-						ui = new MasterUI( m_master, &exitProgram );
-					}
-					ui->showUI();
-					ui->refresh_master_ui();
-					break;
-
-				case IdLoadSettingsFromFile:
+				LocalZynAddSubFx::loadXML( m.getString() );
+				if( m_ui )
 				{
-					LocalZynAddSubFx::loadXML( m.getString() );
-					if( ui )
-					{
-						ui->refresh_master_ui();
-					}
-					pthread_mutex_lock( &m_master->mutex );
-					sendMessage( IdLoadSettingsFromFile );
-					pthread_mutex_unlock( &m_master->mutex );
-					break;
+					m_ui->refresh_master_ui();
 				}
+				pthread_mutex_lock( &m_master->mutex );
+				sendMessage( IdLoadSettingsFromFile );
+				pthread_mutex_unlock( &m_master->mutex );
+				break;
+			}
 
-				case IdLoadPresetFile:
+			case IdLoadPresetFile:
+			{
+				LocalZynAddSubFx::loadPreset( m.getString(), m_ui ?
+							m_ui->npartcounter->value()-1 : 0 );
+				if( m_ui )
 				{
-					LocalZynAddSubFx::loadPreset( m.getString(), ui ?
-											ui->npartcounter->value()-1 : 0 );
-					if( ui )
-					{
-						ui->npartcounter->do_callback();
-						ui->updatepanel();
-						ui->refresh_master_ui();
-					}
-					pthread_mutex_lock( &m_master->mutex );
-					sendMessage( IdLoadPresetFile );
-					pthread_mutex_unlock( &m_master->mutex );
-					break;
+					m_ui->npartcounter->do_callback();
+					m_ui->updatepanel();
+					m_ui->refresh_master_ui();
 				}
+				pthread_mutex_lock( &m_master->mutex );
+				sendMessage( IdLoadPresetFile );
+				pthread_mutex_unlock( &m_master->mutex );
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+	pthread_mutex_unlock( &m_guiMutex );
+}
+
+
 
-				default:
-					break;
+
+// all instances share the GUI thread, FLTK isn't thread-safe - each of
+// them processes audio on its own message thread though
+void RemoteZynAddSubFxGroup::guiLoop()
+{
+	while( !m_quit || !m_instances.empty() )
+	{
+		bool ui = false;
+		for( RemoteZynAddSubFx * instance : m_instances )
+		{
+			ui = ui || instance->hasUI();
+		}
+		RemoteZynAddSubFx::guiWait( ui );
+
+		addInstances();
+
+		for( auto it = m_instances.begin(); it != m_instances.end(); )
+		{
+			( *it )->processGuiMessages();
+			if( ( *it )->guiExited() )
+			{
+				delete *it;
+				it = m_instances.erase( it );
+			}
+			else
+			{
+				++it;
 			}
 		}
-		pthread_mutex_unlock( &m_guiMutex );
 	}
-	Fl::flush();
+}
+
+
+
+
+void RemoteZynAddSubFxGroup::addInstances()
+{
+	pthread_mutex_lock( &m_requestMutex );
+	while( m_requests.size() )
+	{
+		const message m = m_requests.front();
+		m_requests.pop();
+		pthread_mutex_unlock( &m_requestMutex );
+
+		// the arguments LMMS would have started a single process with
+#ifdef SYNC_WITH_SHM_FIFO
+		m_instances.push_back( new RemoteZynAddSubFx(
+						atoi( m.getString( 0 ).c_str() ),
+						atoi( m.getString( 1 ).c_str() ) ) );
+#else
+		m_instances.push_back(
+			new RemoteZynAddSubFx( m.getString( 0 ).c_str() ) );
+#endif
 
-	delete ui;
+		pthread_mutex_lock( &m_requestMutex );
+	}
+	pthread_mutex_unlock( &m_requestMutex );
 }
 
 
@@ -279,15 +443,40 @@ int main( int _argc, char * * _argv )
 
 
 #ifdef SYNC_WITH_SHM_FIFO
-	RemoteZynAddSubFx * remoteZASF =
-		new RemoteZynAddSubFx( atoi( _argv[1] ), atoi( _argv[2] ) );
+	const int channelArgs = 2;
 #else
-	RemoteZynAddSubFx * remoteZASF = new RemoteZynAddSubFx( _argv[1] );
+	const int channelArgs = 1;
 #endif
 
-	remoteZASF->guiLoop();
+	Nio::start();
+
+	if( _argc > channelArgs + 1 &&
+			strcmp( _argv[channelArgs + 1], "--group" ) == 0 )
+	{
+#ifdef SYNC_WITH_SHM_FIFO
+		RemoteZynAddSubFxGroup * group = new RemoteZynAddSubFxGroup(
+					atoi( _argv[1] ), atoi( _argv[2] ) );
+#else
+		RemoteZynAddSubFxGroup * group =
+					new RemoteZynAddSubFxGroup( _argv[1] );
+#endif
+		group->guiLoop();
+		delete group;
+	}
+	else
+	{
+#ifdef SYNC_WITH_SHM_FIFO
+		RemoteZynAddSubFx * remoteZASF = new RemoteZynAddSubFx(
+					atoi( _argv[1] ), atoi( _argv[2] ) );
+#else
+		RemoteZynAddSubFx * remoteZASF =
+					new RemoteZynAddSubFx( _argv[1] );
+#endif
+		remoteZASF->guiLoop();
+		delete remoteZASF;
+	}
 
-	delete remoteZASF;
+	Nio::stop();
 
 
 #ifdef LMMS_BUILD_WIN32
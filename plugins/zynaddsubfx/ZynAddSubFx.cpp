@@ -43,6 +43,7 @@
 #include "gui_templates.h"
 #include "Song.h"
 #include "StringPairDrag.h"
+#include "ToolTip.h"
 #include "RemoteZynAddSubFx.h"
 #include "LocalZynAddSubFx.h"
 #include "Mixer.h"
@@ -72,9 +73,13 @@ Plugin::Descriptor PLUGIN_EXPORT zynaddsubfx_plugin_descriptor =
 
 
 
-ZynAddSubFxRemotePlugin::ZynAddSubFxRemotePlugin() :
+ZynAddSubFxRemotePlugin::ZynAddSubFxRemotePlugin( bool _sharedProcess ) :
 	RemotePlugin()
 {
+	if( _sharedProcess )
+	{
+		setProcessGroup( "shared" );
+	}
 	init( "RemoteZynAddSubFx", false );
 }
 
@@ -118,7 +123,9 @@ ZynAddSubFxInstrument::ZynAddSubFxInstrument(
 	m_fmGainModel( 127, 0, 127, 1, this, tr( "FM gain" ) ),
 	m_resCenterFreqModel( 64, 0, 127, 1, this, tr( "Resonance center frequency" ) ),
 	m_resBandwidthModel( 64, 0, 127, 1, this, tr( "Resonance bandwidth" ) ),
-	m_forwardMidiCcModel( true, this, tr( "Forward MIDI control change events" ) )
+	m_forwardMidiCcModel( true, this, tr( "Forward MIDI control change events" ) ),
+	m_sharedProcessModel( false, this, tr( "Share process with other instances" ) ),
+	m_renderAheadModel( false, this, tr( "Render one period ahead" ) )
 {
 	initPlugin();
 
@@ -146,6 +153,9 @@ ZynAddSubFxInstrument::ZynAddSubFxInstrument(
 
 	connect( instrumentTrack()->pitchRangeModel(), SIGNAL( dataChanged() ),
 			this, SLOT( updatePitchRange() ), Qt::DirectConnection );
+
+	connect( &m_renderAheadModel, SIGNAL( dataChanged() ),
+			this, SLOT( updateRenderAhead() ), Qt::DirectConnection );
 }
 
 
@@ -191,6 +201,8 @@ void ZynAddSubFxInstrument::saveSettings( QDomDocument & _doc,
 	_this.setAttribute( "modifiedcontrollers", modifiedControllers );
 
 	m_forwardMidiCcModel.saveSettings( _doc, _this, "forwardmidicc" );
+	m_sharedProcessModel.saveSettings( _doc, _this, "sharedprocess" );
+	m_renderAheadModel.saveSettings( _doc, _this, "renderahead" );
 
 	QTemporaryFile tf;
 	if( tf.open() )
@@ -238,6 +250,8 @@ void ZynAddSubFxInstrument::loadSettings( const QDomElement & _this )
 	m_resCenterFreqModel.loadSettings( _this, "rescenterfreq" );
 	m_resBandwidthModel.loadSettings( _this, "resbandwidth" );
 	m_forwardMidiCcModel.loadSettings( _this, "forwardmidicc" );
+	m_sharedProcessModel.loadSettings( _this, "sharedprocess" );
+	m_renderAheadModel.loadSettings( _this, "renderahead" );
 
 	QDomDocument doc;
 	QDomElement data = _this.firstChildElement( "ZynAddSubFX-data" );
@@ -395,6 +409,36 @@ void ZynAddSubFxInstrument::reloadPlugin()
 
 
 
+void ZynAddSubFxInstrument::updateRenderAhead()
+{
+	m_pluginMutex.lock();
+	if( m_remotePlugin )
+	{
+		m_remotePlugin->setPipelined( m_renderAheadModel.value() );
+	}
+	else
+	{
+		m_plugin->setRenderAhead( m_renderAheadModel.value() );
+	}
+	m_pluginMutex.unlock();
+
+	latencyChanged();
+}
+
+
+
+
+f_cnt_t ZynAddSubFxInstrument::latency() const
+{
+	// both the local and the remote plugin play what they rendered during
+	// the previous period when rendering ahead
+	return m_renderAheadModel.value() ?
+				Engine::mixer()->framesPerPeriod() : 0;
+}
+
+
+
+
 void ZynAddSubFxInstrument::updatePitchRange()
 {
 	m_pluginMutex.lock();
@@ -440,7 +484,8 @@ void ZynAddSubFxInstrument::initPlugin()
 
 	if( m_hasGUI )
 	{
-		m_remotePlugin = new ZynAddSubFxRemotePlugin();
+		m_remotePlugin = new ZynAddSubFxRemotePlugin(
+						m_sharedProcessModel.value() );
 		m_remotePlugin->lock();
 		m_remotePlugin->waitForInitDone( false );
 
@@ -462,6 +507,8 @@ void ZynAddSubFxInstrument::initPlugin()
 		// causing not to send buffer size information requests
 		m_remotePlugin->sendMessage( RemotePlugin::message( IdBufferSizeInformation ).addInt( Engine::mixer()->framesPerPeriod() ) );
 
+		m_remotePlugin->setPipelined( m_renderAheadModel.value() );
+
 		m_remotePlugin->showUI();
 		m_remotePlugin->unlock();
 	}
@@ -470,6 +517,7 @@ void ZynAddSubFxInstrument::initPlugin()
 		m_plugin = new LocalZynAddSubFx;
 		m_plugin->setSampleRate( Engine::mixer()->processingSampleRate() );
 		m_plugin->setBufferSize( Engine::mixer()->framesPerPeriod() );
+		m_plugin->setRenderAhead( m_renderAheadModel.value() );
 	}
 
 	m_pluginMutex.unlock();
@@ -540,6 +588,16 @@ ZynAddSubFxView::ZynAddSubFxView( Instrument * _instrument, QWidget * _parent )
 
 	m_forwardMidiCC = new LedCheckBox( tr( "Forward MIDI control changes" ), this );
 
+	m_sharedProcess = new LedCheckBox( tr( "Share process with other instances" ), this );
+	ToolTip::add( m_sharedProcess, tr( "Saves resources, but a crash stops all "
+						"instances sharing the process. Applies the next "
+						"time the GUI is shown." ) );
+
+	m_renderAhead = new LedCheckBox( tr( "Render one period ahead" ), this );
+	ToolTip::add( m_renderAhead, tr( "Renders while the rest of the song is "
+						"processed, which helps with heavy patches. Delays "
+						"the output by one period." ) );
+
 	m_toggleUIButton = new QPushButton( tr( "Show GUI" ), this );
 	m_toggleUIButton->setCheckable( true );
 	m_toggleUIButton->setChecked( false );
@@ -558,8 +616,10 @@ ZynAddSubFxView::ZynAddSubFxView( Instrument * _instrument, QWidget * _parent )
 	l->addWidget( m_resCenterFreq, 3, 1 );
 	l->addWidget( m_resBandwidth, 3, 2 );
 	l->addWidget( m_forwardMidiCC, 4, 0, 1, 4 );
+	l->addWidget( m_sharedProcess, 5, 0, 1, 4 );
+	l->addWidget( m_renderAhead, 6, 0, 1, 4 );
 
-	l->setRowStretch( 5, 10 );
+	l->setRowStretch( 7, 10 );
 	l->setColumnStretch( 4, 10 );
 
 	setAcceptDrops( true );
@@ -630,6 +690,8 @@ void ZynAddSubFxView::modelChanged()
 	m_resBandwidth->setModel( &m->m_resBandwidthModel );
 
 	m_forwardMidiCC->setModel( &m->m_forwardMidiCcModel );
+	m_sharedProcess->setModel( &m->m_sharedProcessModel );
+	m_renderAhead->setModel( &m->m_renderAheadModel );
 
 	m_toggleUIButton->setChecked( m->m_hasGUI );
 }
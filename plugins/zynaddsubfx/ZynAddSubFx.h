@@ -48,7 +48,7 @@ class ZynAddSubFxRemotePlugin : public RemotePlugin
 {
 	Q_OBJECT
 public:
-	ZynAddSubFxRemotePlugin();
+	ZynAddSubFxRemotePlugin( bool _sharedProcess );
 	virtual ~ZynAddSubFxRemotePlugin();
 
 	virtual bool processMessage( const message & _m );
@@ -85,6 +85,8 @@ public:
 		return IsSingleStreamed | IsMidiBased;
 	}
 
+	virtual f_cnt_t latency() const;
+
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
@@ -92,6 +94,7 @@ private slots:
 	void reloadPlugin();
 
 	void updatePitchRange();
+	void updateRenderAhead();
 
 	void updatePortamento();
 	void updateFilterFreq();
@@ -119,6 +122,8 @@ private:
 	FloatModel m_resCenterFreqModel;
 	FloatModel m_resBandwidthModel;
 	BoolModel m_forwardMidiCcModel;
+	BoolModel m_sharedProcessModel;
+	BoolModel m_renderAheadModel;
 
 	QMap<int, bool> m_modifiedControllers;
 
@@ -157,6 +162,8 @@ private:
 	Knob * m_resCenterFreq;
 	Knob * m_resBandwidth;
 	LedCheckBox * m_forwardMidiCC;
+	LedCheckBox * m_sharedProcess;
+	LedCheckBox * m_renderAhead;
 
 
 private slots:
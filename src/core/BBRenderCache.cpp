@@ -0,0 +1,570 @@
+/*
+ * BBRenderCache.cpp - reuses the output of repeating beat/bassline patterns
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <cstring>
+
+#include "BBRenderCache.h"
+#include "BBTrackContainer.h"
+#include "ConfigManager.h"
+#include "Controller.h"
+#include "EffectChain.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "Mixer.h"
+#include "MixHelpers.h"
+#include "Pattern.h"
+#include "Song.h"
+#include "TimeLineWidget.h"
+
+
+
+BBRender::BBRender( f_cnt_t _startOffset ) :
+	m_data( NULL ),
+	m_frames( 0 ),
+	m_capacity( 0 ),
+	m_startPeriod( Controller::runningPeriods() ),
+	m_startOffset( _startOffset ),
+	m_notes( 0 ),
+	m_repetitionFinished( false ),
+	m_aborted( false )
+{
+}
+
+
+
+
+BBRender::~BBRender()
+{
+	MM_FREE( m_data );
+}
+
+
+
+
+void BBRender::attach()
+{
+	QMutexLocker lock( &m_mutex );
+	++m_notes;
+}
+
+
+
+
+void BBRender::detach( bool _finished )
+{
+	QMutexLocker lock( &m_mutex );
+	--m_notes;
+	if( !_finished )
+	{
+		// the note was cut off, so its tail is missing
+		m_aborted = true;
+	}
+}
+
+
+
+
+void BBRender::add( const sampleFrame * _buf, const fpp_t _frames )
+{
+	// the buffer holds the current period, which starts this many frames
+	// after the repetition
+	const f_cnt_t start = ( Controller::runningPeriods() - m_startPeriod ) *
+			Engine::mixer()->framesPerPeriod() - m_startOffset;
+	const f_cnt_t skip = qMax<f_cnt_t>( 0, -start );
+	const f_cnt_t end = start + _frames;
+	if( skip >= _frames )
+	{
+		return;
+	}
+
+	QMutexLocker lock( &m_mutex );
+	if( m_aborted )
+	{
+		return;
+	}
+	// notes that don't end, e.g. because of a held sustain pedal, would
+	// make the render grow forever
+	if( end > BBRenderCache::MaximumFrames / 4 )
+	{
+		m_aborted = true;
+		return;
+	}
+
+	if( end > m_frames )
+	{
+		if( end > m_capacity )
+		{
+			reserve( qMax( end, 2 * m_capacity ) );
+		}
+		memset( m_data + m_frames, 0,
+				( end - m_frames ) * sizeof( sampleFrame ) );
+		m_frames = end;
+	}
+	MixHelpers::add( m_data + start + skip, _buf + skip, _frames - skip );
+}
+
+
+
+
+void BBRender::finishRepetition()
+{
+	QMutexLocker lock( &m_mutex );
+	m_repetitionFinished = true;
+}
+
+
+
+
+void BBRender::abort()
+{
+	QMutexLocker lock( &m_mutex );
+	m_aborted = true;
+}
+
+
+
+
+bool BBRender::isComplete() const
+{
+	QMutexLocker lock( &m_mutex );
+	return m_repetitionFinished && m_notes == 0 && !m_aborted;
+}
+
+
+
+
+bool BBRender::isAborted() const
+{
+	QMutexLocker lock( &m_mutex );
+	return m_aborted;
+}
+
+
+
+
+bool BBRender::isDone() const
+{
+	QMutexLocker lock( &m_mutex );
+	return m_notes == 0 && ( m_repetitionFinished || m_aborted );
+}
+
+
+
+
+void BBRender::reserve( f_cnt_t _frames )
+{
+	// growing happens while rendering, but only until the first
+	// repetition of a pattern is done
+	sampleFrame * data = MM_ALLOC( sampleFrame, _frames );
+	if( m_data )
+	{
+		memcpy( data, m_data, m_frames * sizeof( sampleFrame ) );
+		MM_FREE( m_data );
+	}
+	m_data = data;
+	m_capacity = _frames;
+}
+
+
+
+
+
+BBRenderPlayHandle::BBRenderPlayHandle(
+				const std::shared_ptr<BBRenderCache::Playback> & _playback,
+				InstrumentTrack * _track, Track * _bbTrack,
+				f_cnt_t _offset ) :
+	PlayHandle( TypeBBRenderPlayHandle, _offset ),
+	m_playback( _playback ),
+	m_render( _playback->render ),
+	m_track( _track ),
+	m_bbTrack( _bbTrack ),
+	m_frame( 0 ),
+	m_finished( false )
+{
+	setAudioPort( _track->audioPort() );
+}
+
+
+
+
+void BBRenderPlayHandle::play( sampleFrame * _working_buffer )
+{
+	const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+
+	sampleFrame * buf = _working_buffer;
+	f_cnt_t frames = fpp;
+	if( m_frame == 0 )
+	{
+		buf += offset();
+		frames -= offset();
+	}
+
+	// the notes only sound as rendered while the song plays through the
+	// whole repetition - otherwise fade out what was started so far
+	BBRenderCache::Playback * p = m_playback.get();
+	if( !p->cut && p->nextTick < p->ticks &&
+		( Controller::runningPeriods() + 1 ) * fpp - p->lastTick >
+						Engine::framesPerTick() + 2 )
+	{
+		p->cut = true;
+	}
+
+	const f_cnt_t todo = qBound<f_cnt_t>( 0,
+				m_render->frames() - m_frame, frames );
+	if( !( m_bbTrack && m_bbTrack->isMuted() ) )
+	{
+		// same as InstrumentTrack::processAudioBuffer() does for notes
+		m_track->audioPort()->effects()->startRunning();
+		memcpy( buf, m_render->data() + m_frame,
+					todo * sizeof( sampleFrame ) );
+		if( p->cut )
+		{
+			for( f_cnt_t f = 0; f < todo; ++f )
+			{
+				const float gain = 1.0f - f / (float) todo;
+				buf[f][0] *= gain;
+				buf[f][1] *= gain;
+			}
+		}
+	}
+
+	m_frame += frames;
+	m_finished = p->cut || m_frame >= m_render->frames();
+}
+
+
+
+
+bool BBRenderPlayHandle::isFinished() const
+{
+	return m_finished;
+}
+
+
+
+
+bool BBRenderPlayHandle::isFromTrack( const Track * _track ) const
+{
+	return m_track == _track || m_bbTrack == _track;
+}
+
+
+
+
+
+BBRenderCache::BBRenderCache() :
+	m_frames( 0 )
+{
+}
+
+
+
+
+BBRenderCache::~BBRenderCache()
+{
+	clear();
+}
+
+
+
+
+bool BBRenderCache::isEnabled()
+{
+	return ConfigManager::inst()->value( "mixer", "bbrendercache" ).toInt();
+}
+
+
+
+
+bool BBRenderCache::processTick( InstrumentTrack * _track, Pattern * _pattern,
+				int _bb, Track * _bbTrack, const MidiTime & _tick,
+				f_cnt_t _offset, BBRender ** _render )
+{
+	*_render = NULL;
+
+	const PlaybackKey pk( _track, _bb );
+	PlaybackMap::iterator it = m_playbacks.find( pk );
+	if( it != m_playbacks.end() &&
+		( _tick.getTicks() != ( *it )->nextTick ||
+			( *it )->key.tempo != Engine::getSong()->getTempo() ) )
+	{
+		// the song left the repetition, e.g. because of a jump
+		endPlayback( **it );
+		m_playbacks.erase( it );
+		it = m_playbacks.end();
+	}
+
+	if( it == m_playbacks.end() )
+	{
+		if( _tick.getTicks() != 0 || !isEnabled() )
+		{
+			return false;
+		}
+		std::shared_ptr<Playback> p =
+			startRepetition( _track, _pattern, _bb, _bbTrack, _offset );
+		if( !p )
+		{
+			return false;
+		}
+		it = m_playbacks.insert( pk, p );
+	}
+
+	Playback * p = it->get();
+	p->lastTick = Controller::runningPeriods() *
+				Engine::mixer()->framesPerPeriod() + _offset;
+	const bool fromCache = p->fromCache;
+	if( !fromCache )
+	{
+		*_render = p->render.get();
+	}
+
+	if( ++p->nextTick >= p->ticks )
+	{
+		if( !fromCache )
+		{
+			p->render->finishRepetition();
+		}
+		m_playbacks.erase( it );
+	}
+
+	return fromCache;
+}
+
+
+
+
+void BBRenderCache::removeTrack( const InstrumentTrack * _track )
+{
+	Engine::mixer()->requestChangeInModel();
+
+	for( PlaybackMap::iterator it = m_playbacks.begin();
+						it != m_playbacks.end(); )
+	{
+		if( it.key().first == _track )
+		{
+			endPlayback( **it );
+			it = m_playbacks.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for( QHash<Key, Entry>::iterator it = m_entries.begin();
+						it != m_entries.end(); )
+	{
+		if( it.key().track == _track )
+		{
+			m_frames -= it->render->frames();
+			it = m_entries.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	Engine::mixer()->doneChangeInModel();
+}
+
+
+
+
+void BBRenderCache::clear()
+{
+	Engine::mixer()->requestChangeInModel();
+
+	for( const std::shared_ptr<Playback> & p : m_playbacks )
+	{
+		endPlayback( *p );
+	}
+	m_playbacks.clear();
+	m_entries.clear();
+	m_frames = 0;
+
+	Engine::mixer()->doneChangeInModel();
+}
+
+
+
+
+std::shared_ptr<BBRenderCache::Playback> BBRenderCache::startRepetition(
+				InstrumentTrack * _track, Pattern * _pattern,
+				int _bb, Track * _bbTrack, f_cnt_t _offset )
+{
+	Song * song = Engine::getSong();
+
+	std::shared_ptr<Playback> p = std::make_shared<Playback>();
+	p->key.track = _track;
+	p->key.bb = _bb;
+	p->key.tempo = song->getTempo();
+	p->key.numerator = song->getTimeSigModel().getNumerator();
+	p->key.denominator = song->getTimeSigModel().getDenominator();
+	p->key.sampleRate = Engine::mixer()->processingSampleRate();
+	p->nextTick = 0;
+	p->ticks = Engine::getBBTrackContainer()->lengthOfBB( _bb ) *
+						MidiTime::ticksPerBar();
+	p->lastTick = 0;
+	p->fromCache = false;
+	p->cut = false;
+
+	if( !_track->hashPatternOutput( _pattern, &p->key.hash ) ||
+					!playsThrough( _bbTrack, p->ticks ) )
+	{
+		return std::shared_ptr<Playback>();
+	}
+	// notes beyond the end of the beat/bassline aren't played
+	p->key.hash = p->key.hash * 31 + p->ticks;
+
+	collectRenders();
+
+	QHash<Key, Entry>::iterator entry = m_entries.find( p->key );
+	if( entry != m_entries.end() )
+	{
+		entry->lastUse = Controller::runningPeriods();
+		p->render = entry->render;
+		p->fromCache = true;
+		if( !Engine::mixer()->addPlayHandle( new BBRenderPlayHandle(
+					p, _track, _bbTrack, _offset ) ) )
+		{
+			return std::shared_ptr<Playback>();
+		}
+		return p;
+	}
+
+	// the previous repetition may still be rendering its tails - play
+	// this one the usual way until it's done
+	for( const Recording & r : m_recordings )
+	{
+		if( r.first == p->key && !r.second->isAborted() )
+		{
+			return std::shared_ptr<Playback>();
+		}
+	}
+
+	p->render = std::make_shared<BBRender>( _offset );
+	m_recordings.append( qMakePair( p->key, p->render ) );
+	return p;
+}
+
+
+
+
+void BBRenderCache::endPlayback( Playback & _playback )
+{
+	if( _playback.fromCache )
+	{
+		_playback.cut = true;
+	}
+	else
+	{
+		_playback.render->abort();
+	}
+}
+
+
+
+
+void BBRenderCache::collectRenders()
+{
+	for( QList<Recording>::iterator it = m_recordings.begin();
+						it != m_recordings.end(); )
+	{
+		const std::shared_ptr<BBRender> & render = it->second;
+		if( !render->isDone() )
+		{
+			++it;
+			continue;
+		}
+
+		if( render->isComplete() && render->frames() > 0 )
+		{
+			shrink( render->frames() );
+			Entry entry = { render, Controller::runningPeriods() };
+			m_entries.insert( it->first, entry );
+			m_frames += render->frames();
+		}
+		it = m_recordings.erase( it );
+	}
+}
+
+
+
+
+void BBRenderCache::shrink( f_cnt_t _frames )
+{
+	// drop the renders that weren't played for the longest time
+	while( !m_entries.isEmpty() && m_frames + _frames > MaximumFrames )
+	{
+		QHash<Key, Entry>::iterator oldest = m_entries.begin();
+		for( QHash<Key, Entry>::iterator it = m_entries.begin();
+						it != m_entries.end(); ++it )
+		{
+			if( it->lastUse < oldest->lastUse )
+			{
+				oldest = it;
+			}
+		}
+		m_frames -= oldest->render->frames();
+		m_entries.erase( oldest );
+	}
+}
+
+
+
+
+bool BBRenderCache::playsThrough( Track * _bbTrack, tick_t _ticks )
+{
+	Song * song = Engine::getSong();
+	if( song->playMode() == Song::Mode_PlayBB )
+	{
+		return true;
+	}
+	if( song->playMode() != Song::Mode_PlaySong )
+	{
+		return false;
+	}
+
+	const Song::PlayPos & pos = song->getPlayPos( Song::Mode_PlaySong );
+	const MidiTime end = pos.getTicks() + _ticks;
+
+	TimeLineWidget * tl = pos.m_timeLine;
+	if( tl != NULL && tl->loopPointsEnabled() &&
+				pos < tl->loopEnd() && end > tl->loopEnd() )
+	{
+		return false;
+	}
+
+	// a beat/bassline-TCO ending within the repetition stops its notes
+	Track::tcoVector tcos;
+	_bbTrack->getTCOsInRange( tcos, pos, end );
+	for( TrackContentObject * tco : tcos )
+	{
+		if( !tco->isMuted() && tco->startPosition() <= pos &&
+						tco->endPosition() >= end )
+		{
+			return true;
+		}
+	}
+	return false;
+}
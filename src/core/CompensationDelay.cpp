@@ -0,0 +1,98 @@
+/*
+ * CompensationDelay.cpp - delays audio to line up paths of different latency
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "CompensationDelay.h"
+
+#include "BufferManager.h"
+#include "Engine.h"
+#include "Mixer.h"
+#include "RingBuffer.h"
+
+
+CompensationDelay::CompensationDelay() :
+	m_delay( 0 ),
+	m_pending( 0 )
+{
+}
+
+
+
+
+CompensationDelay::~CompensationDelay()
+{
+}
+
+
+
+
+void CompensationDelay::setDelay( f_cnt_t _frames )
+{
+	if( _frames == m_delay )
+	{
+		return;
+	}
+
+	m_delay = _frames;
+	m_pending = 0;
+	if( m_delay == 0 )
+	{
+		m_ring.reset();
+	}
+	else if( m_ring )
+	{
+		m_ring->changeSize( m_delay );
+	}
+	else
+	{
+		m_ring.reset( new RingBuffer( m_delay ) );
+	}
+}
+
+
+
+
+bool CompensationDelay::process( sampleFrame * _buf, bool _hasInput )
+{
+	if( m_delay == 0 )
+	{
+		return _hasInput;
+	}
+
+	const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+	if( _hasInput )
+	{
+		m_pending = m_delay + fpp;
+	}
+	else if( m_pending > 0 )
+	{
+		BufferManager::clear( _buf, fpp );
+	}
+	else
+	{
+		return false;
+	}
+
+	m_ring->write( _buf, m_delay );
+	m_ring->pop( _buf );
+	m_pending = qMax<f_cnt_t>( m_pending - fpp, 0 );
+	return true;
+}
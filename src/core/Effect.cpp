@@ -26,9 +26,12 @@
 #include <QDomElement>
 
 #include "Effect.h"
+#include "BufferManager.h"
 #include "EffectChain.h"
 #include "EffectControls.h"
 #include "EffectView.h"
+#include "FxMixer.h"
+#include "PlanarBuffer.h"
 
 #include "ConfigManager.h"
 
@@ -41,6 +44,7 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 	m_processors( 1 ),
 	m_okay( true ),
 	m_noRun( false ),
+	m_wetOnly( false ),
 	m_running( false ),
 	m_bufferCount( 0 ),
 	m_enabledModel( true, this, tr( "Effect enabled" ) ),
@@ -56,6 +60,10 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 	{
 		m_autoQuitDisabled = true;
 	}
+
+	// a disabled effect doesn't delay its input
+	connect( &m_enabledModel, SIGNAL( dataChanged() ),
+					this, SLOT( latencyChanged() ) );
 }
 
 
@@ -135,6 +143,40 @@ Effect * Effect::instantiate( const QString& pluginName,
 
 
 
+bool Effect::processAudioBuffer( sampleFrame * _buf, const fpp_t _frames )
+{
+	// wet-only effects processed outside of an effect chain, anything
+	// else would silently pass its input through here
+	Q_ASSERT_X( isWetOnly(), "Effect::processAudioBuffer",
+				"effect neither wet-only nor processing audio" );
+	if( !isWetOnly() )
+	{
+		return false;
+	}
+
+	sampleFrame * dry = BufferManager::acquire();
+	const bool running = EffectChain::processWetOnly( this, _buf, dry,
+								_frames );
+	BufferManager::release( dry );
+	return running;
+}
+
+
+
+
+bool Effect::processPlanarBuffer( PlanarBuffer & _buf, const fpp_t _frames )
+{
+	sampleFrame * buf = BufferManager::acquire();
+	_buf.toInterleaved( buf, _frames );
+	const bool running = processAudioBuffer( buf, _frames );
+	_buf.fromInterleaved( buf, _frames );
+	BufferManager::release( buf );
+	return running;
+}
+
+
+
+
 void Effect::checkGate( double _out_sum )
 {
 	if( m_autoQuitDisabled )
@@ -162,6 +204,22 @@ void Effect::checkGate( double _out_sum )
 
 
 
+void Effect::latencyChanged()
+{
+	if( isWetOnly() )
+	{
+		m_dryDelay.setDelay( latency() );
+	}
+
+	if( Engine::fxMixer() )
+	{
+		Engine::fxMixer()->invalidateLatency();
+	}
+}
+
+
+
+
 PluginView * Effect::instantiateView( QWidget * _parent )
 {
 	return new EffectView( this, _parent );
@@ -24,11 +24,13 @@
  */
 
 
+#include <cstring>
 #include <QDomElement>
 
 #include "EffectChain.h"
 #include "Effect.h"
 #include "DummyEffect.h"
+#include "FxMixer.h"
 #include "MixHelpers.h"
 #include "Song.h"
 
@@ -36,8 +38,11 @@
 EffectChain::EffectChain( Model * _parent ) :
 	Model( _parent ),
 	SerializingObject(),
-	m_enabledModel( false, NULL, tr( "Effects enabled" ) )
+	m_enabledModel( false, NULL, tr( "Effects enabled" ) ),
+	m_dryBuffer( NULL )
 {
+	connect( &m_enabledModel, SIGNAL( dataChanged() ),
+					this, SLOT( latencyChanged() ) );
 }
 
 
@@ -46,6 +51,7 @@ EffectChain::EffectChain( Model * _parent ) :
 EffectChain::~EffectChain()
 {
 	clear();
+	MM_FREE( m_dryBuffer );
 }
 
 
@@ -107,6 +113,7 @@ void EffectChain::loadSettings( const QDomElement & _this )
 				e = new DummyEffect( parentModel(), effectData );
 			}
 
+			allocateBuffers();
 			m_effects.push_back( e );
 			++fx_loaded;
 		}
@@ -122,10 +129,12 @@ void EffectChain::loadSettings( const QDomElement & _this )
 void EffectChain::appendEffect( Effect * _effect )
 {
 	Engine::mixer()->requestChangeInModel();
+	allocateBuffers();
 	m_effects.append( _effect );
 	Engine::mixer()->doneChangeInModel();
 
 	m_enabledModel.setValue( true );
+	latencyChanged();
 
 	emit dataChanged();
 }
@@ -151,6 +160,7 @@ void EffectChain::removeEffect( Effect * _effect )
 	{
 		m_enabledModel.setValue( false );
 	}
+	latencyChanged();
 
 	emit dataChanged();
 }
@@ -191,16 +201,52 @@ bool EffectChain::processAudioBuffer( sampleFrame * _buf, const fpp_t _frames, b
 
 	MixHelpers::sanitize( _buf, _frames );
 
+	// effects get the layout they prefer, the buffer is only converted
+	// between two effects preferring different layouts
+	bool planar = false;
 	bool moreEffects = false;
 	for( EffectList::Iterator it = m_effects.begin(); it != m_effects.end(); ++it )
 	{
-		if( hasInputNoise || ( *it )->isRunning() )
+		if( !hasInputNoise && !( *it )->isRunning() )
 		{
-			moreEffects |= ( *it )->processAudioBuffer( _buf, _frames );
+			continue;
+		}
+
+		const bool wantsPlanar =
+			( *it )->preferredLayout() == Effect::PlanarLayout;
+		if( wantsPlanar != planar )
+		{
+			if( wantsPlanar )
+			{
+				m_planarBuffer.reserve( _frames );
+				m_planarBuffer.fromInterleaved( _buf, _frames );
+			}
+			else
+			{
+				m_planarBuffer.toInterleaved( _buf, _frames );
+			}
+			planar = wantsPlanar;
+		}
+
+		if( planar )
+		{
+			moreEffects |= ( *it )->processPlanarBuffer( m_planarBuffer, _frames );
+			MixHelpers::sanitize( m_planarBuffer.channels(), _frames );
+		}
+		else
+		{
+			moreEffects |= ( *it )->isWetOnly() ?
+				processWetOnly( *it, _buf, m_dryBuffer, _frames ) :
+				( *it )->processAudioBuffer( _buf, _frames );
 			MixHelpers::sanitize( _buf, _frames );
 		}
 	}
 
+	if( planar )
+	{
+		m_planarBuffer.toInterleaved( _buf, _frames );
+	}
+
 	return moreEffects;
 }
 
@@ -224,6 +270,60 @@ void EffectChain::startRunning()
 
 
 
+bool EffectChain::processWetOnly( Effect * _effect, sampleFrame * _buf,
+					sampleFrame * _dry, const fpp_t _frames )
+{
+	if( !_effect->isEnabled() || !_effect->isRunning() )
+	{
+		return false;
+	}
+
+	const float d = _effect->dryLevel();
+	const float w = _effect->wetLevel();
+	// the dry delay is fed even while the dry signal isn't mixed in, so it
+	// doesn't play out stale audio once the dry level is raised again
+	if( d != 0.0f || _effect->m_dryDelay.delay() > 0 )
+	{
+		memcpy( _dry, _buf, _frames * sizeof( sampleFrame ) );
+		_effect->m_dryDelay.process( _dry, true );
+	}
+
+	_effect->processWetBuffer( _buf, _frames );
+
+	// fully wet effects don't need the mix with the dry signal
+	const float energy = d != 0.0f ?
+		MixHelpers::multiplyAndAddMultipliedEnergy( _buf, _dry, w, d,
+								_frames ) :
+		MixHelpers::energy( _buf, _frames );
+	_effect->checkGate( energy / _frames );
+
+	return _effect->isRunning();
+}
+
+
+
+
+f_cnt_t EffectChain::latency() const
+{
+	if( m_enabledModel.value() == false )
+	{
+		return 0;
+	}
+
+	f_cnt_t frames = 0;
+	for( const Effect * effect : m_effects )
+	{
+		if( effect->isEnabled() )
+		{
+			frames += effect->latency();
+		}
+	}
+	return frames;
+}
+
+
+
+
 void EffectChain::clear()
 {
 	emit aboutToClear();
@@ -240,4 +340,29 @@ void EffectChain::clear()
 	Engine::mixer()->doneChangeInModel();
 
 	m_enabledModel.setValue( false );
+	latencyChanged();
+}
+
+
+
+
+void EffectChain::latencyChanged()
+{
+	if( Engine::fxMixer() )
+	{
+		Engine::fxMixer()->invalidateLatency();
+	}
+}
+
+
+
+
+void EffectChain::allocateBuffers()
+{
+	const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+	m_planarBuffer.reserve( fpp );
+	if( m_dryBuffer == NULL )
+	{
+		m_dryBuffer = MM_ALLOC( sampleFrame, fpp );
+	}
 }
@@ -22,8 +22,10 @@
  *
  */
 
+#include <cstring>
 #include <QDomElement>
 
+#include "AudioPort.h"
 #include "BufferManager.h"
 #include "FxMixer.h"
 #include "Mixer.h"
@@ -65,6 +67,7 @@ FxChannel::FxChannel( int idx, Model * _parent ) :
 	m_peakLeft( 0.0f ),
 	m_peakRight( 0.0f ),
 	m_buffer( new sampleFrame[Engine::mixer()->framesPerPeriod()] ),
+	m_stemBuffer( NULL ),
 	m_muteModel( false, _parent ),
 	m_soloModel( false, _parent ),
 	m_volumeModel( 1.0, 0.0, 2.0, 0.001, _parent ),
@@ -72,6 +75,7 @@ FxChannel::FxChannel( int idx, Model * _parent ) :
 	m_lock(),
 	m_channelIndex( idx ),
 	m_queued( false ),
+	m_latency( 0 ),
 	m_dependenciesMet(0)
 {
 	BufferManager::clear( m_buffer, Engine::mixer()->framesPerPeriod() );
@@ -127,15 +131,30 @@ void FxChannel::doProcessing()
 			FloatModel * sendModel = senderRoute->amount();
 			if( ! sendModel ) qFatal( "Error: no send model found from %d to %d", senderRoute->senderIndex(), m_channelIndex );
 
-			if( sender->m_hasInput || sender->m_stillRunning )
+			bool active = sender->m_hasInput || sender->m_stillRunning;
+
+			// mix it's output with this one's output, delayed to
+			// line up with the other inputs if necessary
+			sampleFrame * ch_buf = sender->m_buffer;
+			sampleFrame * delayed = NULL;
+			CompensationDelay * compensation = senderRoute->compensation();
+			if( compensation->delay() > 0 )
+			{
+				delayed = BufferManager::acquire();
+				if( active )
+				{
+					memcpy( delayed, ch_buf, fpp * sizeof( sampleFrame ) );
+				}
+				active = compensation->process( delayed, active );
+				ch_buf = delayed;
+			}
+
+			if( active )
 			{
 				// figure out if we're getting sample-exact input
 				ValueBuffer * sendBuf = sendModel->valueBuffer();
 				ValueBuffer * volBuf = sender->m_volumeModel.valueBuffer();
 
-				// mix it's output with this one's output
-				sampleFrame * ch_buf = sender->m_buffer;
-
 				// use sample-exact mixing if sample-exact values are available
 				if( ! volBuf && ! sendBuf ) // neither volume nor send has sample-exact data...
 				{
@@ -158,6 +177,11 @@ void FxChannel::doProcessing()
 				}
 				m_hasInput = true;
 			}
+
+			if( delayed )
+			{
+				BufferManager::release( delayed );
+			}
 		}
 
 
@@ -174,6 +198,11 @@ void FxChannel::doProcessing()
 		Mixer::StereoSample peakSamples = Engine::mixer()->getPeakValues(m_buffer, fpp);
 		m_peakLeft = qMax( m_peakLeft, peakSamples.left * v );
 		m_peakRight = qMax( m_peakRight, peakSamples.right * v );
+
+		if( m_stemBuffer && ( m_hasInput || m_stillRunning ) )
+		{
+			MixHelpers::addMultiplied( m_stemBuffer, m_buffer, v, fpp );
+		}
 	}
 	else
 	{
@@ -189,7 +218,8 @@ void FxChannel::doProcessing()
 FxMixer::FxMixer() :
 	Model( NULL ),
 	JournallingObject(),
-	m_fxChannels()
+	m_fxChannels(),
+	m_latencyChanged( true )
 {
 	// create master channel
 	createChannel();
@@ -223,6 +253,8 @@ int FxMixer::createChannel()
 	// reset channel state
 	clearChannel( index );
 
+	invalidateLatency();
+
 	return index;
 }
 
@@ -363,6 +395,8 @@ void FxMixer::deleteChannel( int index )
 		}
 	}
 
+	invalidateLatency();
+
 	Engine::mixer()->doneChangeInModel();
 }
 
@@ -427,6 +461,8 @@ void FxMixer::moveChannelLeft( int index )
 	// Update m_channelIndex of both channels
 	m_fxChannels[index]->m_channelIndex = index;
 	m_fxChannels[index - 1]->m_channelIndex = index -1;
+
+	invalidateLatency();
 }
 
 
@@ -478,6 +514,7 @@ FxRoute * FxMixer::createRoute( FxChannel * from, FxChannel * to, float amount )
 
 	// add us to fxmixer's list
 	Engine::fxMixer()->m_fxRoutes.append( route );
+	invalidateLatency();
 	Engine::mixer()->doneChangeInModel();
 
 	return route;
@@ -513,6 +550,7 @@ void FxMixer::deleteChannelSend( FxRoute * route )
 	// remove us from fxmixer's list
 	Engine::fxMixer()->m_fxRoutes.remove( Engine::fxMixer()->m_fxRoutes.indexOf( route ) );
 	delete route;
+	invalidateLatency();
 	Engine::mixer()->doneChangeInModel();
 }
 
@@ -594,12 +632,78 @@ void FxMixer::mixToChannel( const sampleFrame * _buf, fx_ch_t _ch )
 
 void FxMixer::prepareMasterMix()
 {
+	if( m_latencyChanged.exchange( false ) )
+	{
+		updateLatencies();
+	}
+
 	BufferManager::clear( m_fxChannels[0]->m_buffer,
 					Engine::mixer()->framesPerPeriod() );
 }
 
 
 
+
+void FxMixer::updateLatencies()
+{
+	// latency with which the input of each channel arrives
+	QVector<f_cnt_t> arrival( m_fxChannels.size(), 0 );
+	for( const AudioPort * port : Engine::mixer()->audioPorts() )
+	{
+		const fx_ch_t ch = port->nextFxChannel();
+		if( ch < m_fxChannels.size() )
+		{
+			arrival[ch] = qMax( arrival[ch], port->latency() );
+		}
+	}
+
+	// go through the channels in an order where senders come before their
+	// receivers, which always exists as the mixer doesn't allow loops
+	QVector<int> pending( m_fxChannels.size() );
+	QVector<FxChannel *> ready;
+	for( FxChannel * ch : m_fxChannels )
+	{
+		pending[ch->m_channelIndex] = ch->m_receives.size();
+		if( ch->m_receives.isEmpty() )
+		{
+			ready.append( ch );
+		}
+	}
+	while( !ready.isEmpty() )
+	{
+		FxChannel * ch = ready.takeLast();
+		ch->m_latency = arrival[ch->m_channelIndex] +
+						ch->m_fxChain.latency();
+		for( FxRoute * route : ch->m_sends )
+		{
+			const int to = route->receiverIndex();
+			arrival[to] = qMax( arrival[to], ch->m_latency );
+			if( --pending[to] == 0 )
+			{
+				ready.append( route->receiver() );
+			}
+		}
+	}
+
+	// delay everything arriving earlier than the slowest input
+	for( AudioPort * port : Engine::mixer()->audioPorts() )
+	{
+		const fx_ch_t ch = port->nextFxChannel();
+		if( ch < m_fxChannels.size() )
+		{
+			port->setCompensationDelay( arrival[ch] - port->latency() );
+		}
+	}
+	for( FxRoute * route : m_fxRoutes )
+	{
+		route->compensation()->setDelay(
+			arrival[route->receiverIndex()] -
+						route->sender()->m_latency );
+	}
+}
+
+
+
 void FxMixer::masterMix( sampleFrame * _buf )
 {
 	const int fpp = Engine::mixer()->framesPerPeriod();
@@ -105,6 +105,14 @@ void Instrument::applyRelease( sampleFrame * buf, const NotePlayHandle * _n )
 
 
 
+void Instrument::latencyChanged()
+{
+	instrumentTrack()->audioPort()->setSourceLatency( latency() );
+}
+
+
+
+
 QString Instrument::fullDisplayName() const
 {
 	return instrumentTrack()->displayName();
@@ -299,6 +299,21 @@ f_cnt_t InstrumentSoundShaping::envFrames( const bool _only_vol ) const
 
 
 
+bool InstrumentSoundShaping::usesLfo() const
+{
+	for( int i = Volume; i < NumTargets; ++i )
+	{
+		if( m_envLfoParameters[i]->isLfoUsed() )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
 f_cnt_t InstrumentSoundShaping::releaseFrames() const
 {
 	if( !m_instrumentTrack->instrument() )
@@ -25,9 +25,13 @@
  */
 
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QLibrary>
+#include <QSaveFile>
+#include <QStandardPaths>
 
 #include <math.h>
 
@@ -36,6 +40,86 @@
 #include "PluginFactory.h"
 
 
+static const quint32 MANIFEST_MAGIC = 0x4c414450;
+static const quint32 MANIFEST_VERSION = 1;
+
+
+// descriptor of a plugin as saved in the manifest - enough to list it and
+// its ports, the library is only loaded when it's instantiated
+struct LadspaManifestEntry
+{
+	uint32_t index;
+	unsigned long uniqueID;
+	LADSPA_Properties properties;
+	QByteArray label;
+	QByteArray name;
+	QByteArray maker;
+	QByteArray copyright;
+	QVector<LADSPA_PortDescriptor> portDescriptors;
+	QList<QByteArray> portNames;
+	QVector<const char *> portNamePointers;
+	QVector<LADSPA_PortRangeHint> portRangeHints;
+
+	LADSPA_Descriptor descriptor;
+
+	// points the descriptor to the data above
+	void updateDescriptor()
+	{
+		portNamePointers.clear();
+		for( const QByteArray & portName : portNames )
+		{
+			portNamePointers << portName.constData();
+		}
+
+		memset( &descriptor, 0, sizeof( descriptor ) );
+		descriptor.UniqueID = uniqueID;
+		descriptor.Label = label.constData();
+		descriptor.Properties = properties;
+		descriptor.Name = name.constData();
+		descriptor.Maker = maker.constData();
+		descriptor.Copyright = copyright.constData();
+		descriptor.PortCount = portDescriptors.size();
+		descriptor.PortDescriptors = portDescriptors.constData();
+		descriptor.PortNames = portNamePointers.constData();
+		descriptor.PortRangeHints = portRangeHints.constData();
+	}
+} ;
+
+
+
+
+struct LadspaManifestLibrary
+{
+	LadspaManifestLibrary() :
+		modified( 0 ),
+		size( 0 ),
+		descriptorFunction( NULL )
+	{
+	}
+
+	~LadspaManifestLibrary()
+	{
+		qDeleteAll( plugins );
+	}
+
+	qint64 modified;
+	qint64 size;
+	// set if the library was loaded for scanning it
+	LADSPA_Descriptor_Function descriptorFunction;
+	QList<LadspaManifestEntry *> plugins;
+} ;
+
+
+
+
+static QString manifestPath()
+{
+	return QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) +
+							"/ladspa-manifest";
+}
+
+
+
 
 LadspaManager::LadspaManager()
 {
@@ -56,6 +140,11 @@ LadspaManager::LadspaManager()
 	ladspaDirectories.push_back( "/Library/Audio/Plug-Ins/LADSPA" );
 #endif
 
+	readManifest();
+
+	QHash<QString, LadspaManifestLibrary *> found;
+	bool manifestChanged = false;
+
 	for( QStringList::iterator it = ladspaDirectories.begin(); 
 			 		   it != ladspaDirectories.end(); ++it )
 	{
@@ -77,25 +166,38 @@ LadspaManager::LadspaManager()
 				continue;
 			}
 
-			QLibrary plugin_lib( f.absoluteFilePath() );
-
-			if( plugin_lib.load() == true )
+			const QString path = f.absoluteFilePath();
+			if( found.contains( path ) )
 			{
-				LADSPA_Descriptor_Function descriptorFunction =
-			( LADSPA_Descriptor_Function ) plugin_lib.resolve(
-							"ladspa_descriptor" );
-				if( descriptorFunction != NULL )
-				{
-					addPlugins( descriptorFunction,
-							f.fileName() );
-				}
+				continue;
 			}
-			else
+
+			// only load libraries that changed since the last start
+			LadspaManifestLibrary * library = m_manifest.take( path );
+			if( library == NULL ||
+				library->modified !=
+					f.lastModified().toMSecsSinceEpoch() ||
+				library->size != f.size() )
 			{
-				qWarning() << plugin_lib.errorString();
+				delete library;
+				library = scanLibrary( f );
+				manifestChanged = true;
 			}
+
+			found[path] = library;
+			addPlugins( library, f.fileName(), path );
 		}
 	}
+
+	// whatever is left wasn't found anymore
+	manifestChanged = manifestChanged || !m_manifest.isEmpty();
+	qDeleteAll( m_manifest );
+	m_manifest = found;
+
+	if( manifestChanged )
+	{
+		writeManifest();
+	}
 	
 	l_ladspa_key_t keys = m_ladspaManagerMap.keys();
 	for( l_ladspa_key_t::iterator it = keys.begin();
@@ -116,6 +218,7 @@ LadspaManager::~LadspaManager()
 	{
 		delete it.value();
 	}
+	qDeleteAll( m_manifest );
 }
 
 
@@ -137,17 +240,12 @@ ladspaManagerDescription * LadspaManager::getDescription(
 
 
 
-void LadspaManager::addPlugins(
-		LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file )
+void LadspaManager::addPlugins( const LadspaManifestLibrary * _library,
+				const QString & _file, const QString & _path )
 {
-	const LADSPA_Descriptor * descriptor;
-
-	for( long pluginIndex = 0;
-		( descriptor = _descriptor_func( pluginIndex ) ) != NULL;
-								++pluginIndex )
+	for( const LadspaManifestEntry * entry : _library->plugins )
 	{
-		ladspa_key_t key( _file, QString( descriptor->Label ) );
+		ladspa_key_t key( _file, QString( entry->label ) );
 		if( m_ladspaManagerMap.contains( key ) )
 		{
 			continue;
@@ -155,10 +253,12 @@ void LadspaManager::addPlugins(
 
 		ladspaManagerDescription * plugIn = 
 				new ladspaManagerDescription;
-		plugIn->descriptorFunction = _descriptor_func;
-		plugIn->index = pluginIndex;
-		plugIn->inputChannels = getPluginInputs( descriptor );
-		plugIn->outputChannels = getPluginOutputs( descriptor );
+		plugIn->descriptorFunction = _library->descriptorFunction;
+		plugIn->index = entry->index;
+		plugIn->file = _path;
+		plugIn->metadata = &entry->descriptor;
+		plugIn->inputChannels = getPluginInputs( plugIn->metadata );
+		plugIn->outputChannels = getPluginOutputs( plugIn->metadata );
 
 		if( plugIn->inputChannels == 0 && plugIn->outputChannels > 0 )
 		{
@@ -186,6 +286,226 @@ void LadspaManager::addPlugins(
 
 
 
+LadspaManifestLibrary * LadspaManager::scanLibrary( const QFileInfo & _file )
+{
+	LadspaManifestLibrary * library = new LadspaManifestLibrary;
+	library->modified = _file.lastModified().toMSecsSinceEpoch();
+	library->size = _file.size();
+
+	QLibrary plugin_lib( _file.absoluteFilePath() );
+	if( plugin_lib.load() == false )
+	{
+		// remembered as a library without plugins until it changes
+		qWarning() << plugin_lib.errorString();
+		return library;
+	}
+
+	library->descriptorFunction = ( LADSPA_Descriptor_Function )
+				plugin_lib.resolve( "ladspa_descriptor" );
+	if( library->descriptorFunction == NULL )
+	{
+		return library;
+	}
+
+	const LADSPA_Descriptor * descriptor;
+	for( long pluginIndex = 0; ( descriptor =
+			library->descriptorFunction( pluginIndex ) ) != NULL;
+								++pluginIndex )
+	{
+		LadspaManifestEntry * entry = new LadspaManifestEntry;
+		entry->index = pluginIndex;
+		entry->uniqueID = descriptor->UniqueID;
+		entry->properties = descriptor->Properties;
+		entry->label = descriptor->Label;
+		entry->name = descriptor->Name;
+		entry->maker = descriptor->Maker;
+		entry->copyright = descriptor->Copyright;
+		for( unsigned long port = 0; port < descriptor->PortCount;
+									++port )
+		{
+			entry->portDescriptors <<
+					descriptor->PortDescriptors[port];
+			entry->portNames << descriptor->PortNames[port];
+			entry->portRangeHints <<
+					descriptor->PortRangeHints[port];
+		}
+		entry->updateDescriptor();
+		library->plugins << entry;
+	}
+
+	return library;
+}
+
+
+
+
+bool LadspaManager::loadLibrary( ladspaManagerDescription * _description,
+							const QString & _label )
+{
+	QMutexLocker locker( &m_loadMutex );
+	if( _description->descriptorFunction != NULL )
+	{
+		return true;
+	}
+
+	QLibrary plugin_lib( _description->file );
+	if( plugin_lib.load() == false )
+	{
+		qWarning() << plugin_lib.errorString();
+		return false;
+	}
+
+	LADSPA_Descriptor_Function descriptorFunction =
+		( LADSPA_Descriptor_Function ) plugin_lib.resolve(
+							"ladspa_descriptor" );
+	if( descriptorFunction == NULL )
+	{
+		return false;
+	}
+
+	// the library was changed while we were running
+	const LADSPA_Descriptor * descriptor =
+				descriptorFunction( _description->index );
+	if( descriptor == NULL || _label != descriptor->Label )
+	{
+		long pluginIndex = 0;
+		while( ( descriptor = descriptorFunction( pluginIndex ) ) !=
+				NULL && _label != descriptor->Label )
+		{
+			++pluginIndex;
+		}
+		if( descriptor == NULL )
+		{
+			return false;
+		}
+		_description->index = pluginIndex;
+	}
+
+	_description->descriptorFunction = descriptorFunction;
+	return true;
+}
+
+
+
+
+void LadspaManager::readManifest()
+{
+	QFile file( manifestPath() );
+	if( !file.open( QIODevice::ReadOnly ) )
+	{
+		return;
+	}
+
+	QDataStream in( &file );
+	in.setVersion( QDataStream::Qt_5_0 );
+	in.setFloatingPointPrecision( QDataStream::SinglePrecision );
+
+	quint32 magic, version, libraries;
+	in >> magic >> version >> libraries;
+	if( magic != MANIFEST_MAGIC || version != MANIFEST_VERSION )
+	{
+		return;
+	}
+
+	for( quint32 i = 0; i < libraries && in.status() == QDataStream::Ok;
+									++i )
+	{
+		QString path;
+		quint32 plugins;
+		LadspaManifestLibrary * library = new LadspaManifestLibrary;
+		in >> path >> library->modified >> library->size >> plugins;
+
+		for( quint32 p = 0; p < plugins &&
+				in.status() == QDataStream::Ok; ++p )
+		{
+			LadspaManifestEntry * entry = new LadspaManifestEntry;
+			quint32 index, uniqueID, properties, ports;
+			in >> index >> uniqueID >> properties >>
+				entry->label >> entry->name >>
+				entry->maker >> entry->copyright >> ports;
+			entry->index = index;
+			entry->uniqueID = uniqueID;
+			entry->properties = properties;
+
+			for( quint32 port = 0; port < ports &&
+				in.status() == QDataStream::Ok; ++port )
+			{
+				quint32 descriptor, hint;
+				QByteArray name;
+				LADSPA_PortRangeHint range;
+				in >> descriptor >> name >> hint >>
+					range.LowerBound >> range.UpperBound;
+				range.HintDescriptor = hint;
+				entry->portDescriptors << descriptor;
+				entry->portNames << name;
+				entry->portRangeHints << range;
+			}
+			entry->updateDescriptor();
+			library->plugins << entry;
+		}
+
+		m_manifest.insert( path, library );
+	}
+
+	if( in.status() != QDataStream::Ok )
+	{
+		// rather scan everything again than using a broken manifest
+		qDeleteAll( m_manifest );
+		m_manifest.clear();
+	}
+}
+
+
+
+
+void LadspaManager::writeManifest() const
+{
+	QDir().mkpath( QFileInfo( manifestPath() ).absolutePath() );
+
+	QSaveFile file( manifestPath() );
+	if( !file.open( QIODevice::WriteOnly ) )
+	{
+		return;
+	}
+
+	QDataStream out( &file );
+	out.setVersion( QDataStream::Qt_5_0 );
+	out.setFloatingPointPrecision( QDataStream::SinglePrecision );
+
+	out << MANIFEST_MAGIC << MANIFEST_VERSION <<
+					quint32( m_manifest.size() );
+	for( auto it = m_manifest.begin(); it != m_manifest.end(); ++it )
+	{
+		const LadspaManifestLibrary * library = it.value();
+		out << it.key() << library->modified << library->size <<
+					quint32( library->plugins.size() );
+		for( const LadspaManifestEntry * entry : library->plugins )
+		{
+			out << quint32( entry->index ) <<
+				quint32( entry->uniqueID ) <<
+				quint32( entry->properties ) <<
+				entry->label << entry->name <<
+				entry->maker << entry->copyright <<
+				quint32( entry->portDescriptors.size() );
+			for( int port = 0; port < entry->portDescriptors.size();
+									++port )
+			{
+				const LADSPA_PortRangeHint & range =
+						entry->portRangeHints[port];
+				out << quint32( entry->portDescriptors[port] ) <<
+					entry->portNames[port] <<
+					quint32( range.HintDescriptor ) <<
+					range.LowerBound << range.UpperBound;
+			}
+		}
+	}
+
+	file.commit();
+}
+
+
+
+
 uint16_t LadspaManager::getPluginInputs(
 		const LADSPA_Descriptor * _descriptor )
 {
@@ -237,7 +557,7 @@ uint16_t LadspaManager::getPluginOutputs(
 
 const LADSPA_PortDescriptor* LadspaManager::getPortDescriptor(const ladspa_key_t &_plugin, uint32_t _port)
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	if( descriptor && _port < getPortCount( _plugin ) )
 	{
 		return( & descriptor->PortDescriptors[_port] );
@@ -247,7 +567,7 @@ const LADSPA_PortDescriptor* LadspaManager::getPortDescriptor(const ladspa_key_t
 
 const LADSPA_PortRangeHint *LadspaManager::getPortRangeHint(const ladspa_key_t &_plugin, uint32_t _port)
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	if( descriptor && _port < getPortCount( _plugin ) )
 	{
 		return( & descriptor->PortRangeHints[_port] );
@@ -268,7 +588,7 @@ l_sortable_plugin_t LadspaManager::getSortedPlugins()
 
 QString LadspaManager::getLabel( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? descriptor->Label : "" );
 }
 
@@ -278,7 +598,7 @@ QString LadspaManager::getLabel( const ladspa_key_t & _plugin )
 bool LadspaManager::hasRealTimeDependency(
 					const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? LADSPA_IS_REALTIME( descriptor->Properties )
 					   : false );
 }
@@ -288,7 +608,7 @@ bool LadspaManager::hasRealTimeDependency(
 
 bool LadspaManager::isInplaceBroken( const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? LADSPA_IS_INPLACE_BROKEN( descriptor->Properties )
 					   : false );
 }
@@ -299,7 +619,7 @@ bool LadspaManager::isInplaceBroken( const ladspa_key_t &  _plugin )
 bool LadspaManager::isRealTimeCapable(
 					const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? LADSPA_IS_HARD_RT_CAPABLE( descriptor->Properties )
 					   : false );
 }
@@ -309,7 +629,7 @@ bool LadspaManager::isRealTimeCapable(
 
 QString LadspaManager::getName( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? descriptor->Name : "" );
 }
 
@@ -318,7 +638,7 @@ QString LadspaManager::getName( const ladspa_key_t & _plugin )
 
 QString LadspaManager::getMaker( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? descriptor->Maker : "" );
 }
 
@@ -327,7 +647,7 @@ QString LadspaManager::getMaker( const ladspa_key_t & _plugin )
 
 QString LadspaManager::getCopyright( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? descriptor->Copyright : "" );
 }
 
@@ -336,7 +656,7 @@ QString LadspaManager::getCopyright( const ladspa_key_t & _plugin )
 
 uint32_t LadspaManager::getPortCount( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? descriptor->PortCount : 0 );
 }
 
@@ -526,24 +846,11 @@ bool LadspaManager::isInteger( const ladspa_key_t & _plugin,
 
 bool LadspaManager::isEnum( const ladspa_key_t & _plugin, uint32_t _port )
 {
-	if( m_ladspaManagerMap.contains( _plugin )
-		   && _port < getPortCount( _plugin ) )
-	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
-		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
-		LADSPA_PortRangeHintDescriptor hintDescriptor =
-			descriptor->PortRangeHints[_port].HintDescriptor;
-		// This is an LMMS extension to ladspa
-		return( LADSPA_IS_HINT_INTEGER( hintDescriptor ) &&
-			LADSPA_IS_HINT_TOGGLED( hintDescriptor ) );
-	}
-	else
-	{
-		return( false );
-	}
+	const auto* portRangeHint = getPortRangeHint( _plugin, _port );
+	// This is an LMMS extension to ladspa
+	return( portRangeHint &&
+		LADSPA_IS_HINT_INTEGER( portRangeHint->HintDescriptor ) &&
+		LADSPA_IS_HINT_TOGGLED( portRangeHint->HintDescriptor ) );
 }
 
 
@@ -552,7 +859,7 @@ bool LadspaManager::isEnum( const ladspa_key_t & _plugin, uint32_t _port )
 QString LadspaManager::getPortName( const ladspa_key_t & _plugin,
 								uint32_t _port )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getMetadata( _plugin );
 	return( descriptor ? descriptor->PortNames[_port] : QString( "" ) );
 }
 
@@ -569,22 +876,27 @@ const void * LadspaManager::getImplementationData(
 
 
 
+const LADSPA_Descriptor * LadspaManager::getMetadata(
+						const ladspa_key_t & _plugin )
+{
+	ladspaManagerDescription * description =
+					m_ladspaManagerMap.value( _plugin );
+	return( description ? description->metadata : NULL );
+}
+
+
+
+
 const LADSPA_Descriptor * LadspaManager::getDescriptor(
 						const ladspa_key_t & _plugin )
 {
-	if( m_ladspaManagerMap.contains( _plugin ) )
-	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
-		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
-		return( descriptor );
-	}
-	else
+	ladspaManagerDescription * description =
+					m_ladspaManagerMap.value( _plugin );
+	if( description == NULL || !loadLibrary( description, _plugin.second ) )
 	{
 		return( NULL );
 	}
+	return( description->descriptorFunction( description->index ) );
 }
 
 
@@ -24,6 +24,7 @@
 
 #include "MixHelpers.h"
 
+#include <algorithm>
 #include <cstdio>
 
 #include "lmms_math.h"
@@ -124,6 +125,38 @@ bool sanitize( sampleFrame * src, int frames )
 	return found;
 }
 
+bool sanitize( sample_t * const * src, int frames )
+{
+	if( !useNaNHandler() )
+	{
+		return false;
+	}
+
+	for( int c = 0; c < DEFAULT_CHANNELS; ++c )
+	{
+		for( int f = 0; f < frames; ++f )
+		{
+			if( isinf( src[c][f] ) || isnan( src[c][f] ) )
+			{
+				#ifdef LMMS_DEBUG
+					printf("Bad data, clearing buffer. frame: ");
+					printf("%d: value %f\n", f, src[c][f]);
+				#endif
+				for( int c = 0; c < DEFAULT_CHANNELS; ++c )
+				{
+					std::fill( src[c], src[c] + frames, 0.0f );
+				}
+				return true;
+			}
+			else
+			{
+				src[c][f] = qBound( -1000.0f, src[c][f], 1000.0f );
+			}
+		}
+	}
+	return false;
+}
+
 
 struct AddOp
 {
@@ -324,5 +357,56 @@ void multiplyAndAddMultipliedJoined( sampleFrame* dst,
 	run<>( dst, srcLeft, srcRight, frames, MultiplyAndAddMultipliedOp(coeffDst, coeffSrc) );
 }
 
+
+
+// both work on the buffers as flat arrays of samples and sum up into
+// independent partial sums, so that the compiler can vectorize the loops
+float energy( const sampleFrame* src, int frames )
+{
+	const sample_t* s = src[0];
+	const int samples = frames * DEFAULT_CHANNELS;
+
+	float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	int i = 0;
+	for( ; i + 4 <= samples; i += 4 )
+	{
+		for( int j = 0; j < 4; ++j )
+		{
+			sum[j] += s[i+j] * s[i+j];
+		}
+	}
+	for( ; i < samples; ++i )
+	{
+		sum[0] += s[i] * s[i];
+	}
+	return sum[0] + sum[1] + sum[2] + sum[3];
+}
+
+
+
+float multiplyAndAddMultipliedEnergy( sampleFrame* dst, const sampleFrame* src, float coeffDst, float coeffSrc, int frames )
+{
+	sample_t* d = dst[0];
+	const sample_t* s = src[0];
+	const int samples = frames * DEFAULT_CHANNELS;
+
+	float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	int i = 0;
+	for( ; i + 4 <= samples; i += 4 )
+	{
+		for( int j = 0; j < 4; ++j )
+		{
+			d[i+j] = coeffDst * d[i+j] + coeffSrc * s[i+j];
+			sum[j] += d[i+j] * d[i+j];
+		}
+	}
+	for( ; i < samples; ++i )
+	{
+		d[i] = coeffDst * d[i] + coeffSrc * s[i];
+		sum[0] += d[i] * d[i];
+	}
+	return sum[0] + sum[1] + sum[2] + sum[3];
+}
+
 }
 
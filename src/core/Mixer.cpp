@@ -80,6 +80,7 @@ Mixer::Mixer( bool renderOnly ) :
 	m_numWorkers( QThread::idealThreadCount()-1 ),
 	m_newPlayHandles( PlayHandle::MaxNumber ),
 	m_qualitySettings( qualitySettings::Mode_Draft ),
+	m_oldQualitySettings( qualitySettings::Mode_Draft ),
 	m_masterGain( 1.0f ),
 	m_isProcessing( false ),
 	m_audioDev( NULL ),
@@ -130,13 +131,24 @@ Mixer::Mixer( bool renderOnly ) :
 		}
 	}
 
+	// the FIFO hands buffers of our pool over to the audio device
+	// without copying them, so a buffer must not be mixed into again as
+	// long as it is queued or being read by the device - which takes one
+	// buffer per FIFO entry, one being copied by the device, the one
+	// last returned by renderNextBuffer() and the one being mixed into.
+	// A deeper pool lets the FIFO writer run further ahead.
+	m_poolDepth = qMax( fifoSize + MinimumPoolDepth,
+				ConfigManager::inst()->value( "mixer",
+						"bufferpooldepth" ).toInt() );
+	fifoSize = m_poolDepth - MinimumPoolDepth;
+
 	// allocte the FIFO from the determined size
 	m_fifo = new fifo( fifoSize );
 
 	// now that framesPerPeriod is fixed initialize global BufferManager
 	BufferManager::init( m_framesPerPeriod );
 
-	for( int i = 0; i < 3; i++ )
+	for( int i = 0; i < m_poolDepth; i++ )
 	{
 		m_readBuf = (surroundSampleFrame*)
 			MemoryHelper::alignedMalloc( m_framesPerPeriod *
@@ -156,7 +168,6 @@ Mixer::Mixer( bool renderOnly ) :
 		m_workers.push_back( wt );
 	}
 
-	m_poolDepth = 2;
 	m_readBuffer = 0;
 	m_writeBuffer = 1;
 }
@@ -180,16 +191,12 @@ Mixer::~Mixer()
 		m_workers[w]->wait( 500 );
 	}
 
-	while( m_fifo->available() )
-	{
-		delete[] m_fifo->read();
-	}
 	delete m_fifo;
 
 	delete m_midiClient;
 	delete m_audioDev;
 
-	for( int i = 0; i < 3; i++ )
+	for( int i = 0; i < m_poolDepth; i++ )
 	{
 		MemoryHelper::alignedFree( m_bufferPool[i] );
 	}
@@ -493,6 +500,21 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 
 
 
+int Mixer::bufferPoolIndex( const surroundSampleFrame * _buf ) const
+{
+	for( int i = 0; i < m_poolDepth; ++i )
+	{
+		if( m_bufferPool[i] == _buf )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+
+
 void Mixer::clear()
 {
 	m_clearSignal = true;
@@ -562,6 +584,21 @@ Mixer::StereoSample Mixer::getPeakValues(sampleFrame * _ab, const f_cnt_t _frame
 
 void Mixer::changeQuality( const struct qualitySettings & _qs )
 {
+	if( _qs.sampleRateMultiplier() ==
+				m_qualitySettings.sampleRateMultiplier() )
+	{
+		// processing rate stays the same, so there's no need to stop
+		// processing and make everyone re-prepare their data - just
+		// replace the device's resampler
+		m_audioDev->lock();
+		m_qualitySettings = _qs;
+		m_audioDev->applyQualitySettings();
+		m_audioDev->unlock();
+
+		emit qualitySettingsChanged();
+		return;
+	}
+
 	// don't delete the audio-device
 	stopProcessing();
 
@@ -603,11 +640,16 @@ void Mixer::doSetAudioDevice( AudioDevice * _dev )
 void Mixer::setAudioDevice( AudioDevice * _dev,
 			    bool startNow )
 {
+	const sample_rate_t oldRate = processingSampleRate();
+
 	stopProcessing();
 
 	doSetAudioDevice( _dev );
 
-	emit sampleRateChanged();
+	if( processingSampleRate() != oldRate )
+	{
+		emit sampleRateChanged();
+	}
 
 	if (startNow) {startProcessing();}
 }
@@ -620,6 +662,8 @@ void Mixer::setAudioDevice(AudioDevice * _dev,
 				bool _needs_fifo,
 				bool startNow)
 {
+	const sample_rate_t oldRate = processingSampleRate();
+
 	stopProcessing();
 
 	m_qualitySettings = _qs;
@@ -627,7 +671,10 @@ void Mixer::setAudioDevice(AudioDevice * _dev,
 	doSetAudioDevice( _dev );
 
 	emit qualitySettingsChanged();
-	emit sampleRateChanged();
+	if( processingSampleRate() != oldRate )
+	{
+		emit sampleRateChanged();
+	}
 
 	if (startNow) {startProcessing( _needs_fifo );}
 }
@@ -640,6 +687,7 @@ void Mixer::storeAudioDevice()
 	if( !m_oldAudioDev )
 	{
 		m_oldAudioDev = m_audioDev;
+		m_oldQualitySettings = m_qualitySettings;
 	}
 }
 
@@ -650,11 +698,22 @@ void Mixer::restoreAudioDevice()
 {
 	if( m_oldAudioDev && m_audioDev != m_oldAudioDev )
 	{
+		const sample_rate_t oldRate = processingSampleRate();
+
 		stopProcessing();
 		delete m_audioDev;
 
+		// restore device and quality in one go, so listeners only
+		// have to adapt to the original rate once
 		m_audioDev = m_oldAudioDev;
-		emit sampleRateChanged();
+		m_qualitySettings = m_oldQualitySettings;
+		m_audioDev->applyQualitySettings();
+
+		emit qualitySettingsChanged();
+		if( processingSampleRate() != oldRate )
+		{
+			emit sampleRateChanged();
+		}
 
 		startProcessing();
 	}
@@ -1257,13 +1316,11 @@ void Mixer::fifoWriter::run()
 #endif
 #endif
 
-	const fpp_t frames = m_mixer->framesPerPeriod();
 	while( m_writing )
 	{
-		surroundSampleFrame * buffer = new surroundSampleFrame[frames];
-		const surroundSampleFrame * b = m_mixer->renderNextBuffer();
-		memcpy( buffer, b, frames * sizeof( surroundSampleFrame ) );
-		write( buffer );
+		// the buffer stays valid until the audio device is done with
+		// it, see m_poolDepth
+		write( m_mixer->renderNextBuffer() );
 	}
 
 	// Let audio backend stop processing
@@ -1274,7 +1331,7 @@ void Mixer::fifoWriter::run()
 
 
 
-void Mixer::fifoWriter::write( surroundSampleFrame * buffer )
+void Mixer::fifoWriter::write( const surroundSampleFrame * buffer )
 {
 	m_mixer->m_waitChangesMutex.lock();
 	m_mixer->m_waitingForWrite = true;
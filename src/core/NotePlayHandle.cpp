@@ -24,6 +24,7 @@
  */
 
 #include "NotePlayHandle.h"
+#include "BBRenderCache.h"
 #include "BasicFilters.h"
 #include "DetuningHelper.h"
 #include "InstrumentSoundShaping.h"
@@ -68,6 +69,7 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	m_hadChildren( false ),
 	m_muted( false ),
 	m_bbTrack( NULL ),
+	m_bbRender( NULL ),
 	m_origTempo( Engine::getSong()->getTempo() ),
 	m_origBaseNote( instrumentTrack->baseNote() ),
 	m_frequency( 0 ),
@@ -92,6 +94,7 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 		parent->m_hadChildren = true;
 
 		m_bbTrack = parent->m_bbTrack;
+		setBBRender( parent->m_bbRender );
 
 		parent->setUsesBuffer( false );
 	}
@@ -120,6 +123,10 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 NotePlayHandle::~NotePlayHandle()
 {
 	lock();
+	if( m_bbRender != NULL )
+	{
+		m_bbRender->detach( isFinished() );
+	}
 	noteOff( 0 );
 
 	if( hasParent() == false )
@@ -242,6 +249,20 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 	{
 		// play note!
 		m_instrumentTrack->playNote( this, _working_buffer );
+
+		if( m_bbRender != NULL )
+		{
+			if( m_instrumentTrack->isMuted() || isBbTrackMuted() )
+			{
+				// the render wouldn't sound like the usual output
+				m_bbRender->abort();
+			}
+			else if( _working_buffer != NULL )
+			{
+				m_bbRender->add( _working_buffer,
+					Engine::mixer()->framesPerPeriod() );
+			}
+		}
 	}
 
 	if( m_released && (!instrumentTrack()->isSustainPedalPressed() ||
@@ -347,6 +368,18 @@ bool NotePlayHandle::isFromTrack( const Track * _track ) const
 
 
 
+void NotePlayHandle::setBBRender( BBRender * render )
+{
+	m_bbRender = render;
+	if( m_bbRender != NULL )
+	{
+		m_bbRender->attach();
+	}
+}
+
+
+
+
 void NotePlayHandle::noteOff( const f_cnt_t _s )
 {
 	if( m_released )
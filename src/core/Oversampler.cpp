@@ -0,0 +1,448 @@
+/*
+ * Oversampler.cpp - runs parts of effects at a multiple of the sample rate
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Oversampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Engine.h"
+#include "lmms_constants.h"
+#include "Mixer.h"
+
+
+// number of non-zero taps besides the center one of the halfband filters,
+// which is also the length of their polyphase branch
+static const int FirstStageTaps = 32;
+static const int StageTaps = 8;
+
+// shape of the Kaiser window, giving about 60 dB of stopband attenuation
+static const double KaiserBeta = 6.0;
+
+
+// modified Bessel function of the first kind and order 0
+static double besselI0( double _x )
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for( int k = 1; term > 1e-12 * sum; ++k )
+	{
+		const double t = _x / ( 2.0 * k );
+		term *= t * t;
+		sum += term;
+	}
+	return sum;
+}
+
+
+
+
+// Halfband lowpass as windowed sinc: apart from the center tap of 0.5 only
+// the taps at odd offsets from the center are non-zero. Returns those, which
+// are symmetric.
+static std::vector<float> halfbandCoefficients( int _taps )
+{
+	const int center = _taps - 1;
+	std::vector<float> coeffs( _taps );
+	double sum = 0.0;
+	for( int i = 0; i < _taps; ++i )
+	{
+		const int n = 2 * i - center;
+		const double x = static_cast<double>( n ) / center;
+		const double window = besselI0( KaiserBeta *
+					sqrt( qMax( 0.0, 1.0 - x * x ) ) ) /
+						besselI0( KaiserBeta );
+		const double c = sin( D_PI * n / 2.0 ) / ( D_PI * n ) * window;
+		coeffs[i] = c;
+		sum += c;
+	}
+
+	// have the taps sum up to 1 with the center one for unity gain at DC
+	for( float & c : coeffs )
+	{
+		c *= 0.5 / sum;
+	}
+	return coeffs;
+}
+
+
+
+
+// Doubles or halves the rate of planar stereo audio. With the taps of the
+// polyphase branch in m_coeffs the filter is a plain dot product over
+// contiguous samples for each output sample, which the compiler vectorizes.
+// The histories of the inputs are kept in front of them in the same arrays.
+class Oversampler::Stage
+{
+public:
+	Stage( int _taps ) :
+		m_coeffs( halfbandCoefficients( _taps ) )
+	{
+	}
+
+	int taps() const
+	{
+		return m_coeffs.size();
+	}
+
+	// delay of up- plus downsampling in samples of the lower rate
+	int latency() const
+	{
+		return taps() - 1;
+	}
+
+	// _frames is the number of frames at the lower rate
+	void reserve( f_cnt_t _frames )
+	{
+		const int history = taps() - 1;
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			m_up[ch].resize( history + _frames );
+			m_even[ch].resize( history + _frames );
+			m_odd[ch].resize( taps() / 2 + _frames );
+		}
+	}
+
+	void reset()
+	{
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			std::fill( m_up[ch].begin(), m_up[ch].end(), 0.0f );
+			std::fill( m_odd[ch].begin(), m_odd[ch].end(), 0.0f );
+			std::fill( m_even[ch].begin(), m_even[ch].end(), 0.0f );
+		}
+	}
+
+	void upsample( const sample_t * const * _src, sample_t * const * _dst,
+							const f_cnt_t _frames )
+	{
+		const int taps = this->taps();
+		const int history = taps - 1;
+		const float * c = m_coeffs.data();
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			sample_t * x = m_up[ch].data();
+			sample_t * y = _dst[ch];
+			memcpy( x + history, _src[ch], _frames * sizeof( sample_t ) );
+			for( f_cnt_t f = 0; f < _frames; ++f )
+			{
+				float sum = 0.0f;
+				for( int i = 0; i < taps; ++i )
+				{
+					sum += c[i] * x[f + i];
+				}
+				// the filter has a gain of 2 here, making up for the
+				// zeros stuffed in between the input samples
+				y[2 * f] = 2.0f * sum;
+				// center tap
+				y[2 * f + 1] = x[f + taps / 2];
+			}
+			memmove( x, x + _frames, history * sizeof( sample_t ) );
+		}
+	}
+
+	void downsample( const sample_t * const * _src, sample_t * const * _dst,
+							const f_cnt_t _frames )
+	{
+		const int taps = this->taps();
+		const int history = taps - 1;
+		const float * c = m_coeffs.data();
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			sample_t * odd = m_odd[ch].data();
+			sample_t * even = m_even[ch].data();
+			const sample_t * x = _src[ch];
+			sample_t * y = _dst[ch];
+			for( f_cnt_t f = 0; f < _frames; ++f )
+			{
+				even[history + f] = x[2 * f];
+				odd[taps / 2 + f] = x[2 * f + 1];
+			}
+			for( f_cnt_t f = 0; f < _frames; ++f )
+			{
+				float sum = 0.0f;
+				for( int i = 0; i < taps; ++i )
+				{
+					sum += c[i] * even[f + i];
+				}
+				// center tap
+				y[f] = sum + 0.5f * odd[f];
+			}
+			memmove( even, even + _frames, history * sizeof( sample_t ) );
+			memmove( odd, odd + _frames,
+					taps / 2 * sizeof( sample_t ) );
+		}
+	}
+
+
+private:
+	std::vector<float> m_coeffs;
+
+	std::vector<sample_t> m_up[DEFAULT_CHANNELS];
+	std::vector<sample_t> m_odd[DEFAULT_CHANNELS];
+	std::vector<sample_t> m_even[DEFAULT_CHANNELS];
+
+} ;
+
+
+
+
+Oversampler::Oversampler( int _factor, fpp_t _frames ) :
+	m_factor( 1 ),
+	m_capacity( _frames ),
+	m_buffer( NULL ),
+	m_padding( 0 ),
+	m_latency( 0 )
+{
+	if( !setFactor( _factor ) )
+	{
+		allocate();
+	}
+}
+
+
+
+
+Oversampler::~Oversampler()
+{
+	for( Stage * stage : m_stages )
+	{
+		delete stage;
+	}
+	MM_FREE( m_buffer );
+}
+
+
+
+
+int Oversampler::localFactor( int _factor )
+{
+	const int engineFactor = Engine::mixer()->
+			currentQualitySettings().sampleRateMultiplier();
+	return qBound( 1, _factor / engineFactor, MaximumFactor );
+}
+
+
+
+
+bool Oversampler::setFactor( int _factor )
+{
+	if( _factor == m_factor )
+	{
+		return false;
+	}
+
+	for( Stage * stage : m_stages )
+	{
+		delete stage;
+	}
+	m_stages.clear();
+
+	m_factor = 1;
+	while( m_factor < qMin( _factor, MaximumFactor ) )
+	{
+		m_stages.push_back( new Stage( m_stages.empty() ?
+						FirstStageTaps : StageTaps ) );
+		m_factor *= 2;
+	}
+
+	// the delay of each stage is a whole number of samples at its lower
+	// rate, so sum them up at the highest rate and round up to whole frames
+	// of the original rate there
+	f_cnt_t highest = 0;
+	int rate = m_factor;
+	for( Stage * stage : m_stages )
+	{
+		highest += stage->latency() * rate;
+		rate /= 2;
+	}
+	m_padding = ( m_factor - highest % m_factor ) % m_factor;
+	m_latency = ( highest + m_padding ) / m_factor;
+
+	allocate();
+	reset();
+	return true;
+}
+
+
+
+
+void Oversampler::reserve( fpp_t _frames )
+{
+	if( _frames > m_capacity )
+	{
+		m_capacity = _frames;
+		allocate();
+	}
+}
+
+
+
+
+void Oversampler::reset()
+{
+	for( Stage * stage : m_stages )
+	{
+		stage->reset();
+	}
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		std::fill( m_paddingHistory[ch].begin(),
+					m_paddingHistory[ch].end(), 0.0f );
+	}
+}
+
+
+
+
+sampleFrame * Oversampler::upsample( const sampleFrame * _src, fpp_t _frames )
+{
+	if( m_stages.empty() )
+	{
+		memcpy( m_buffer, _src, _frames * sizeof( sampleFrame ) );
+		return m_buffer;
+	}
+
+	int in = 0;
+	deinterleave( _src, m_channels[in], _frames );
+	f_cnt_t frames = _frames;
+	for( Stage * stage : m_stages )
+	{
+		stage->upsample( m_channels[in], m_channels[1 - in], frames );
+		in = 1 - in;
+		frames *= 2;
+	}
+	delay( m_channels[in], frames );
+	interleave( m_channels[in], m_buffer, frames );
+
+	return m_buffer;
+}
+
+
+
+
+void Oversampler::downsample( sampleFrame * _dst, fpp_t _frames )
+{
+	if( m_stages.empty() )
+	{
+		memcpy( _dst, m_buffer, _frames * sizeof( sampleFrame ) );
+		return;
+	}
+
+	int in = 0;
+	f_cnt_t frames = _frames * m_factor;
+	deinterleave( m_buffer, m_channels[in], frames );
+	for( auto it = m_stages.rbegin(); it != m_stages.rend(); ++it )
+	{
+		frames /= 2;
+		( *it )->downsample( m_channels[in], m_channels[1 - in], frames );
+		in = 1 - in;
+	}
+	interleave( m_channels[in], _dst, _frames );
+}
+
+
+
+
+void Oversampler::allocate()
+{
+	const f_cnt_t frames = m_capacity * m_factor;
+
+	MM_FREE( m_buffer );
+	m_buffer = MM_ALLOC( sampleFrame, qMax<f_cnt_t>( frames, 1 ) );
+
+	if( m_stages.empty() )
+	{
+		return;
+	}
+
+	for( int i = 0; i < 2; ++i )
+	{
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			m_planar[i][ch].resize( frames );
+			m_channels[i][ch] = m_planar[i][ch].data();
+		}
+	}
+	f_cnt_t stageFrames = m_capacity;
+	for( Stage * stage : m_stages )
+	{
+		stage->reserve( stageFrames );
+		stageFrames *= 2;
+	}
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		m_paddingHistory[ch].resize( m_padding + frames );
+	}
+}
+
+
+
+
+void Oversampler::delay( sample_t * const * _buf, f_cnt_t _frames )
+{
+	if( m_padding == 0 )
+	{
+		return;
+	}
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		sample_t * history = m_paddingHistory[ch].data();
+		memcpy( history + m_padding, _buf[ch],
+						_frames * sizeof( sample_t ) );
+		memcpy( _buf[ch], history, _frames * sizeof( sample_t ) );
+		memmove( history, history + _frames,
+					m_padding * sizeof( sample_t ) );
+	}
+}
+
+
+
+
+void Oversampler::deinterleave( const sampleFrame * _src,
+				sample_t * const * _dst, f_cnt_t _frames )
+{
+	sample_t * left = _dst[0];
+	sample_t * right = _dst[1];
+	for( f_cnt_t f = 0; f < _frames; ++f )
+	{
+		left[f] = _src[f][0];
+		right[f] = _src[f][1];
+	}
+}
+
+
+
+
+void Oversampler::interleave( const sample_t * const * _src,
+				sampleFrame * _dst, f_cnt_t _frames )
+{
+	const sample_t * left = _src[0];
+	const sample_t * right = _src[1];
+	for( f_cnt_t f = 0; f < _frames; ++f )
+	{
+		_dst[f][0] = left[f];
+		_dst[f][1] = right[f];
+	}
+}
@@ -0,0 +1,101 @@
+/*
+ * PlanarBuffer.cpp - a stereo buffer with one block of samples per channel
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "PlanarBuffer.h"
+
+#include <algorithm>
+
+
+PlanarBuffer::PlanarBuffer( fpp_t _frames ) :
+	m_data( NULL ),
+	m_capacity( 0 )
+{
+	std::fill( m_channels, m_channels + DEFAULT_CHANNELS,
+						static_cast<sample_t *>( NULL ) );
+	reserve( _frames );
+}
+
+
+
+
+PlanarBuffer::~PlanarBuffer()
+{
+	MM_FREE( m_data );
+}
+
+
+
+
+void PlanarBuffer::reserve( fpp_t _frames )
+{
+	if( _frames <= m_capacity )
+	{
+		return;
+	}
+
+	MM_FREE( m_data );
+	m_data = MM_ALLOC( sample_t, _frames * DEFAULT_CHANNELS );
+	m_capacity = _frames;
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		m_channels[ch] = m_data + ch * m_capacity;
+	}
+}
+
+
+
+
+void PlanarBuffer::fromInterleaved( const sampleFrame * _src, fpp_t _frames )
+{
+	sample_t * left = m_channels[0];
+	sample_t * right = m_channels[1];
+	for( fpp_t f = 0; f < _frames; ++f )
+	{
+		left[f] = _src[f][0];
+		right[f] = _src[f][1];
+	}
+}
+
+
+
+
+void PlanarBuffer::toInterleaved( sampleFrame * _dst, fpp_t _frames ) const
+{
+	const sample_t * left = m_channels[0];
+	const sample_t * right = m_channels[1];
+	for( fpp_t f = 0; f < _frames; ++f )
+	{
+		_dst[f][0] = left[f];
+		_dst[f][1] = right[f];
+	}
+}
+
+
+
+
+void PlanarBuffer::clear( fpp_t _frames )
+{
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		std::fill( m_channels[ch], m_channels[ch] + _frames, 0.0f );
+	}
+}
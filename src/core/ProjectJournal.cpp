@@ -34,6 +34,8 @@
 static const int EO_ID_MSB = 1 << 23;
 
 const int ProjectJournal::MAX_UNDO_STATES = 100; // TODO: make this configurable in settings
+const int ProjectJournal::MAX_UNDO_BYTES = 64 * 1024 * 1024;
+const int ProjectJournal::COALESCE_INTERVAL = 500;
 
 ProjectJournal::ProjectJournal() :
 	m_joIDs(),
@@ -62,14 +64,8 @@ void ProjectJournal::undo()
 
 		if( jo )
 		{
-			DataFile curState( DataFile::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_redoCheckPoints.push( CheckPoint( c.joID, curState ) );
-
-			bool prev = isJournalling();
-			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
-			setJournalling( prev );
+			m_redoCheckPoints.push( createCheckPoint( jo ) );
+			restoreCheckPoint( jo, c );
 			Engine::getSong()->setModified();
 			break;
 		}
@@ -87,14 +83,8 @@ void ProjectJournal::redo()
 
 		if( jo )
 		{
-			DataFile curState( DataFile::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_undoCheckPoints.push( CheckPoint( c.joID, curState ) );
-
-			bool prev = isJournalling();
-			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
-			setJournalling( prev );
+			m_undoCheckPoints.push( createCheckPoint( jo ) );
+			restoreCheckPoint( jo, c );
 			Engine::getSong()->setModified();
 			break;
 		}
@@ -119,15 +109,86 @@ void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
 	{
 		m_redoCheckPoints.clear();
 
-		DataFile dataFile( DataFile::JournalData );
-		jo->saveState( dataFile, dataFile.content() );
+		CheckPoint c = createCheckPoint( jo );
 
-		m_undoCheckPoints.push( CheckPoint( jo->id(), dataFile ) );
-		if( m_undoCheckPoints.size() > MAX_UNDO_STATES )
+		// merge repeated changes of the same value, the checkpoint on top
+		// already holds the state before the first of them
+		if( c.isValue && !m_undoCheckPoints.isEmpty() &&
+			m_undoCheckPoints.top().isValue &&
+			m_undoCheckPoints.top().joID == c.joID &&
+			m_lastCheckPointTime.isValid() &&
+			m_lastCheckPointTime.elapsed() < COALESCE_INTERVAL )
 		{
-			m_undoCheckPoints.remove( 0, m_undoCheckPoints.size() - MAX_UNDO_STATES );
+			m_lastCheckPointTime.restart();
+			return;
 		}
+		m_lastCheckPointTime.restart();
+
+		m_undoCheckPoints.push( c );
+		trimUndoCheckPoints();
+	}
+}
+
+
+
+
+ProjectJournal::CheckPoint ProjectJournal::createCheckPoint( JournallingObject * jo )
+{
+	CheckPoint c( jo->id() );
+	c.isValue = jo->journalValue( c.value );
+	if( !c.isValue )
+	{
+		// keep the serialized text only, a DOM tree takes several times
+		// the memory
+		DataFile dataFile( DataFile::JournalData );
+		jo->saveState( dataFile, dataFile.content() );
+		c.data = dataFile.toByteArray( -1 );
+	}
+	return c;
+}
+
+
+
+
+void ProjectJournal::restoreCheckPoint( JournallingObject * jo, const CheckPoint & c )
+{
+	bool prev = isJournalling();
+	setJournalling( false );
+	if( c.isValue )
+	{
+		jo->restoreJournalValue( c.value );
+	}
+	else
+	{
+		DataFile dataFile( c.data );
+		jo->restoreState( dataFile.content().firstChildElement() );
+	}
+	setJournalling( prev );
+
+	// don't merge the next change into a checkpoint restored just now
+	m_lastCheckPointTime.invalidate();
+}
+
+
+
+
+void ProjectJournal::trimUndoCheckPoints()
+{
+	qint64 bytes = 0;
+	for( const CheckPoint & c : m_undoCheckPoints )
+	{
+		bytes += c.data.size();
+	}
+
+	int count = 0;
+	while( m_undoCheckPoints.size() - count > 1 &&
+		( m_undoCheckPoints.size() - count > MAX_UNDO_STATES ||
+						bytes > MAX_UNDO_BYTES ) )
+	{
+		bytes -= m_undoCheckPoints[count].data.size();
+		++count;
 	}
+	m_undoCheckPoints.remove( 0, count );
 }
 
 
@@ -26,6 +26,9 @@
 #include <QFile>
 
 #include "ProjectRenderer.h"
+#include "AudioPort.h"
+#include "BufferManager.h"
+#include "FxMixer.h"
 #include "Song.h"
 #include "PerfLog.h"
 
@@ -83,32 +86,135 @@ ProjectRenderer::ProjectRenderer( const Mixer::qualitySettings & qualitySettings
 					const QString & outputFilename ) :
 	QThread( Engine::mixer() ),
 	m_fileDev( NULL ),
+	m_renderMix( false ),
 	m_qualitySettings( qualitySettings ),
+	m_outputSettings( outputSettings ),
+	m_fileFormat( exportFileFormat ),
 	m_progress( 0 ),
+	m_periodsRendered( 0 ),
 	m_abort( false )
 {
-	AudioFileDeviceInstantiaton audioEncoderFactory = fileEncodeDevices[exportFileFormat].m_getDevInst;
+	if( !outputFilename.isEmpty() )
+	{
+		m_fileDev = createFileDevice( outputFilename );
+		m_renderMix = m_fileDev != NULL;
+	}
+}
+
+
+
+
+ProjectRenderer::~ProjectRenderer()
+{
+	for( const Stem & stem : m_stems )
+	{
+		if( stem.port )
+		{
+			stem.port->setStemBuffer( NULL );
+		}
+		else
+		{
+			stem.channel->m_stemBuffer = NULL;
+		}
+		// the device driving the mixer gets deleted by the mixer
+		if( stem.device != m_fileDev )
+		{
+			delete stem.device;
+		}
+		MM_FREE( stem.buffer );
+	}
+}
+
+
+
+
+AudioFileDevice * ProjectRenderer::createFileDevice( const QString & outputFilename )
+{
+	AudioFileDeviceInstantiaton audioEncoderFactory = fileEncodeDevices[m_fileFormat].m_getDevInst;
 
 	if (audioEncoderFactory)
 	{
 		bool successful = false;
 
-		m_fileDev = audioEncoderFactory(
-					outputFilename, outputSettings, DEFAULT_CHANNELS,
+		AudioFileDevice * fileDev = audioEncoderFactory(
+					outputFilename, m_outputSettings, DEFAULT_CHANNELS,
 					Engine::mixer(), successful );
-		if( !successful )
+		if( successful )
 		{
-			delete m_fileDev;
-			m_fileDev = NULL;
+			return fileDev;
 		}
+		delete fileDev;
 	}
+
+	return NULL;
 }
 
 
 
 
-ProjectRenderer::~ProjectRenderer()
+bool ProjectRenderer::addStem( AudioPort * port, const QString & outputFilename,
+						AudioPort::StemTaps tap )
 {
+	Stem stem = { createFileDevice( outputFilename ), NULL, port, NULL };
+	if( !appendStem( stem ) )
+	{
+		return false;
+	}
+
+	port->setStemBuffer( stem.buffer, tap );
+	return true;
+}
+
+
+
+
+bool ProjectRenderer::addStem( FxChannel * channel, const QString & outputFilename )
+{
+	Stem stem = { createFileDevice( outputFilename ), NULL, NULL, channel };
+	if( !appendStem( stem ) )
+	{
+		return false;
+	}
+
+	channel->m_stemBuffer = stem.buffer;
+	return true;
+}
+
+
+
+
+bool ProjectRenderer::appendStem( Stem & stem )
+{
+	if( stem.device == NULL )
+	{
+		return false;
+	}
+
+	const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+	stem.buffer = MM_ALLOC( sampleFrame, fpp );
+	BufferManager::clear( stem.buffer, fpp );
+	m_stems.push_back( stem );
+
+	// without a file for the mix, the first stem's device drives the mixer
+	if( m_fileDev == NULL )
+	{
+		m_fileDev = stem.device;
+	}
+
+	return true;
+}
+
+
+
+
+void ProjectRenderer::writeStems()
+{
+	const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+	for( const Stem & stem : m_stems )
+	{
+		stem.device->processBuffer( stem.buffer, fpp );
+		BufferManager::clear( stem.buffer, fpp );
+	}
 }
 
 
@@ -182,10 +288,24 @@ void ProjectRenderer::run()
 
 	Engine::getSong()->startExport();
 	Engine::getSong()->updateLength();
-	// Skip first empty buffer.
+	// Skip first empty buffer. The stems are taken while mixing, so
+	// they already hold the first period of the song.
 	Engine::mixer()->nextBuffer();
+	writeStems();
 
 	m_progress = 0;
+	m_periodsRendered = 0;
+	m_renderTimer.start();
+
+	// encode on separate threads while the mixer renders the next periods
+	if( m_renderMix )
+	{
+		m_fileDev->startEncoderThread();
+	}
+	for( const Stem & stem : m_stems )
+	{
+		stem.device->startEncoderThread();
+	}
 
 	// Now start processing
 	Engine::mixer()->startProcessing(false);
@@ -193,7 +313,16 @@ void ProjectRenderer::run()
 	// Continually track and emit progress percentage to listeners.
 	while (!Engine::getSong()->isExportDone() && !m_abort)
 	{
-		m_fileDev->processNextBuffer();
+		if( m_renderMix )
+		{
+			m_fileDev->processNextBuffer();
+		}
+		else
+		{
+			Engine::mixer()->nextBuffer();
+		}
+		writeStems();
+		++m_periodsRendered;
 		const int nprog = Engine::getSong()->getExportProgress();
 		if (m_progress != nprog)
 		{
@@ -205,15 +334,30 @@ void ProjectRenderer::run()
 	// Notify mixer of the end of processing.
 	Engine::mixer()->stopProcessing();
 
+	if( m_renderMix )
+	{
+		m_fileDev->stopEncoderThread();
+	}
+	for( const Stem & stem : m_stems )
+	{
+		stem.device->stopEncoderThread();
+	}
+
 	Engine::getSong()->stopExport();
 
 	perfLog.end();
 
-	// If the user aborted export-process, the file has to be deleted.
-	const QString f = m_fileDev->outputFile();
+	// If the user aborted export-process, the files have to be deleted.
 	if( m_abort )
 	{
-		QFile( f ).remove();
+		if( m_renderMix )
+		{
+			QFile( m_fileDev->outputFile() ).remove();
+		}
+		for( const Stem & stem : m_stems )
+		{
+			QFile( stem.device->outputFile() ).remove();
+		}
 	}
 }
 
@@ -228,11 +372,29 @@ void ProjectRenderer::abortProcessing()
 
 
 
+double ProjectRenderer::realtimeFactor() const
+{
+	const qint64 elapsed = m_renderTimer.isValid() ?
+					m_renderTimer.elapsed() : 0;
+	if( elapsed <= 0 )
+	{
+		return 0;
+	}
+
+	const double renderedSeconds = (double) m_periodsRendered *
+			Engine::mixer()->framesPerPeriod() /
+				Engine::mixer()->processingSampleRate();
+	return renderedSeconds * 1000 / elapsed;
+}
+
+
+
+
 void ProjectRenderer::updateConsoleProgress()
 {
 	const int cols = 50;
 	static int rot = 0;
-	char buf[80];
+	char buf[100];
 	char prog[cols+1];
 
 	for( int i = 0; i < cols; ++i )
@@ -243,8 +405,8 @@ void ProjectRenderer::updateConsoleProgress()
 
 	const char * activity = (const char *) "|/-\\";
 	memset( buf, 0, sizeof( buf ) );
-	sprintf( buf, "\r|%s|    %3d%%   %c  ", prog, m_progress,
-							activity[rot] );
+	sprintf( buf, "\r|%s|    %3d%%   %c  %6.1fx realtime  ", prog,
+				m_progress, activity[rot], realtimeFactor() );
 	rot = ( rot+1 ) % 4;
 
 	fprintf( stderr, "%s", buf );
@@ -29,14 +29,17 @@
 #endif
 
 #include "BufferManager.h"
+#include "ConfigManager.h"
 #include "RemotePlugin.h"
 #include "Mixer.h"
 #include "Engine.h"
 
 #include <QDebug>
 #include <QDir>
+#include <QHash>
+#include <QPair>
 
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 #include <QtCore/QUuid>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -67,7 +70,7 @@ void ProcessWatcher::run()
 		fprintf( stderr,
 				"remote plugin died! invalidating now.\n" );
 
-		m_plugin->invalidate();
+		m_plugin->processDied();
 	}
 }
 
@@ -86,6 +89,10 @@ RemotePlugin::RemotePlugin() :
 	m_watcher( this ),
 	m_commMutex( QMutex::Recursive ),
 	m_splitChannels( false ),
+	m_pipelined( ConfigManager::inst()->value( "mixer",
+					"pipelineremoteplugins" ).toInt() ),
+	m_periodPending( false ),
+	m_processing( false ),
 #ifdef USE_QT_SHMEM
 	m_shmObj(),
 #else
@@ -96,7 +103,7 @@ RemotePlugin::RemotePlugin() :
 	m_inputCount( DEFAULT_CHANNELS ),
 	m_outputCount( DEFAULT_CHANNELS )
 {
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 	struct sockaddr_un sa;
 	sa.sun_family = AF_LOCAL;
 
@@ -150,11 +157,15 @@ RemotePlugin::~RemotePlugin()
 			lock();
 			sendMessage( IdQuit );
 
-			m_process.waitForFinished( 1000 );
-			if( m_process.state() != QProcess::NotRunning )
+			// a shared process keeps running for the other instances
+			if( !m_group )
 			{
-				m_process.terminate();
-				m_process.kill();
+				m_process.waitForFinished( 1000 );
+				if( m_process.state() != QProcess::NotRunning )
+				{
+					m_process.terminate();
+					m_process.kill();
+				}
 			}
 			unlock();
 		}
@@ -165,13 +176,34 @@ RemotePlugin::~RemotePlugin()
 #endif
 	}
 
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 	if ( close( m_server ) == -1)
 	{
 		qWarning( "Error freeing resources." );
 	}
 	remove( m_socketFile.toUtf8().constData() );
 #endif
+
+	if( m_group )
+	{
+		m_group->removeInstance( this );
+	}
+}
+
+
+
+
+bool RemotePlugin::isRunning()
+{
+#ifdef DEBUG_REMOTE_PLUGIN
+	return true;
+#else
+	if( m_group )
+	{
+		return m_group->isRunning();
+	}
+	return m_process.state() != QProcess::NotRunning;
+#endif
 }
 
 
@@ -183,8 +215,10 @@ bool RemotePlugin::init(const QString &pluginExecutable,
 	lock();
 	if( m_failed )
 	{
-#ifdef SYNC_WITH_SHM_FIFO
+#if defined(SYNC_WITH_SHM_FIFO)
 		reset( new shmFifo(), new shmFifo() );
+#elif defined(SYNC_WITH_SHM_RING)
+		createRings();
 #endif
 		m_failed = false;
 	}
@@ -214,33 +248,61 @@ bool RemotePlugin::init(const QString &pluginExecutable,
 		return failed();
 	}
 
-	// ensure the watcher is ready in case we're running again
-	// (e.g. 32-bit VST plugins on Windows)
-	m_watcher.wait();
-	m_watcher.reset();
-
 	QStringList args;
-#ifdef SYNC_WITH_SHM_FIFO
+#if defined(SYNC_WITH_SHM_FIFO)
 	// swap in and out for bidirectional communication
 	args << QString::number( out()->shmKey() );
 	args << QString::number( in()->shmKey() );
+#elif defined(SYNC_WITH_SHM_RING)
+	args << QString::number( ringKey() );
 #else
 	args << m_socketFile;
 #endif
 	args << extraArgs;
+
+	if( !m_processGroup.isEmpty() )
+	{
+		if( m_group )
+		{
+			m_group->removeInstance( this );
+		}
+		m_group = RemotePluginGroup::get( pluginExecutable,
+							m_processGroup );
+		if( !m_group->addInstance( this, args ) )
+		{
+			qWarning( "Remote plugin '%s' couldn't be started in "
+					"process group '%s'.",
+					exec.toUtf8().constData(),
+					m_processGroup.toUtf8().constData() );
+			m_failed = true;
+			invalidate();
+			unlock();
+			return failed();
+		}
+	}
+	else
+	{
+		// ensure the watcher is ready in case we're running again
+		// (e.g. 32-bit VST plugins on Windows)
+		m_watcher.wait();
+		m_watcher.reset();
+
 #ifndef DEBUG_REMOTE_PLUGIN
-	m_process.setProcessChannelMode( QProcess::ForwardedChannels );
-	m_process.setWorkingDirectory( QCoreApplication::applicationDirPath() );
-	m_exec = exec;
-	m_args = args;
-	// we start the process on the watcher thread to work around QTBUG-8819
-	m_process.moveToThread( &m_watcher );
-	m_watcher.start( QThread::LowestPriority );
+		m_process.setProcessChannelMode( QProcess::ForwardedChannels );
+		m_process.setWorkingDirectory(
+				QCoreApplication::applicationDirPath() );
+		m_exec = exec;
+		m_args = args;
+		// we start the process on the watcher thread to work around
+		// QTBUG-8819
+		m_process.moveToThread( &m_watcher );
+		m_watcher.start( QThread::LowestPriority );
 #else
-	qDebug() << exec << args;
+		qDebug() << exec << args;
 #endif
+	}
 
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 	struct pollfd pollin;
 	pollin.fd = m_server;
 	pollin.events = POLLIN;
@@ -311,88 +373,191 @@ bool RemotePlugin::process( const sampleFrame * _in_buf,
 		return false;
 	}
 
-	memset( m_shm, 0, m_shmSize );
+	if( m_pipelined )
+	{
+		return processPipelined( _in_buf, _out_buf );
+	}
 
-	ch_cnt_t inputs = qMin<ch_cnt_t>( m_inputCount, DEFAULT_CHANNELS );
+	writeInput( _in_buf, frames );
 
-	if( _in_buf != NULL && inputs > 0 )
+	lock();
+	sendMessage( IdStartProcessing );
+
+	if( m_failed || _out_buf == NULL || m_outputCount == 0 )
 	{
-		if( m_splitChannels )
-		{
-			for( ch_cnt_t ch = 0; ch < inputs; ++ch )
-			{
-				for( fpp_t frame = 0; frame < frames; ++frame )
-				{
-					m_shm[ch * frames + frame] =
-							_in_buf[frame][ch];
-				}
-			}
-		}
-		else if( inputs == DEFAULT_CHANNELS )
+		unlock();
+		return false;
+	}
+
+	waitForMessage( IdProcessingDone );
+	unlock();
+
+	readOutput( _out_buf, frames );
+
+	return true;
+}
+
+
+
+
+bool RemotePlugin::processPipelined( const sampleFrame * _in_buf,
+						sampleFrame * _out_buf )
+{
+	const fpp_t frames = Engine::mixer()->framesPerPeriod();
+
+	lock();
+
+	// the plugin computed the period we started last time while the
+	// mixer was busy with everything else
+	const bool collected = finishProcessing();
+	if( _out_buf != NULL )
+	{
+		if( collected && m_outputCount > 0 )
 		{
-			memcpy( m_shm, _in_buf, frames * BYTES_PER_FRAME );
+			readOutput( _out_buf, frames );
 		}
 		else
 		{
-			sampleFrame * o = (sampleFrame *) m_shm;
-			for( ch_cnt_t ch = 0; ch < inputs; ++ch )
-			{
-				for( fpp_t frame = 0; frame < frames; ++frame )
-				{
-					o[frame][ch] = _in_buf[frame][ch];
-				}
-			}
+			BufferManager::clear( _out_buf, frames );
 		}
 	}
 
-	lock();
+	writeInput( _in_buf, frames );
 	sendMessage( IdStartProcessing );
+	m_periodPending = m_processing = !m_failed && !isInvalid();
 
-	if( m_failed || _out_buf == NULL || m_outputCount == 0 )
+	unlock();
+
+	return collected;
+}
+
+
+
+
+bool RemotePlugin::finishProcessing()
+{
+	if( !m_periodPending )
 	{
-		unlock();
 		return false;
 	}
+	m_periodPending = false;
 
-	waitForMessage( IdProcessingDone );
+	// if someone else waited for a message in the meantime, the reply
+	// may already have been processed
+	while( m_processing && !isInvalid() )
+	{
+		fetchAndProcessNextMessage();
+	}
+	m_processing = false;
+
+	return !isInvalid();
+}
+
+
+
+
+void RemotePlugin::setPipelined( bool _on )
+{
+	lock();
+	if( !_on )
+	{
+		// the plugin must not touch the shared memory anymore when we
+		// fill it the next time
+		finishProcessing();
+	}
+	m_pipelined = _on;
 	unlock();
+}
+
 
+
+
+f_cnt_t RemotePlugin::latency() const
+{
+	return m_pipelined ? Engine::mixer()->framesPerPeriod() : 0;
+}
+
+
+
+
+void RemotePlugin::writeInput( const sampleFrame * _in_buf,
+							const fpp_t _frames )
+{
+	memset( m_shm, 0, m_shmSize );
+
+	ch_cnt_t inputs = qMin<ch_cnt_t>( m_inputCount, DEFAULT_CHANNELS );
+
+	if( _in_buf == NULL || inputs == 0 )
+	{
+		return;
+	}
+
+	if( m_splitChannels )
+	{
+		for( ch_cnt_t ch = 0; ch < inputs; ++ch )
+		{
+			for( fpp_t frame = 0; frame < _frames; ++frame )
+			{
+				m_shm[ch * _frames + frame] = _in_buf[frame][ch];
+			}
+		}
+	}
+	else if( inputs == DEFAULT_CHANNELS )
+	{
+		memcpy( m_shm, _in_buf, _frames * BYTES_PER_FRAME );
+	}
+	else
+	{
+		sampleFrame * o = (sampleFrame *) m_shm;
+		for( ch_cnt_t ch = 0; ch < inputs; ++ch )
+		{
+			for( fpp_t frame = 0; frame < _frames; ++frame )
+			{
+				o[frame][ch] = _in_buf[frame][ch];
+			}
+		}
+	}
+}
+
+
+
+
+void RemotePlugin::readOutput( sampleFrame * _out_buf, const fpp_t _frames )
+{
 	const ch_cnt_t outputs = qMin<ch_cnt_t>( m_outputCount,
 							DEFAULT_CHANNELS );
 	if( m_splitChannels )
 	{
 		for( ch_cnt_t ch = 0; ch < outputs; ++ch )
 		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
+			for( fpp_t frame = 0; frame < _frames; ++frame )
 			{
 				_out_buf[frame][ch] = m_shm[( m_inputCount+ch )*
-								frames + frame];
+								_frames + frame];
 			}
 		}
 	}
 	else if( outputs == DEFAULT_CHANNELS )
 	{
-		memcpy( _out_buf, m_shm + m_inputCount * frames,
-						frames * BYTES_PER_FRAME );
+		memcpy( _out_buf, m_shm + m_inputCount * _frames,
+						_frames * BYTES_PER_FRAME );
 	}
 	else
 	{
 		sampleFrame * o = (sampleFrame *) ( m_shm +
-							m_inputCount*frames );
+							m_inputCount*_frames );
 		// clear buffer, if plugin didn't fill up both channels
-		BufferManager::clear( _out_buf, frames );
+		BufferManager::clear( _out_buf, _frames );
 
 		for( ch_cnt_t ch = 0; ch <
 				qMin<int>( DEFAULT_CHANNELS, outputs ); ++ch )
 		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
+			for( fpp_t frame = 0; frame < _frames; ++frame )
 			{
 				_out_buf[frame][ch] = o[frame][ch];
 			}
 		}
 	}
-
-	return true;
 }
 
 
@@ -480,7 +645,7 @@ void RemotePlugin::processFinished( int exitCode,
 	{
 		qCritical() << "Remote plugin exit code: " << exitCode;
 	}
-#ifndef SYNC_WITH_SHM_FIFO
+#ifdef SYNC_WITH_SOCKET
 	invalidate();
 #endif
 }
@@ -493,6 +658,14 @@ void RemotePlugin::processErrored( QProcess::ProcessError err )
 
 
 
+void RemotePlugin::processDied()
+{
+	invalidate();
+}
+
+
+
+
 bool RemotePlugin::processMessage( const message & _m )
 {
 	lock();
@@ -540,6 +713,9 @@ bool RemotePlugin::processMessage( const message & _m )
 			break;
 
 		case IdProcessingDone:
+			m_processing = false;
+			break;
+
 		case IdQuit:
 		default:
 			break;
@@ -552,3 +728,91 @@ bool RemotePlugin::processMessage( const message & _m )
 
 	return true;
 }
+
+
+
+
+
+RemotePluginGroup::RemotePluginGroup() :
+	RemotePlugin()
+{
+}
+
+
+
+
+std::shared_ptr<RemotePluginGroup> RemotePluginGroup::get(
+				const QString & _exec, const QString & _group )
+{
+	static QMutex mutex;
+	static QHash<QPair<QString, QString>,
+				std::weak_ptr<RemotePluginGroup> > groups;
+
+	QMutexLocker locker( &mutex );
+
+	std::weak_ptr<RemotePluginGroup> & entry =
+					groups[qMakePair( _exec, _group )];
+	std::shared_ptr<RemotePluginGroup> group = entry.lock();
+	// start a new process if the last one crashed, the instances it
+	// hosted fail with it but the others don't have to
+	if( !group || group->failed() || !group->isRunning() )
+	{
+		group = std::make_shared<RemotePluginGroup>();
+		group->init( _exec, true, QStringList() << "--group" );
+		entry = group;
+	}
+
+	return group;
+}
+
+
+
+
+bool RemotePluginGroup::addInstance( RemotePlugin * _instance,
+						const QStringList & _args )
+{
+	if( failed() || !isRunning() )
+	{
+		return false;
+	}
+
+	m_instancesMutex.lock();
+	m_instances << _instance;
+	m_instancesMutex.unlock();
+
+	message m( IdAddInstance );
+	for( const QString & arg : _args )
+	{
+		m.addString( QSTR_TO_STDSTR( arg ) );
+	}
+	lock();
+	sendMessage( m );
+	unlock();
+
+	return true;
+}
+
+
+
+
+void RemotePluginGroup::removeInstance( RemotePlugin * _instance )
+{
+	m_instancesMutex.lock();
+	m_instances.removeAll( _instance );
+	m_instancesMutex.unlock();
+}
+
+
+
+
+void RemotePluginGroup::processDied()
+{
+	m_instancesMutex.lock();
+	for( RemotePlugin * instance : m_instances )
+	{
+		instance->invalidate();
+	}
+	m_instancesMutex.unlock();
+
+	RemotePlugin::processDied();
+}
@@ -29,27 +29,46 @@
 #include "Song.h"
 #include "BBTrackContainer.h"
 #include "BBTrack.h"
+#include "FxMixer.h"
+#include "InstrumentTrack.h"
+#include "SampleTrack.h"
 #include "stdshims.h"
 
 
+// The port carrying the output of instrument and sample tracks, NULL for
+// all other tracks
+static AudioPort * audioPortOf( Track * track )
+{
+	if( track->type() == Track::InstrumentTrack )
+	{
+		return static_cast<InstrumentTrack *>( track )->audioPort();
+	}
+	else if( track->type() == Track::SampleTrack )
+	{
+		return static_cast<SampleTrack *>( track )->audioPort();
+	}
+	return NULL;
+}
+
+
 RenderManager::RenderManager(
 		const Mixer::qualitySettings & qualitySettings,
 		const OutputSettings & outputSettings,
 		ProjectRenderer::ExportFileFormats fmt,
 		QString outputPath) :
 	m_qualitySettings(qualitySettings),
-	m_oldQualitySettings( Engine::mixer()->currentQualitySettings() ),
 	m_outputSettings(outputSettings),
 	m_format(fmt),
-	m_outputPath(outputPath)
+	m_outputPath(outputPath),
+	m_stemCount(0)
 {
 	Engine::mixer()->storeAudioDevice();
 }
 
 RenderManager::~RenderManager()
 {
-	Engine::mixer()->restoreAudioDevice();  // Also deletes audio dev.
-	Engine::mixer()->changeQuality( m_oldQualitySettings );
+	// Also deletes audio dev and restores the previous quality settings.
+	Engine::mixer()->restoreAudioDevice();
 }
 
 void RenderManager::abortProcessing()
@@ -93,8 +112,14 @@ void RenderManager::renderNextTrack()
 }
 
 // Render the song into individual tracks
-void RenderManager::renderTracks()
+void RenderManager::renderTracks( StemModes mode )
 {
+	if( mode != StemsFullMix )
+	{
+		renderStems( mode );
+		return;
+	}
+
 	const TrackContainer::TrackList & tl = Engine::getSong()->tracks();
 
 	// find all currently unnmuted tracks -- we want to render these.
@@ -138,6 +163,93 @@ void RenderManager::renderProject()
 	render( m_outputPath );
 }
 
+// Render the output of a single track after its effects into m_outputPath,
+// with all other tracks muted so they don't cost any time. The output isn't
+// delayed to line up with other tracks, as it's meant to be played through
+// the track again, which does that.
+void RenderManager::renderTrack( Track * track )
+{
+	TrackContainer::TrackList tracks = Engine::getSong()->tracks();
+	tracks += Engine::getBBTrackContainer()->tracks();
+
+	AudioPort * port = NULL;
+	for( Track * tk : tracks )
+	{
+		if( tk == track )
+		{
+			port = audioPortOf( tk );
+		}
+		else if( audioPortOf( tk ) && !tk->isMuted() )
+		{
+			tk->setMuted( true );
+			m_unmuted.push_back( tk );
+		}
+	}
+
+	m_activeRenderer = make_unique<ProjectRenderer>(
+			m_qualitySettings,
+			m_outputSettings,
+			m_format,
+			QString() );
+	if( port )
+	{
+		m_activeRenderer->addStem( port, m_outputPath,
+						AudioPort::StemUncompensated );
+	}
+
+	startRenderer();
+}
+
+// Render all tracks or FX channels into individual files in a single pass
+// over the song, instead of rendering the whole song once per track
+void RenderManager::renderStems( StemModes mode )
+{
+	m_activeRenderer = make_unique<ProjectRenderer>(
+			m_qualitySettings,
+			m_outputSettings,
+			m_format,
+			QString() );
+
+	if( mode == StemsFxChannels )
+	{
+		FxMixer * fxMixer = Engine::fxMixer();
+		for( int i = 0; i < fxMixer->numChannels(); ++i )
+		{
+			FxChannel * channel = fxMixer->effectChannel( i );
+			if( !channel->m_muteModel.value() )
+			{
+				m_activeRenderer->addStem( channel,
+						pathForFxChannel( channel, i ) );
+			}
+		}
+	}
+	else
+	{
+		TrackContainer::TrackList tracks = Engine::getSong()->tracks();
+		tracks += Engine::getBBTrackContainer()->tracks();
+
+		int trackNum = 0;
+		for( Track * track : tracks )
+		{
+			AudioPort * port = audioPortOf( track );
+
+			// Don't render automation tracks
+			if( port && !track->isMuted() )
+			{
+				m_activeRenderer->addStem( port,
+					pathForTrack( track, ++trackNum ),
+					mode == StemsTrackPreEffects ?
+						AudioPort::StemPreEffects :
+						AudioPort::StemPostEffects );
+			}
+		}
+	}
+
+	m_stemCount = m_activeRenderer->stemCount();
+
+	startRenderer();
+}
+
 void RenderManager::render(QString outputPath)
 {
 	m_activeRenderer = make_unique<ProjectRenderer>(
@@ -146,6 +258,11 @@ void RenderManager::render(QString outputPath)
 			m_format,
 			outputPath);
 
+	startRenderer();
+}
+
+void RenderManager::startRenderer()
+{
 	if( m_activeRenderer->isReady() )
 	{
 		// pass progress signals through
@@ -187,6 +304,20 @@ QString RenderManager::pathForTrack(const Track *track, int num)
 	return QDir(m_outputPath).filePath(name);
 }
 
+// Determine the output path for an FX channel when rendering FX channels
+QString RenderManager::pathForFxChannel(const FxChannel *channel, int num)
+{
+	QString extension = ProjectRenderer::getFileExtensionFromFormat( m_format );
+	QString name = channel->m_name;
+	name = name.remove(QRegExp("[^a-zA-Z]"));
+	if( name.isEmpty() )
+	{
+		name = num == 0 ? "Master" : "FX";
+	}
+	name = QString( "fx%1_%2%3" ).arg( num ).arg( name ).arg( extension );
+	return QDir(m_outputPath).filePath(name);
+}
+
 void RenderManager::updateConsoleProgress()
 {
 	if ( m_activeRenderer )
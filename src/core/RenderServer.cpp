@@ -0,0 +1,198 @@
+/*
+ * RenderServer.cpp - renders a queue of projects without restarting LMMS
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <cstdio>
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTimer>
+
+#include "RenderServer.h"
+#include "RenderManager.h"
+#include "Song.h"
+
+
+RenderServer::RenderServer(
+		const Mixer::qualitySettings & qualitySettings,
+		const OutputSettings & outputSettings,
+		ProjectRenderer::ExportFileFormats fmt,
+		bool renderLoop ) :
+	m_qualitySettings( qualitySettings ),
+	m_outputSettings( outputSettings ),
+	m_format( fmt ),
+	m_renderLoop( renderLoop ),
+	m_renderManager( NULL ),
+	m_loadTime( 0 ),
+	m_jobCount( 0 ),
+	m_failedCount( 0 )
+{
+}
+
+
+
+
+RenderServer::~RenderServer()
+{
+	delete m_renderManager;
+}
+
+
+
+
+bool RenderServer::start( const QString & jobFile )
+{
+	if( jobFile.isEmpty() )
+	{
+		if( !m_jobs.open( stdin, QIODevice::ReadOnly | QIODevice::Text ) )
+		{
+			return false;
+		}
+	}
+	else
+	{
+		m_jobs.setFileName( jobFile );
+		if( !m_jobs.open( QIODevice::ReadOnly | QIODevice::Text ) )
+		{
+			return false;
+		}
+	}
+
+	QTimer::singleShot( 0, this, SLOT( nextJob() ) );
+
+	return true;
+}
+
+
+
+
+void RenderServer::nextJob()
+{
+	if( !readJob() )
+	{
+		fprintf( stderr, "Rendered %d projects, %d failed\n",
+					m_jobCount, m_failedCount );
+		emit finished();
+		return;
+	}
+
+	++m_jobCount;
+
+	m_timer.start();
+
+	// clear the song, the FX mixer and the beat/bassline editor, so
+	// nothing is left over from the last job if loading fails
+	Song * song = Engine::getSong();
+	song->clearProject();
+	// a project without any tracks is rendered as well, as silence
+	if( !song->loadProject( m_project ) )
+	{
+		printResult( "load-failed" );
+		QTimer::singleShot( 0, this, SLOT( nextJob() ) );
+		return;
+	}
+	song->setExportLoop( m_renderLoop );
+
+	m_loadTime = m_timer.restart();
+
+	QFile::remove( m_output );
+
+	m_renderManager = new RenderManager( m_qualitySettings,
+				m_outputSettings, m_format, m_output );
+	connect( m_renderManager, SIGNAL( finished() ),
+				this, SLOT( jobFinished() ), Qt::QueuedConnection );
+	m_renderManager->renderProject();
+}
+
+
+
+
+void RenderServer::jobFinished()
+{
+	// restores the audio device and quality settings
+	delete m_renderManager;
+	m_renderManager = NULL;
+
+	printResult( QFileInfo( m_output ).size() > 0 ?
+					"ok" : "render-failed" );
+
+	nextJob();
+}
+
+
+
+
+bool RenderServer::readJob()
+{
+	// blocks until the next line is available, returns nothing at the
+	// end of the input only
+	QByteArray data;
+	while( !( data = m_jobs.readLine() ).isEmpty() )
+	{
+		const QString line = QString::fromLocal8Bit( data ).trimmed();
+		if( line.isEmpty() || line.startsWith( '#' ) )
+		{
+			continue;
+		}
+
+		const QStringList fields = line.split( '\t' );
+
+		m_project = QFileInfo( fields[0].trimmed() ).absoluteFilePath();
+		m_output = fields.size() > 1 && !fields[1].trimmed().isEmpty() ?
+					fields[1].trimmed() : m_project;
+
+		// same rule as for "render": the extension always follows
+		// the output format
+		QFileInfo outputInfo( m_output );
+		m_output = outputInfo.absolutePath() + "/" +
+				outputInfo.completeBaseName() +
+			ProjectRenderer::getFileExtensionFromFormat( m_format );
+
+		return true;
+	}
+
+	return false;
+}
+
+
+
+
+void RenderServer::printResult( const QString & status )
+{
+	const bool loaded = status != "load-failed";
+	if( status != "ok" )
+	{
+		++m_failedCount;
+	}
+
+	QJsonObject result;
+	result["job"] = m_jobCount;
+	result["project"] = m_project;
+	result["output"] = m_output;
+	result["status"] = status;
+	result["load_ms"] = loaded ? m_loadTime : m_timer.elapsed();
+	result["render_ms"] = loaded ? m_timer.elapsed() : 0;
+
+	printf( "%s\n", QJsonDocument( result ).toJson(
+				QJsonDocument::Compact ).constData() );
+	fflush( stdout );
+}
@@ -30,6 +30,7 @@
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QPainter>
+#include <QThread>
 
 
 #include <sndfile.h>
@@ -55,10 +56,47 @@
 #include "Engine.h"
 #include "GuiApplication.h"
 #include "Mixer.h"
+#include "SampleDataBundle.h"
 
 #include "FileDialog.h"
 
 
+// File size and sample length limits
+static const int FileSizeMax = 300; // MB
+static const int SampleLengthMax = 90; // Minutes
+
+
+
+// summarizes the data of a SampleBuffer for drawing, away from the GUI thread
+class SampleBuffer::PeakCacheBuilder : public QThread
+{
+public:
+	PeakCacheBuilder( const sampleFrame * _data, f_cnt_t _frames ) :
+		m_data( _data ),
+		m_frames( _frames )
+	{
+	}
+
+	SamplePeakCache & cache()
+	{
+		return m_cache;
+	}
+
+
+private:
+	void run() override
+	{
+		m_cache.build( m_data, m_frames );
+	}
+
+	const sampleFrame * m_data;
+	f_cnt_t m_frames;
+	SamplePeakCache m_cache;
+
+} ;
+
+
+
 
 SampleBuffer::SampleBuffer() :
 	m_audioFile( "" ),
@@ -73,7 +111,11 @@ SampleBuffer::SampleBuffer() :
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( mixerSampleRate () )
+	m_sampleRate( mixerSampleRate () ),
+	m_peakCacheBuilder( NULL ),
+	m_cachedData( NULL ),
+	m_cachedFrames( 0 ),
+	m_cachedSampleRate( 0 )
 {
 
 	connect( Engine::mixer(), SIGNAL( sampleRateChanged() ), this, SLOT( sampleRateChanged() ) );
@@ -132,15 +174,94 @@ SampleBuffer::SampleBuffer( const f_cnt_t _frames )
 
 SampleBuffer::~SampleBuffer()
 {
+	stopPeakCacheBuild();
 	MM_FREE( m_origData );
 	MM_FREE( m_data );
+	MM_FREE( m_cachedData );
 }
 
 
 
 void SampleBuffer::sampleRateChanged()
 {
-	update( true );
+	const sample_rate_t rate = mixerSampleRate();
+	if( rate == m_sampleRate )
+	{
+		return;
+	}
+
+	if( m_audioFile.isEmpty() )
+	{
+		// data without its original can't be prepared again
+		if( m_origData != NULL )
+		{
+			update( true );
+		}
+		return;
+	}
+
+	sampleFrame * data;
+	f_cnt_t frames;
+	bool fromCache = false;
+	if( m_cachedData != NULL && m_cachedSampleRate == rate )
+	{
+		// we've been at this rate before (e.g. before exporting), so
+		// just switch back to the data we kept
+		data = m_cachedData;
+		frames = m_cachedFrames;
+		m_cachedData = NULL;
+		fromCache = true;
+	}
+	else
+	{
+		// decode into new data first, so the mixer isn't blocked
+		// while reading and resampling the file
+		bool tooLarge;
+		frames = decodeAudioFile( data, tooLarge );
+		if( frames == 0 )
+		{
+			data = MM_ALLOC( sampleFrame, 1 );
+			memset( data, 0, sizeof( *data ) );
+			frames = 1;
+		}
+	}
+
+	stopPeakCacheBuild();
+	Engine::mixer()->requestChangeInModel();
+	m_varLock.lockForWrite();
+
+	// keep the data for the rate we're leaving, unless we're returning
+	// to a cached rate - that way at most two versions of a sample exist
+	// while exporting, and only one afterwards
+	MM_FREE( m_cachedData );
+	if( fromCache )
+	{
+		MM_FREE( m_data );
+		m_cachedData = NULL;
+		m_cachedFrames = 0;
+		m_cachedSampleRate = 0;
+	}
+	else
+	{
+		m_cachedData = m_data;
+		m_cachedFrames = m_frames;
+		m_cachedSampleRate = m_sampleRate;
+	}
+
+	const float ratio = static_cast<float>( rate ) / m_sampleRate;
+	m_data = data;
+	m_frames = frames;
+	m_startFrame = qBound( 0, f_cnt_t( m_startFrame * ratio ), m_frames );
+	m_endFrame = qBound( m_startFrame, f_cnt_t( m_endFrame * ratio ), m_frames );
+	m_loopStartFrame = qBound( 0, f_cnt_t( m_loopStartFrame * ratio ), m_frames );
+	m_loopEndFrame = qBound( m_loopStartFrame, f_cnt_t( m_loopEndFrame * ratio ), m_frames );
+	m_sampleRate = rate;
+	m_peakCache.clear();
+
+	m_varLock.unlock();
+	Engine::mixer()->doneChangeInModel();
+
+	emit sampleUpdated();
 }
 
 sample_rate_t SampleBuffer::mixerSampleRate()
@@ -151,6 +272,7 @@ sample_rate_t SampleBuffer::mixerSampleRate()
 
 void SampleBuffer::update( bool _keep_settings )
 {
+	stopPeakCacheBuild();
 	const bool lock = ( m_data != NULL );
 	if( lock )
 	{
@@ -158,10 +280,9 @@ void SampleBuffer::update( bool _keep_settings )
 		m_varLock.lockForWrite();
 		MM_FREE( m_data );
 	}
-
-	// File size and sample length limits
-	const int fileSizeMax = 300; // MB
-	const int sampleLengthMax = 90; // Minutes
+	m_peakCache.clear();
+	MM_FREE( m_cachedData );
+	m_cachedData = NULL;
 
 	bool fileLoadError = false;
 	if( m_audioFile.isEmpty() && m_origData != NULL && m_origFrames > 0 )
@@ -179,70 +300,9 @@ void SampleBuffer::update( bool _keep_settings )
 	}
 	else if( !m_audioFile.isEmpty() )
 	{
-		QString file = tryToMakeAbsolute( m_audioFile );
-		int_sample_t * buf = NULL;
-		sample_t * fbuf = NULL;
-		ch_cnt_t channels = DEFAULT_CHANNELS;
-		sample_rate_t samplerate = mixerSampleRate();
-		m_frames = 0;
-
-		const QFileInfo fileInfo( file );
-		if( fileInfo.size() > fileSizeMax * 1024 * 1024 )
-		{
-			fileLoadError = true;
-		}
-		else
-		{
-			// Use QFile to handle unicode file names on Windows
-			QFile f(file);
-			f.open(QIODevice::ReadOnly);
-			SNDFILE * snd_file;
-			SF_INFO sf_info;
-			sf_info.format = 0;
-			if( ( snd_file = sf_open_fd( f.handle(), SFM_READ, &sf_info, false ) ) != NULL )
-			{
-				f_cnt_t frames = sf_info.frames;
-				int rate = sf_info.samplerate;
-				if( frames / rate > sampleLengthMax * 60 )
-				{
-					fileLoadError = true;
-				}
-				sf_close( snd_file );
-			}
-			f.close();
-		}
-
-		if( !fileLoadError )
-		{
-#ifdef LMMS_HAVE_OGGVORBIS
-			// workaround for a bug in libsndfile or our libsndfile decoder
-			// causing some OGG files to be distorted -> try with OGG Vorbis
-			// decoder first if filename extension matches "ogg"
-			if( m_frames == 0 && fileInfo.suffix() == "ogg" )
-			{
-				m_frames = decodeSampleOGGVorbis( file, buf, channels, samplerate );
-			}
-#endif
-			if( m_frames == 0 )
-			{
-				m_frames = decodeSampleSF( file, fbuf, channels,
-									samplerate );
-			}
-#ifdef LMMS_HAVE_OGGVORBIS
-			if( m_frames == 0 )
-			{
-				m_frames = decodeSampleOGGVorbis( file, buf, channels,
-									samplerate );
-			}
-#endif
-			if( m_frames == 0 )
-			{
-				m_frames = decodeSampleDS( file, buf, channels,
-									samplerate );
-			}
-		}
-
-		if ( m_frames == 0 || fileLoadError )  // if still no frames, bail
+		sampleFrame * data;
+		m_frames = decodeAudioFile( data, fileLoadError );
+		if( m_frames == 0 )  // if no frames, bail
 		{
 			// sample couldn't be decoded, create buffer containing
 			// one sample-frame
@@ -252,9 +312,13 @@ void SampleBuffer::update( bool _keep_settings )
 			m_loopStartFrame = m_startFrame = 0;
 			m_loopEndFrame = m_endFrame = 1;
 		}
-		else // otherwise normalize sample rate
+		else
 		{
-			normalizeSampleRate( samplerate, _keep_settings );
+			m_data = data;
+			// the data is at the processing rate already, so this
+			// only updates the frame markers
+			normalizeSampleRate( mixerSampleRate(), _keep_settings );
+			m_sampleRate = mixerSampleRate();
 		}
 	}
 	else
@@ -281,7 +345,7 @@ void SampleBuffer::update( bool _keep_settings )
 		QString title = tr( "Fail to open file" );
 		QString message = tr( "Audio files are limited to %1 MB "
 				"in size and %2 minutes of playing time"
-				).arg( fileSizeMax ).arg( sampleLengthMax );
+				).arg( FileSizeMax ).arg( SampleLengthMax );
 		if( gui )
 		{
 			QMessageBox::information( NULL,
@@ -295,12 +359,113 @@ void SampleBuffer::update( bool _keep_settings )
 }
 
 
-void SampleBuffer::convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames, int _channels)
+f_cnt_t SampleBuffer::decodeAudioFile( sampleFrame * & _data,
+							bool & _tooLarge )
+{
+	QString file = tryToMakeAbsolute( m_audioFile );
+	int_sample_t * buf = NULL;
+	sample_t * fbuf = NULL;
+	bool floatData = false;
+	ch_cnt_t channels = DEFAULT_CHANNELS;
+	sample_rate_t samplerate = mixerSampleRate();
+	f_cnt_t frames = 0;
+	_data = NULL;
+	_tooLarge = false;
+
+	const QFileInfo fileInfo( file );
+	if( fileInfo.size() > FileSizeMax * 1024 * 1024 )
+	{
+		_tooLarge = true;
+	}
+	else
+	{
+		// Use QFile to handle unicode file names on Windows
+		QFile f(file);
+		f.open(QIODevice::ReadOnly);
+		SNDFILE * snd_file;
+		SF_INFO sf_info;
+		sf_info.format = 0;
+		if( ( snd_file = sf_open_fd( f.handle(), SFM_READ, &sf_info, false ) ) != NULL )
+		{
+			f_cnt_t fileFrames = sf_info.frames;
+			int rate = sf_info.samplerate;
+			if( fileFrames / rate > SampleLengthMax * 60 )
+			{
+				_tooLarge = true;
+			}
+			sf_close( snd_file );
+		}
+		f.close();
+	}
+
+	if( _tooLarge )
+	{
+		return 0;
+	}
+
+#ifdef LMMS_HAVE_OGGVORBIS
+	// workaround for a bug in libsndfile or our libsndfile decoder
+	// causing some OGG files to be distorted -> try with OGG Vorbis
+	// decoder first if filename extension matches "ogg"
+	if( frames == 0 && fileInfo.suffix() == "ogg" )
+	{
+		frames = decodeSampleOGGVorbis( file, buf, channels, samplerate );
+	}
+#endif
+	if( frames == 0 )
+	{
+		frames = decodeSampleSF( file, fbuf, channels, samplerate );
+		floatData = frames > 0;
+	}
+#ifdef LMMS_HAVE_OGGVORBIS
+	if( frames == 0 )
+	{
+		frames = decodeSampleOGGVorbis( file, buf, channels,
+								samplerate );
+	}
+#endif
+	if( frames == 0 )
+	{
+		frames = decodeSampleDS( file, buf, channels, samplerate );
+	}
+
+	if( frames == 0 || ( floatData ? fbuf : buf ) == NULL )
+	{
+		return 0;
+	}
+
+	// write down either directly or convert i->f depending on file type
+	if( floatData )
+	{
+		directFloatWrite( fbuf, frames, channels, _data );
+	}
+	else
+	{
+		convertIntToFloat( buf, frames, channels, _data );
+	}
+
+	// normalize sample rate
+	if( samplerate != mixerSampleRate() )
+	{
+		sampleFrame * resampled;
+		frames = resampleData( _data, frames, samplerate,
+						mixerSampleRate(), resampled );
+		MM_FREE( _data );
+		_data = resampled;
+	}
+
+	return frames;
+}
+
+
+
+
+void SampleBuffer::convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames, int _channels, sampleFrame * & _data ) const
 {
 	// following code transforms int-samples into
 	// float-samples and does amplifying & reversing
 	const float fac = 1 / OUTPUT_SAMPLE_MULTIPLIER;
-	m_data = MM_ALLOC( sampleFrame, _frames );
+	_data = MM_ALLOC( sampleFrame, _frames );
 	const int ch = ( _channels > 1 ) ? 1 : 0;
 
 	// if reversing is on, we also reverse when
@@ -311,8 +476,8 @@ void SampleBuffer::convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames,
 		for( f_cnt_t frame = 0; frame < _frames;
 						++frame )
 		{
-			m_data[frame][0] = _ibuf[idx+0] * fac;
-			m_data[frame][1] = _ibuf[idx+ch] * fac;
+			_data[frame][0] = _ibuf[idx+0] * fac;
+			_data[frame][1] = _ibuf[idx+ch] * fac;
 			idx -= _channels;
 		}
 	}
@@ -322,8 +487,8 @@ void SampleBuffer::convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames,
 		for( f_cnt_t frame = 0; frame < _frames;
 						++frame )
 		{
-			m_data[frame][0] = _ibuf[idx+0] * fac;
-			m_data[frame][1] = _ibuf[idx+ch] * fac;
+			_data[frame][0] = _ibuf[idx+0] * fac;
+			_data[frame][1] = _ibuf[idx+ch] * fac;
 			idx += _channels;
 		}
 	}
@@ -331,11 +496,11 @@ void SampleBuffer::convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames,
 	delete[] _ibuf;
 }
 
-void SampleBuffer::directFloatWrite ( sample_t * & _fbuf, f_cnt_t _frames, int _channels)
+void SampleBuffer::directFloatWrite ( sample_t * & _fbuf, f_cnt_t _frames, int _channels, sampleFrame * & _data ) const
 
 {
 
-	m_data = MM_ALLOC( sampleFrame, _frames );
+	_data = MM_ALLOC( sampleFrame, _frames );
 	const int ch = ( _channels > 1 ) ? 1 : 0;
 
 	// if reversing is on, we also reverse when
@@ -346,8 +511,8 @@ void SampleBuffer::directFloatWrite ( sample_t * & _fbuf, f_cnt_t _frames, int _
 		for( f_cnt_t frame = 0; frame < _frames;
 						++frame )
 		{
-			m_data[frame][0] = _fbuf[idx+0];
-			m_data[frame][1] = _fbuf[idx+ch];
+			_data[frame][0] = _fbuf[idx+0];
+			_data[frame][1] = _fbuf[idx+ch];
 			idx -= _channels;
 		}
 	}
@@ -357,8 +522,8 @@ void SampleBuffer::directFloatWrite ( sample_t * & _fbuf, f_cnt_t _frames, int _
 		for( f_cnt_t frame = 0; frame < _frames;
 						++frame )
 		{
-			m_data[frame][0] = _fbuf[idx+0];
-			m_data[frame][1] = _fbuf[idx+ch];
+			_data[frame][0] = _fbuf[idx+0];
+			_data[frame][1] = _fbuf[idx+ch];
 			idx += _channels;
 		}
 	}
@@ -374,16 +539,12 @@ void SampleBuffer::normalizeSampleRate( const sample_rate_t _src_sr,
 	// do samplerate-conversion to our default-samplerate
 	if( _src_sr != mixerSampleRate() )
 	{
-		SampleBuffer * resampled = resample( _src_sr,
-					mixerSampleRate() );
-
-		m_sampleRate = mixerSampleRate();
+		sampleFrame * resampled;
+		m_frames = resampleData( m_data, m_frames, _src_sr,
+						mixerSampleRate(), resampled );
 		MM_FREE( m_data );
-		m_frames = resampled->frames();
-		m_data = MM_ALLOC( sampleFrame, m_frames );
-		memcpy( m_data, resampled->data(), m_frames *
-							sizeof( sampleFrame ) );
-		delete resampled;
+		m_data = resampled;
+		m_sampleRate = mixerSampleRate();
 	}
 
 	if( _keep_settings == false )
@@ -450,13 +611,6 @@ f_cnt_t SampleBuffer::decodeSampleSF(QString _f,
 	}
 	f.close();
 
-	//write down either directly or convert i->f depending on file type
-
-	if ( frames > 0 && _buf != NULL )
-	{
-		directFloatWrite ( _buf, frames, _channels);
-	}
-
 	return frames;
 }
 
@@ -597,12 +751,6 @@ f_cnt_t SampleBuffer::decodeSampleOGGVorbis( QString _f,
 	while( bytes_read != 0 && bitstream == 0 );
 
 	ov_clear( &vf );
-	// if buffer isn't empty, convert it to float and write it down
-
-	if ( frames > 0 && _buf != NULL )
-	{
-		convertIntToFloat ( _buf, frames, _channels);
-	}
 
 	return frames;
 }
@@ -619,11 +767,6 @@ f_cnt_t SampleBuffer::decodeSampleDS( QString _f,
 	DrumSynth ds;
 	f_cnt_t frames = ds.GetDSFileSamples( _f, _buf, _channels, _samplerate );
 
-	if ( frames > 0 && _buf != NULL )
-	{
-		convertIntToFloat ( _buf, frames, _channels);
-	}
-
 	return frames;
 
 }
@@ -948,27 +1091,116 @@ void SampleBuffer::visualize( QPainter & _p, const QRect & _dr,
 	const int yb = h / 2 + _dr.y();
 	const float y_space = h*0.5f;
 	const int nb_frames = focus_on_range ? _to_frame - _from_frame : m_frames;
-
-	const int fpp = qBound<int>( 1, nb_frames / w, 20 );
-	QPointF * l = new QPointF[nb_frames / fpp + 1];
-	QPointF * r = new QPointF[nb_frames / fpp + 1];
-	int n = 0;
 	const int xb = _dr.x();
 	const int first = focus_on_range ? _from_frame : 0;
 	const int last = focus_on_range ? _to_frame : m_frames;
-	for( int frame = first; frame < last; frame += fpp )
+
+	_p.setRenderHint( QPainter::Antialiasing );
+
+	// when zoomed out, draw one min/max line per pixel and channel, looked
+	// up in the peak cache so the cost depends on the width only
+	const bool usePeaks = w > 0 && nb_frames / w > 20;
+	if( usePeaks && !m_peakCache.isValid() )
 	{
-		l[n] = QPointF( xb + ( (frame - first) * double( w ) / nb_frames ),
-			( yb - ( m_data[frame][0] * y_space * m_amplification ) ) );
-		r[n] = QPointF( xb + ( (frame - first) * double( w ) / nb_frames ),
-			( yb - ( m_data[frame][1] * y_space * m_amplification ) ) );
-		++n;
+		startPeakCacheBuild();
+	}
+
+	if( !usePeaks || !m_peakCache.isValid() )
+	{
+		// draw the actual curve, skipping frames until the peak cache
+		// is ready if zoomed out
+		const int fpp = qBound<int>( 1, w > 0 ? nb_frames / w : 1, 20 );
+		QPointF * l = new QPointF[nb_frames / fpp + 1];
+		QPointF * r = new QPointF[nb_frames / fpp + 1];
+		int n = 0;
+		for( int frame = first; frame < last; frame += fpp )
+		{
+			l[n] = QPointF( xb + ( (frame - first) * double( w ) / nb_frames ),
+				( yb - ( m_data[frame][0] * y_space * m_amplification ) ) );
+			r[n] = QPointF( xb + ( (frame - first) * double( w ) / nb_frames ),
+				( yb - ( m_data[frame][1] * y_space * m_amplification ) ) );
+			++n;
+		}
+		_p.drawPolyline( l, nb_frames / fpp );
+		_p.drawPolyline( r, nb_frames / fpp );
+		delete[] l;
+		delete[] r;
+		return;
+	}
+
+	const double frames_per_px = double( nb_frames ) / w;
+	QLineF * lines = new QLineF[w * DEFAULT_CHANNELS];
+	int n = 0;
+	for( int x = xb; x < xb + w; ++x )
+	{
+		const f_cnt_t from = first + static_cast<f_cnt_t>( ( x - xb ) * frames_per_px );
+		const f_cnt_t to = first + static_cast<f_cnt_t>( ( x - xb + 1 ) * frames_per_px );
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			const SamplePeakCache::Peak peak =
+				m_peakCache.query( m_data, from, qMin<f_cnt_t>( to, last ), ch );
+			lines[n++] = QLineF( x + 0.5, yb - peak.max * y_space * m_amplification,
+						x + 0.5, yb - peak.min * y_space * m_amplification );
+		}
+	}
+	_p.drawLines( lines, n );
+	delete[] lines;
+}
+
+
+
+
+void SampleBuffer::startPeakCacheBuild()
+{
+	if( m_peakCacheBuilder != NULL || m_data == NULL )
+	{
+		return;
+	}
+
+	m_peakCacheBuilder = new PeakCacheBuilder( m_data, m_frames );
+	connect( m_peakCacheBuilder, SIGNAL( finished() ),
+				this, SLOT( peakCacheBuilt() ), Qt::QueuedConnection );
+	m_peakCacheBuilder->start( QThread::LowPriority );
+}
+
+
+
+
+void SampleBuffer::stopPeakCacheBuild()
+{
+	if( m_peakCacheBuilder == NULL )
+	{
+		return;
+	}
+
+	// the builder reads m_data, so it has to be done before that changes
+	m_peakCacheBuilder->requestInterruption();
+	m_peakCacheBuilder->wait();
+	delete m_peakCacheBuilder;
+	m_peakCacheBuilder = NULL;
+}
+
+
+
+
+void SampleBuffer::peakCacheBuilt()
+{
+	// notifications of stopped builds may still arrive - only take over
+	// the result of the current one
+	if( m_peakCacheBuilder == NULL || !m_peakCacheBuilder->isFinished() )
+	{
+		return;
+	}
+
+	m_peakCacheBuilder->wait();
+	m_peakCache = std::move( m_peakCacheBuilder->cache() );
+	delete m_peakCacheBuilder;
+	m_peakCacheBuilder = NULL;
+
+	if( m_peakCache.isValid() )
+	{
+		emit peaksReady();
 	}
-	_p.setRenderHint( QPainter::Antialiasing );
-	_p.drawPolyline( l, nb_frames / fpp );
-	_p.drawPolyline( r, nb_frames / fpp );
-	delete[] l;
-	delete[] r;
 }
 
 
@@ -1179,15 +1411,74 @@ QString & SampleBuffer::toBase64( QString & _dst ) const
 
 
 
+qint64 SampleBuffer::addToBundle( SampleDataBundle & _bundle ) const
+{
+	return _bundle.add( m_data, m_frames );
+}
+
+
+
+
+bool SampleBuffer::loadFromBundle( const SampleDataBundle & _bundle,
+					qint64 _offset, f_cnt_t _frames )
+{
+	if( _frames <= 0 )
+	{
+		return false;
+	}
+
+	sampleFrame * data = MM_ALLOC( sampleFrame, _frames );
+	if( !_bundle.read( _offset, _frames, data ) )
+	{
+		MM_FREE( data );
+		return false;
+	}
+
+	MM_FREE( m_origData );
+	m_origData = data;
+	m_origFrames = _frames;
+
+	m_audioFile = QString();
+	update();
+	return true;
+}
+
+
+
+
+void SampleBuffer::dropOriginalData()
+{
+	MM_FREE( m_origData );
+	m_origData = NULL;
+	m_origFrames = 0;
+}
+
+
+
+
 SampleBuffer * SampleBuffer::resample( const sample_rate_t _src_sr,
 						const sample_rate_t _dst_sr )
 {
-	sampleFrame * data = m_data;
-	const f_cnt_t frames = m_frames;
-	const f_cnt_t dst_frames = static_cast<f_cnt_t>( frames /
-					(float) _src_sr * (float) _dst_sr );
-	SampleBuffer * dst_sb = new SampleBuffer( dst_frames );
-	sampleFrame * dst_buf = dst_sb->m_origData;
+	sampleFrame * data;
+	const f_cnt_t frames = resampleData( m_data, m_frames, _src_sr, _dst_sr,
+									data );
+	SampleBuffer * dst_sb = new SampleBuffer( data, frames );
+	MM_FREE( data );
+	return dst_sb;
+}
+
+
+
+
+f_cnt_t SampleBuffer::resampleData( const sampleFrame * _src, f_cnt_t _frames,
+					const sample_rate_t _src_sr,
+					const sample_rate_t _dst_sr,
+					sampleFrame * & _dst )
+{
+	const f_cnt_t dst_frames = qMax<f_cnt_t>( 1, static_cast<f_cnt_t>(
+				_frames / (float) _src_sr * (float) _dst_sr ) );
+	_dst = MM_ALLOC( sampleFrame, dst_frames );
+	memset( _dst, 0, dst_frames * BYTES_PER_FRAME );
 
 	// yeah, libsamplerate, let's rock with sinc-interpolation!
 	int error;
@@ -1197,9 +1488,9 @@ SampleBuffer * SampleBuffer::resample( const sample_rate_t _src_sr,
 	{
 		SRC_DATA src_data;
 		src_data.end_of_input = 1;
-		src_data.data_in = data[0];
-		src_data.data_out = dst_buf[0];
-		src_data.input_frames = frames;
+		src_data.data_in = _src[0];
+		src_data.data_out = _dst[0];
+		src_data.input_frames = _frames;
 		src_data.output_frames = dst_frames;
 		src_data.src_ratio = (double) _dst_sr / _src_sr;
 		if( ( error = src_process( state, &src_data ) ) )
@@ -1213,8 +1504,7 @@ SampleBuffer * SampleBuffer::resample( const sample_rate_t _src_sr,
 	{
 		printf( "Error: src_new() failed in sample_buffer.cpp!\n" );
 	}
-	dst_sb->update();
-	return dst_sb;
+	return dst_frames;
 }
 
 
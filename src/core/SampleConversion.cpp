@@ -0,0 +1,351 @@
+/*
+ * SampleConversion.cpp - conversion of rendered audio into the sample formats
+ *                        of audio devices and file encoders
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleConversion.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QtCore/QtGlobal>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "ConfigManager.h"
+
+
+namespace SampleConversion
+{
+
+// full scale values, chosen so that converting 1.0f doesn't overflow
+static const float S16Max = 32767.0f;
+static const float S24Max = 8388607.0f;
+static const float S32Max = 2147483520.0f;
+
+
+
+Ditherer::Ditherer( DitherModes mode ) :
+	m_mode( mode ),
+	m_seed( 22222 )
+{
+	memset( m_error, 0, sizeof( m_error ) );
+}
+
+
+
+
+void Ditherer::setMode( DitherModes mode )
+{
+	m_mode = mode;
+	memset( m_error, 0, sizeof( m_error ) );
+}
+
+
+
+
+DitherModes Ditherer::configuredMode()
+{
+	const QString mode = ConfigManager::inst()->value( "mixer", "dither" );
+	if( mode == "triangular" )
+	{
+		return TriangularDither;
+	}
+	else if( mode == "shaped" )
+	{
+		return NoiseShapedDither;
+	}
+	return NoDither;
+}
+
+
+
+
+float Ditherer::quantize( ch_cnt_t chnl, float value, float max )
+{
+	float * error = m_error[chnl];
+
+	// subtracting the filtered error of the last samples makes the
+	// total error e[n] - 2 e[n-1] + e[n-2], i.e. highpass shaped
+	const float wanted = m_mode == NoiseShapedDither ?
+			value - ( 2.0f * error[0] - error[1] ) : value;
+	const float out = qBound( -max,
+				floorf( wanted + noise() + 0.5f ), max );
+
+	// bound the error so clipping can't make the shaping run away
+	error[1] = error[0];
+	error[0] = qBound( -1.0f, out - wanted, 1.0f );
+
+	return out;
+}
+
+
+
+
+float Ditherer::noise()
+{
+	if( m_mode == NoDither )
+	{
+		return 0.0f;
+	}
+
+	// sum of two uniform random values in [0, 1) from a LCG
+	m_seed = m_seed * 1664525 + 1013904223;
+	const float r1 = ( m_seed >> 8 ) * ( 1.0f / 16777216.0f );
+	m_seed = m_seed * 1664525 + 1013904223;
+	const float r2 = ( m_seed >> 8 ) * ( 1.0f / 16777216.0f );
+
+	return r1 + r2 - 1.0f;
+}
+
+
+
+
+//! Convert each channel of each frame with given operation, for the cases
+//! the vectorized loops don't cover
+template<typename T, typename OP>
+static inline void convertFrames( const surroundSampleFrame * src, int frames,
+					ch_cnt_t channels, T * dst, const OP & op )
+{
+	for( int frame = 0; frame < frames; ++frame )
+	{
+		for( ch_cnt_t chnl = 0; chnl < channels; ++chnl )
+		{
+			*dst++ = op( src[frame][chnl], chnl );
+		}
+	}
+}
+
+
+
+
+#ifdef __SSE2__
+static inline __m128 scaleAndClip( const float * in, __m128 gain, __m128 max )
+{
+	const __m128 v = _mm_mul_ps( _mm_loadu_ps( in ), gain );
+	return _mm_mul_ps( _mm_min_ps( _mm_max_ps( v, _mm_set1_ps( -1.0f ) ),
+					_mm_set1_ps( 1.0f ) ), max );
+}
+
+
+
+
+//! Convert as many samples as possible four or eight at a time, returns the
+//! number of samples converted
+static inline int convertBlock( const float * in, int samples, float gain,
+						float max, int16_t * dst )
+{
+	const __m128 g = _mm_set1_ps( gain );
+	const __m128 m = _mm_set1_ps( max );
+	int i = 0;
+	for( ; i + 8 <= samples; i += 8 )
+	{
+		const __m128i a = _mm_cvttps_epi32( scaleAndClip( in + i, g, m ) );
+		const __m128i b = _mm_cvttps_epi32( scaleAndClip( in + i + 4, g, m ) );
+		_mm_storeu_si128( (__m128i *)( dst + i ), _mm_packs_epi32( a, b ) );
+	}
+	return i;
+}
+
+
+
+
+static inline int convertBlock( const float * in, int samples, float gain,
+						float max, int32_t * dst )
+{
+	const __m128 g = _mm_set1_ps( gain );
+	const __m128 m = _mm_set1_ps( max );
+	int i = 0;
+	for( ; i + 4 <= samples; i += 4 )
+	{
+		_mm_storeu_si128( (__m128i *)( dst + i ),
+			_mm_cvttps_epi32( scaleAndClip( in + i, g, m ) ) );
+	}
+	return i;
+}
+#endif
+
+
+
+
+//! Scale and clip to an integer range, truncating like a plain cast
+template<typename T>
+static inline void toInt( const surroundSampleFrame * src, int frames,
+					ch_cnt_t channels, float gain, float max,
+					T * dst, Ditherer * ditherer )
+{
+	if( ditherer && ditherer->mode() != NoDither )
+	{
+		convertFrames( src, frames, channels, dst,
+			[gain, max, ditherer]( sample_t s, ch_cnt_t chnl )
+			{
+				return static_cast<T>( ditherer->quantize( chnl,
+						qBound( -1.0f, s * gain, 1.0f ) *
+								max, max ) );
+			} );
+		return;
+	}
+
+	if( channels != SURROUND_CHANNELS )
+	{
+		convertFrames( src, frames, channels, dst,
+			[gain, max]( sample_t s, ch_cnt_t )
+			{
+				return static_cast<T>(
+					qBound( -1.0f, s * gain, 1.0f ) * max );
+			} );
+		return;
+	}
+
+	// frames are contiguous, convert them as one block of samples
+	const int samples = frames * channels;
+	const sample_t * in = src[0];
+	int i = 0;
+#ifdef __SSE2__
+	i = convertBlock( in, samples, gain, max, dst );
+#endif
+	for( ; i < samples; ++i )
+	{
+		dst[i] = static_cast<T>(
+				qBound( -1.0f, in[i] * gain, 1.0f ) * max );
+	}
+}
+
+
+
+
+void toFloat( const surroundSampleFrame * src, int frames, ch_cnt_t channels,
+					float gain, float * dst, bool clip )
+{
+	if( channels != SURROUND_CHANNELS )
+	{
+		convertFrames( src, frames, channels, dst,
+			[gain, clip]( sample_t s, ch_cnt_t )
+			{
+				return clip ? qBound( -1.0f, s * gain, 1.0f ) :
+								s * gain;
+			} );
+		return;
+	}
+
+	const int samples = frames * channels;
+	const sample_t * in = src[0];
+	int i = 0;
+#ifdef __SSE2__
+	const __m128 g = _mm_set1_ps( gain );
+	if( clip )
+	{
+		for( ; i + 4 <= samples; i += 4 )
+		{
+			_mm_storeu_ps( dst + i, scaleAndClip( in + i, g,
+						_mm_set1_ps( 1.0f ) ) );
+		}
+	}
+	else
+	{
+		for( ; i + 4 <= samples; i += 4 )
+		{
+			_mm_storeu_ps( dst + i,
+				_mm_mul_ps( _mm_loadu_ps( in + i ), g ) );
+		}
+	}
+#endif
+	for( ; i < samples; ++i )
+	{
+		dst[i] = clip ? qBound( -1.0f, in[i] * gain, 1.0f ) :
+								in[i] * gain;
+	}
+}
+
+
+
+
+void toPlanarFloat( const surroundSampleFrame * src, int frames,
+				ch_cnt_t channels, float gain,
+				float * const * dst, int offset )
+{
+	for( ch_cnt_t chnl = 0; chnl < channels; ++chnl )
+	{
+		float * out = dst[chnl] + offset;
+		for( int frame = 0; frame < frames; ++frame )
+		{
+			out[frame] = src[frame][chnl] * gain;
+		}
+	}
+}
+
+
+
+
+void toS16( const surroundSampleFrame * src, int frames, ch_cnt_t channels,
+				float gain, int16_t * dst, bool swap,
+				Ditherer * ditherer )
+{
+	toInt( src, frames, channels, gain, S16Max, dst, ditherer );
+	if( swap )
+	{
+		swapEndian( dst, frames * channels );
+	}
+}
+
+
+
+
+void toS24( const surroundSampleFrame * src, int frames, ch_cnt_t channels,
+				float gain, int32_t * dst, Ditherer * ditherer )
+{
+	toInt( src, frames, channels, gain, S24Max, dst, ditherer );
+}
+
+
+
+
+void toS32( const surroundSampleFrame * src, int frames, ch_cnt_t channels,
+						float gain, int32_t * dst )
+{
+	toInt<int32_t>( src, frames, channels, gain, S32Max, dst, nullptr );
+}
+
+
+
+
+void swapEndian( int16_t * buf, int samples )
+{
+	int i = 0;
+#ifdef __SSE2__
+	for( ; i + 8 <= samples; i += 8 )
+	{
+		const __m128i v = _mm_loadu_si128( (__m128i *)( buf + i ) );
+		_mm_storeu_si128( (__m128i *)( buf + i ),
+			_mm_or_si128( _mm_slli_epi16( v, 8 ),
+						_mm_srli_epi16( v, 8 ) ) );
+	}
+#endif
+	for( ; i < samples; ++i )
+	{
+		const uint16_t s = buf[i];
+		buf[i] = static_cast<int16_t>( ( s << 8 ) | ( s >> 8 ) );
+	}
+}
+
+}
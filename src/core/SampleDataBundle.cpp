@@ -0,0 +1,180 @@
+/*
+ * SampleDataBundle.cpp - side-car file holding sample data of a project
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleDataBundle.h"
+
+#include <cstring>
+
+#include <QtCore/QtEndian>
+
+#include "endian_handling.h"
+
+
+const char SampleDataBundle::Magic[8] = { 'L', 'M', 'M', 'S', 'D', 'A', 'T', 'A' };
+
+
+
+
+SampleDataBundle::SampleDataBundle() :
+	m_chunks(),
+	m_writeOffset( PageSize ),
+	m_file(),
+	m_map( NULL ),
+	m_mapSize( 0 )
+{
+}
+
+
+
+
+SampleDataBundle::~SampleDataBundle()
+{
+	if( m_map )
+	{
+		m_file.unmap( const_cast<uchar *>( m_map ) );
+	}
+}
+
+
+
+
+QString SampleDataBundle::fileNameFor( const QString & projectFile )
+{
+	return projectFile + ".data";
+}
+
+
+
+
+qint64 SampleDataBundle::add( const sampleFrame * data, f_cnt_t frames )
+{
+	QByteArray chunk( reinterpret_cast<const char *>( data ),
+						frames * sizeof( sampleFrame ) );
+	if( !isLittleEndian() )
+	{
+		quint32 * words = reinterpret_cast<quint32 *>( chunk.data() );
+		for( int i = 0; i < chunk.size() / 4; ++i )
+		{
+			words[i] = qToLittleEndian( words[i] );
+		}
+	}
+
+	const qint64 offset = m_writeOffset;
+	m_writeOffset += ( chunk.size() + PageSize - 1 ) / PageSize * PageSize;
+	m_chunks.append( chunk );
+	return offset;
+}
+
+
+
+
+bool SampleDataBundle::writeFile( const QString & fileName ) const
+{
+	const QString tempName = fileName + ".new";
+	QFile out( tempName );
+	if( !out.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+	{
+		return false;
+	}
+
+	QByteArray header( PageSize, 0 );
+	memcpy( header.data(), Magic, sizeof( Magic ) );
+	qToLittleEndian<quint32>( Version,
+			reinterpret_cast<uchar *>( header.data() ) + sizeof( Magic ) );
+	bool ok = out.write( header ) == header.size();
+
+	const QByteArray padding( PageSize, 0 );
+	for( const QByteArray & chunk : m_chunks )
+	{
+		ok = ok && out.write( chunk ) == chunk.size();
+		const qint64 rest = chunk.size() % PageSize;
+		if( rest )
+		{
+			ok = ok && out.write( padding.constData(), PageSize - rest ) ==
+							PageSize - rest;
+		}
+	}
+	out.close();
+
+	if( !ok )
+	{
+		QFile::remove( tempName );
+		return false;
+	}
+
+	QFile::remove( fileName );
+	return QFile::rename( tempName, fileName );
+}
+
+
+
+
+bool SampleDataBundle::open( const QString & fileName )
+{
+	m_file.setFileName( fileName );
+	if( !m_file.open( QIODevice::ReadOnly ) || m_file.size() < PageSize )
+	{
+		return false;
+	}
+
+	m_mapSize = m_file.size();
+	m_map = m_file.map( 0, m_mapSize );
+	if( m_map == NULL )
+	{
+		return false;
+	}
+
+	if( memcmp( m_map, Magic, sizeof( Magic ) ) != 0 ||
+		qFromLittleEndian<quint32>( m_map + sizeof( Magic ) ) > Version )
+	{
+		m_file.unmap( const_cast<uchar *>( m_map ) );
+		m_map = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+
+
+
+bool SampleDataBundle::read( qint64 offset, f_cnt_t frames,
+						sampleFrame * dst ) const
+{
+	const qint64 size = static_cast<qint64>( frames ) * sizeof( sampleFrame );
+	if( !isOpen() || offset < PageSize || offset % PageSize ||
+						frames < 0 || offset + size > m_mapSize )
+	{
+		return false;
+	}
+
+	memcpy( dst, m_map + offset, size );
+	if( !isLittleEndian() )
+	{
+		quint32 * words = reinterpret_cast<quint32 *>( dst );
+		for( qint64 i = 0; i < size / 4; ++i )
+		{
+			words[i] = qFromLittleEndian( words[i] );
+		}
+	}
+	return true;
+}
@@ -0,0 +1,207 @@
+/*
+ * SamplePeakCache.cpp - multi-resolution min/max/RMS summary of sample data
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SamplePeakCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtCore/QThread>
+#include <QtCore/QtGlobal>
+
+
+float SamplePeakCache::Peak::rms() const
+{
+	return sqrtf( meanSquare );
+}
+
+
+
+
+SamplePeakCache::SamplePeakCache() :
+	m_frames( 0 ),
+	m_valid( false )
+{
+}
+
+
+
+
+void SamplePeakCache::clear()
+{
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		m_levels[ch].clear();
+	}
+	m_frames = 0;
+	m_valid = false;
+}
+
+
+
+
+void SamplePeakCache::build( const sampleFrame * data, f_cnt_t frames )
+{
+	clear();
+	m_frames = frames;
+	m_valid = true;
+	if( data == NULL || frames <= 0 )
+	{
+		return;
+	}
+
+	const f_cnt_t blocks = ( frames + BaseBlockSize - 1 ) / BaseBlockSize;
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		m_levels[ch].push_back( Level( blocks ) );
+	}
+
+	for( f_cnt_t b = 0; b < blocks; ++b )
+	{
+		// building may run on a thread of its own, which is asked to
+		// stop early if the data is about to go away
+		if( b % 1024 == 0 &&
+			QThread::currentThread()->isInterruptionRequested() )
+		{
+			clear();
+			return;
+		}
+
+		const f_cnt_t start = b * BaseBlockSize;
+		const f_cnt_t end = qMin( start + BaseBlockSize, frames );
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			Peak p = { data[start][ch], data[start][ch], 0.0f };
+			for( f_cnt_t f = start; f < end; ++f )
+			{
+				const sample_t s = data[f][ch];
+				p.min = qMin( p.min, s );
+				p.max = qMax( p.max, s );
+				p.meanSquare += s * s;
+			}
+			p.meanSquare /= end - start;
+			m_levels[ch][0][b] = p;
+		}
+	}
+
+	// build coarser levels until a single entry covers everything
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		while( m_levels[ch].back().size() > 1 )
+		{
+			const size_t level = m_levels[ch].size() - 1;
+			const Level & fine = m_levels[ch].back();
+			Level coarse( ( fine.size() + 1 ) / 2 );
+			for( size_t i = 0; i < coarse.size(); ++i )
+			{
+				coarse[i] = 2 * i + 1 < fine.size() ?
+					merge( fine[2 * i], blockFrames( level, 2 * i ),
+						fine[2 * i + 1],
+						blockFrames( level, 2 * i + 1 ) ) :
+					fine[2 * i];
+			}
+			m_levels[ch].push_back( coarse );
+		}
+	}
+}
+
+
+
+
+SamplePeakCache::Peak SamplePeakCache::query( const sampleFrame * data,
+				f_cnt_t from, f_cnt_t to, ch_cnt_t ch ) const
+{
+	if( m_frames == 0 )
+	{
+		Peak p = { 0.0f, 0.0f, 0.0f };
+		return p;
+	}
+
+	from = qBound<f_cnt_t>( 0, from, m_frames - 1 );
+	to = qBound<f_cnt_t>( from + 1, to, m_frames );
+
+	if( !m_valid || m_levels[ch].empty() || to - from < BaseBlockSize )
+	{
+		Peak p = { data[from][ch], data[from][ch], 0.0f };
+		for( f_cnt_t f = from; f < to; ++f )
+		{
+			const sample_t s = data[f][ch];
+			p.min = qMin( p.min, s );
+			p.max = qMax( p.max, s );
+			p.meanSquare += s * s;
+		}
+		p.meanSquare /= to - from;
+		return p;
+	}
+
+	// pick the coarsest level whose blocks are at most half the range, so
+	// snapping to the block grid never widens the range by more than that
+	size_t level = 0;
+	f_cnt_t blockSize = BaseBlockSize;
+	while( level + 1 < m_levels[ch].size() && blockSize * 4 <= to - from )
+	{
+		++level;
+		blockSize *= 2;
+	}
+
+	const Level & l = m_levels[ch][level];
+	const size_t first = from / blockSize;
+	const size_t last = qMin<size_t>( ( to - 1 ) / blockSize, l.size() - 1 );
+	Peak p = l[first];
+	f_cnt_t frames = blockFrames( level, first );
+	p.meanSquare *= frames;
+	for( size_t i = first + 1; i <= last; ++i )
+	{
+		// the last block may be shorter than the others
+		const f_cnt_t blockLength = blockFrames( level, i );
+		p.min = qMin( p.min, l[i].min );
+		p.max = qMax( p.max, l[i].max );
+		p.meanSquare += l[i].meanSquare * blockLength;
+		frames += blockLength;
+	}
+	p.meanSquare /= frames;
+	return p;
+}
+
+
+
+
+f_cnt_t SamplePeakCache::blockFrames( size_t level, size_t block ) const
+{
+	const f_cnt_t blockSize = BaseBlockSize << level;
+	return qMin<f_cnt_t>( blockSize,
+			m_frames - static_cast<f_cnt_t>( block ) * blockSize );
+}
+
+
+
+
+SamplePeakCache::Peak SamplePeakCache::merge( const Peak & a, f_cnt_t aFrames,
+						const Peak & b, f_cnt_t bFrames )
+{
+	Peak p;
+	p.min = qMin( a.min, b.min );
+	p.max = qMax( a.max, b.max );
+	p.meanSquare = ( a.meanSquare * aFrames + b.meanSquare * bFrames ) /
+							( aFrames + bFrames );
+	return p;
+}
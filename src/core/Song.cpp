@@ -50,6 +50,7 @@
 #include "PianoRoll.h"
 #include "ProjectJournal.h"
 #include "ProjectNotes.h"
+#include "SampleDataBundle.h"
 #include "SongEditor.h"
 #include "TimeLineWidget.h"
 #include "PeakController.h"
@@ -80,6 +81,7 @@ Song::Song() :
 	m_playing( false ),
 	m_paused( false ),
 	m_loadingProject( false ),
+	m_sampleDataBundle( NULL ),
 	m_isCancelled( false ),
 	m_playMode( Mode_None ),
 	m_length( 0 ),
@@ -1031,7 +1033,7 @@ void Song::createNewProjectFromTemplate( const QString & templ )
 
 
 // load given song
-void Song::loadProject( const QString & fileName )
+bool Song::loadProject( const QString & fileName )
 {
 	QDomNode node;
 
@@ -1052,7 +1054,8 @@ void Song::loadProject( const QString & fileName )
 			createNewProject();
 		}
 		setProjectFileName(m_oldFileName);
-		return;
+		m_loadingProject = false;
+		return false;
 	}
 
 	m_oldFileName = m_fileName;
@@ -1061,6 +1064,13 @@ void Song::loadProject( const QString & fileName )
 
 	clearErrors();
 
+	// embedded samples may be stored in a separate file
+	SampleDataBundle sampleDataBundle;
+	if( sampleDataBundle.open( SampleDataBundle::fileNameFor( m_fileName ) ) )
+	{
+		m_sampleDataBundle = &sampleDataBundle;
+	}
+
 	Engine::mixer()->requestChangeInModel();
 
 	// get the header information from the DOM
@@ -1173,6 +1183,7 @@ void Song::loadProject( const QString & fileName )
 	// resolve all IDs so that autoModels are automated
 	AutomationPattern::resolveAllIDs();
 
+	m_sampleDataBundle = NULL;
 
 	Engine::mixer()->doneChangeInModel();
 
@@ -1186,7 +1197,7 @@ void Song::loadProject( const QString & fileName )
 	{
 		m_isCancelled = false;
 		createNewProject();
-		return;
+		return false;
 	}
 
 	if ( hasErrors())
@@ -1205,6 +1216,8 @@ void Song::loadProject( const QString & fileName )
 	m_loadingProject = false;
 	setModified(false);
 	m_loadOnLaunch = false;
+
+	return true;
 }
 
 
@@ -1214,6 +1227,12 @@ bool Song::saveProjectFile( const QString & filename )
 	DataFile dataFile( DataFile::SongProject );
 	m_savingProject = true;
 
+	SampleDataBundle sampleDataBundle;
+	if( ConfigManager::inst()->value( "app", "samplebundle" ).toInt() )
+	{
+		m_sampleDataBundle = &sampleDataBundle;
+	}
+
 	m_tempoModel.saveSettings( dataFile, dataFile.head(), "bpm" );
 	m_timeSigModel.saveSettings( dataFile, dataFile.head(), "timesig" );
 	m_masterVolumeModel.saveSettings( dataFile, dataFile.head(), "mastervol" );
@@ -1235,6 +1254,13 @@ bool Song::saveProjectFile( const QString & filename )
 	saveControllerStates( dataFile, dataFile.content() );
 
 	m_savingProject = false;
+	m_sampleDataBundle = NULL;
+
+	if( !sampleDataBundle.isEmpty() && !sampleDataBundle.writeFile(
+		SampleDataBundle::fileNameFor( dataFile.nameWithExtension( filename ) ) ) )
+	{
+		return false;
+	}
 
 	return dataFile.writeFile( filename );
 }
@@ -2034,6 +2034,18 @@ void TrackOperationsWidget::updateMenu()
 	{
 		toMenu->addSeparator();
 		toMenu->addMenu(trackView->midiMenu());
+		if( trackView->model()->isFrozen() )
+		{
+			toMenu->addAction( tr( "Unfreeze this track" ),
+					trackView->model(), SLOT( unfreeze() ) );
+		}
+		else
+		{
+			// a muted track would render silence
+			toMenu->addAction( tr( "Freeze this track" ), trackView,
+				SLOT( freezeTrack() ) )->setEnabled(
+					!trackView->model()->isMuted() );
+		}
 	}
 	if( dynamic_cast<AutomationTrackView *>( m_trackView ) )
 	{
@@ -36,6 +36,24 @@
 #include "gui_templates.h"
 
 
+static snd_pcm_format_t formatFromName( const QString & _name )
+{
+	if( _name == "float" )
+	{
+		return SND_PCM_FORMAT_FLOAT;
+	}
+	else if( _name == "s32" )
+	{
+		return SND_PCM_FORMAT_S32;
+	}
+	else if( _name == "s24" )
+	{
+		return SND_PCM_FORMAT_S24;
+	}
+	return SND_PCM_FORMAT_S16;
+}
+
+
 AudioAlsa::AudioAlsa( bool & _success_ful, Mixer*  _mixer ) :
 	AudioDevice( qBound<ch_cnt_t>(
 		DEFAULT_CHANNELS,
@@ -44,7 +62,10 @@ AudioAlsa::AudioAlsa( bool & _success_ful, Mixer*  _mixer ) :
 	m_handle( NULL ),
 	m_hwParams( NULL ),
 	m_swParams( NULL ),
-	m_convertEndian( false )
+	m_convertEndian( false ),
+	m_format( SND_PCM_FORMAT_S16 ),
+	m_mmap( false ),
+	m_frameBytes( 0 )
 {
 	_success_ful = false;
 
@@ -68,8 +89,7 @@ AudioAlsa::AudioAlsa( bool & _success_ful, Mixer*  _mixer ) :
 	snd_pcm_hw_params_malloc( &m_hwParams );
 	snd_pcm_sw_params_malloc( &m_swParams );
 
-	if( ( err = setHWParams( channels(),
-					SND_PCM_ACCESS_RW_INTERLEAVED ) ) < 0 )
+	if( ( err = setHWParams( channels() ) ) < 0 )
 	{
 		printf( "Setting of hwparams failed: %s\n",
 							snd_strerror( err ) );
@@ -273,8 +293,7 @@ void AudioAlsa::applyQualitySettings()
 			return;
 		}
 
-		if( ( err = setHWParams( channels(),
-					SND_PCM_ACCESS_RW_INTERLEAVED ) ) < 0 )
+		if( ( err = setHWParams( channels() ) ) < 0 )
 		{
 			printf( "Setting of hwparams failed: %s\n",
 							snd_strerror( err ) );
@@ -298,84 +317,195 @@ void AudioAlsa::run()
 {
 	surroundSampleFrame * temp =
 		new surroundSampleFrame[mixer()->framesPerPeriod()];
-	int_sample_t * outbuf =
-			new int_sample_t[mixer()->framesPerPeriod() *
-								channels()];
-	int_sample_t * pcmbuf = new int_sample_t[m_periodSize * channels()];
+	// not needed when converting straight into the device's buffer
+	char * outbuf = m_mmap ? NULL :
+		new char[mixer()->framesPerPeriod() * m_frameBytes];
+
+	while( true )
+	{
+		// frames depend on the sample rate
+		const fpp_t frames = getNextBuffer( temp );
+		if( !frames )
+		{
+			break;
+		}
+
+		if( m_mmap )
+		{
+			writeMmap( temp, frames, mixer()->masterGain() );
+		}
+		else
+		{
+			convertBuffer( temp, frames, mixer()->masterGain(),
+									outbuf );
+			writeInterleaved( outbuf, frames );
+		}
+	}
+
+	delete[] temp;
+	delete[] outbuf;
+}
+
+
+
+
+void AudioAlsa::convertBuffer( const surroundSampleFrame * _ab,
+						const fpp_t _frames,
+						const float _master_gain,
+						void * _dst )
+{
+	switch( m_format )
+	{
+		case SND_PCM_FORMAT_FLOAT:
+			SampleConversion::toFloat( _ab, _frames, channels(),
+					_master_gain,
+					static_cast<float *>( _dst ), true );
+			break;
+
+		case SND_PCM_FORMAT_S32:
+			SampleConversion::toS32( _ab, _frames, channels(),
+					_master_gain,
+					static_cast<int32_t *>( _dst ) );
+			break;
+
+		case SND_PCM_FORMAT_S24:
+			SampleConversion::toS24( _ab, _frames, channels(),
+					_master_gain,
+					static_cast<int32_t *>( _dst ),
+								ditherer() );
+			break;
+
+		default:
+			convertToS16( _ab, _frames, _master_gain,
+					static_cast<int_sample_t *>( _dst ),
+							m_convertEndian );
+			break;
+	}
+}
+
+
+
+
+void AudioAlsa::writeInterleaved( const char * _buf, const fpp_t _frames )
+{
+	const char * ptr = _buf;
+	f_cnt_t frames = _frames;
+
+	while( frames )
+	{
+		int err = snd_pcm_writei( m_handle, ptr, frames );
+
+		if( err == -EAGAIN )
+		{
+			continue;
+		}
+
+		if( err < 0 )
+		{
+			if( handleError( err ) < 0 )
+			{
+				printf( "Write error: %s\n",
+						snd_strerror( err ) );
+			}
+			break;	// skip this buffer
+		}
+		ptr += err * m_frameBytes;
+		frames -= err;
+	}
+}
 
-	int outbuf_size = mixer()->framesPerPeriod() * channels();
-	int outbuf_pos = 0;
-	int pcmbuf_size = m_periodSize * channels();
 
-	bool quit = false;
-	while( quit == false )
+
+
+void AudioAlsa::writeMmap( const surroundSampleFrame * _ab,
+						const fpp_t _frames,
+						const float _master_gain )
+{
+	fpp_t done = 0;
+
+	while( done < _frames )
 	{
-		int_sample_t * ptr = pcmbuf;
-		int len = pcmbuf_size;
-		while( len )
+		int err = snd_pcm_avail_update( m_handle );
+		if( err == 0 )
+		{
+			// wait until the device made room in its buffer
+			err = snd_pcm_wait( m_handle, 1000 );
+			if( err >= 0 )
+			{
+				continue;
+			}
+		}
+		if( err < 0 )
 		{
-			if( outbuf_pos == 0 )
+			if( handleError( err ) < 0 )
 			{
-				// frames depend on the sample rate
-				const fpp_t frames = getNextBuffer( temp );
-				if( !frames )
-				{
-					quit = true;
-					memset( ptr, 0, len
-						* sizeof( int_sample_t ) );
-					break;
-				}
-				outbuf_size = frames * channels();
-
-				convertToS16( temp, frames,
-						mixer()->masterGain(),
-						outbuf,
-						m_convertEndian );
+				printf( "Write error: %s\n",
+						snd_strerror( err ) );
+				return;	// skip this buffer
 			}
-			int min_len = qMin( len, outbuf_size - outbuf_pos );
-			memcpy( ptr, outbuf + outbuf_pos,
-					min_len * sizeof( int_sample_t ) );
-			ptr += min_len;
-			len -= min_len;
-			outbuf_pos += min_len;
-			outbuf_pos %= outbuf_size;
+			continue;
 		}
 
-		f_cnt_t frames = m_periodSize;
-		ptr = pcmbuf;
+		const snd_pcm_channel_area_t * areas;
+		snd_pcm_uframes_t offset;
+		snd_pcm_uframes_t frames = qMin<snd_pcm_uframes_t>( err,
+							_frames - done );
 
-		while( frames )
+		if( ( err = snd_pcm_mmap_begin( m_handle, &areas, &offset,
+							&frames ) ) < 0 )
 		{
-			int err = snd_pcm_writei( m_handle, ptr, frames );
+			if( handleError( err ) < 0 )
+			{
+				printf( "Write error: %s\n",
+						snd_strerror( err ) );
+				return;
+			}
+			continue;
+		}
+
+		// all channels are interleaved in the first area
+		convertBuffer( _ab + done, frames, _master_gain,
+				static_cast<char *>( areas[0].addr ) +
+					( areas[0].first +
+						offset * areas[0].step ) / 8 );
 
-			if( err == -EAGAIN )
+		err = snd_pcm_mmap_commit( m_handle, offset, frames );
+		if( err < 0 || static_cast<snd_pcm_uframes_t>( err ) != frames )
+		{
+			if( handleError( err < 0 ? err : -EPIPE ) < 0 )
 			{
-				continue;
+				printf( "Write error: %s\n",
+						snd_strerror( err ) );
+				return;
 			}
+		}
+		done += frames;
 
-			if( err < 0 )
+		// committing mmap'ed frames doesn't start the stream, so start
+		// it ourselves once as much data is queued as the start
+		// threshold asks for - starting earlier would run into an
+		// underrun right away
+		if( snd_pcm_state( m_handle ) == SND_PCM_STATE_PREPARED )
+		{
+			snd_pcm_uframes_t threshold = m_periodSize;
+			snd_pcm_sw_params_get_start_threshold( m_swParams,
+								&threshold );
+			const snd_pcm_sframes_t avail =
+					snd_pcm_avail_update( m_handle );
+			if( avail >= 0 && m_bufferSize -
+				static_cast<snd_pcm_uframes_t>( avail ) >=
+					qMin( threshold, m_bufferSize ) )
 			{
-				if( handleError( err ) < 0 )
-				{
-					printf( "Write error: %s\n",
-							snd_strerror( err ) );
-				}
-				break;	// skip this buffer
+				snd_pcm_start( m_handle );
 			}
-			ptr += err * channels();
-			frames -= err;
 		}
 	}
-
-	delete[] temp;
-	delete[] outbuf;
-	delete[] pcmbuf;
 }
 
 
 
 
-int AudioAlsa::setHWParams( const ch_cnt_t _channels, snd_pcm_access_t _access )
+int AudioAlsa::setHWParams( const ch_cnt_t _channels )
 {
 	int err, dir;
 
@@ -387,32 +517,49 @@ int AudioAlsa::setHWParams( const ch_cnt_t _channels, snd_pcm_access_t _access )
 		return err;
 	}
 
-	// set the interleaved read/write format
-	if( ( err = snd_pcm_hw_params_set_access( m_handle, m_hwParams,
-							_access ) ) < 0 )
+	// prefer converting straight into the device's buffer, otherwise
+	// use the interleaved read/write format
+	m_mmap = ConfigManager::inst()->value( "audioalsa", "mmap", "1" ).toInt() &&
+		snd_pcm_hw_params_set_access( m_handle, m_hwParams,
+				SND_PCM_ACCESS_MMAP_INTERLEAVED ) >= 0;
+	if( !m_mmap && ( err = snd_pcm_hw_params_set_access( m_handle,
+			m_hwParams, SND_PCM_ACCESS_RW_INTERLEAVED ) ) < 0 )
 	{
 		printf( "Access type not available for playback: %s\n",
 							snd_strerror( err ) );
 		return err;
 	}
 
-	// set the sample format
-	if( ( snd_pcm_hw_params_set_format( m_handle, m_hwParams,
-						SND_PCM_FORMAT_S16_LE ) ) < 0 )
+	// set the sample format, fall back to 16 bit if the configured
+	// one isn't supported
+	m_format = formatFromName( ConfigManager::inst()->value(
+						"audioalsa", "format" ) );
+	m_convertEndian = false;
+	if( m_format == SND_PCM_FORMAT_S16 ||
+		snd_pcm_hw_params_set_format( m_handle, m_hwParams,
+							m_format ) < 0 )
 	{
-		if( ( snd_pcm_hw_params_set_format( m_handle, m_hwParams,
-						SND_PCM_FORMAT_S16_BE ) ) < 0 )
+		if( snd_pcm_hw_params_set_format( m_handle, m_hwParams,
+						SND_PCM_FORMAT_S16_LE ) >= 0 )
+		{
+			m_format = SND_PCM_FORMAT_S16_LE;
+			m_convertEndian = !isLittleEndian();
+		}
+		else if( ( err = snd_pcm_hw_params_set_format( m_handle,
+				m_hwParams, SND_PCM_FORMAT_S16_BE ) ) >= 0 )
+		{
+			m_format = SND_PCM_FORMAT_S16_BE;
+			m_convertEndian = isLittleEndian();
+		}
+		else
 		{
 			printf( "Neither little- nor big-endian available for "
 					"playback: %s\n", snd_strerror( err ) );
 			return err;
 		}
-		m_convertEndian = isLittleEndian();
-	}
-	else
-	{
-		m_convertEndian = !isLittleEndian();
 	}
+	m_frameBytes = _channels *
+			snd_pcm_format_physical_width( m_format ) / 8;
 
 	// set the count of channels
 	if( ( err = snd_pcm_hw_params_set_channels( m_handle, m_hwParams,
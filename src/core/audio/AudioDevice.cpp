@@ -36,7 +36,9 @@ AudioDevice::AudioDevice( const ch_cnt_t _channels, Mixer*  _mixer ) :
 	m_sampleRate( _mixer->processingSampleRate() ),
 	m_channels( _channels ),
 	m_mixer( _mixer ),
-	m_buffer( new surroundSampleFrame[mixer()->framesPerPeriod()] )
+	m_buffer( new surroundSampleFrame[mixer()->framesPerPeriod()] ),
+	m_bufferPoolIndex( -1 ),
+	m_ditherer( SampleConversion::Ditherer::configuredMode() )
 {
 	int error;
 	if( ( m_srcState = src_new(
@@ -67,7 +69,7 @@ void AudioDevice::processNextBuffer()
 	const fpp_t frames = getNextBuffer( m_buffer );
 	if( frames )
 	{
-		writeBuffer( m_buffer, frames, mixer()->masterGain() );
+		outputBuffer( m_buffer, frames, mixer()->masterGain() );
 	}
 	else
 	{
@@ -78,6 +80,34 @@ void AudioDevice::processNextBuffer()
 
 
 
+void AudioDevice::processBuffer( const surroundSampleFrame * _ab,
+							const fpp_t _frames )
+{
+	fpp_t frames = _frames;
+
+	lock();
+
+	// resample if necessary
+	if( mixer()->processingSampleRate() != m_sampleRate )
+	{
+		resample( _ab, _frames, m_buffer, mixer()->processingSampleRate(),
+								m_sampleRate );
+		frames = _frames * m_sampleRate /
+					mixer()->processingSampleRate();
+	}
+	else
+	{
+		memcpy( m_buffer, _ab, _frames * sizeof( surroundSampleFrame ) );
+	}
+
+	unlock();
+
+	outputBuffer( m_buffer, frames, mixer()->masterGain() );
+}
+
+
+
+
 fpp_t AudioDevice::getNextBuffer( surroundSampleFrame * _ab )
 {
 	fpp_t frames = mixer()->framesPerPeriod();
@@ -86,6 +116,7 @@ fpp_t AudioDevice::getNextBuffer( surroundSampleFrame * _ab )
 	{
 		return 0;
 	}
+	m_bufferPoolIndex = mixer()->bufferPoolIndex( b );
 
 	// make sure, no other thread is accessing device
 	lock();
@@ -106,11 +137,6 @@ fpp_t AudioDevice::getNextBuffer( surroundSampleFrame * _ab )
 	// release lock
 	unlock();
 
-	if( mixer()->hasFifoWriter() )
-	{
-		delete[] b;
-	}
-
 	return frames;
 }
 
@@ -216,35 +242,9 @@ int AudioDevice::convertToS16( const surroundSampleFrame * _ab,
 								int_sample_t * _output_buffer,
 								const bool _convert_endian )
 {
-	if( _convert_endian )
-	{
-		int_sample_t temp;
-		for( fpp_t frame = 0; frame < _frames; ++frame )
-		{
-			for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
-			{
-				temp = static_cast<int_sample_t>( Mixer::clip( _ab[frame][chnl] * _master_gain ) * OUTPUT_SAMPLE_MULTIPLIER );
-				
-				( _output_buffer + frame * channels() )[chnl] =
-						( temp & 0x00ff ) << 8 |
-						( temp & 0xff00 ) >> 8;
-			}
-		}
-	}
-	else
-	{
-		for( fpp_t frame = 0; frame < _frames; ++frame )
-		{
-			for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
-			{
-				( _output_buffer + frame * channels() )[chnl] =
-						static_cast<int_sample_t>(
-						Mixer::clip( _ab[frame][chnl] *
-						_master_gain ) *
-						OUTPUT_SAMPLE_MULTIPLIER );
-			}
-		}
-	}
+	SampleConversion::toS16( _ab, _frames, channels(), _master_gain,
+					_output_buffer, _convert_endian,
+							&m_ditherer );
 
 	return _frames * channels() * BYTES_PER_INT_SAMPLE;
 }
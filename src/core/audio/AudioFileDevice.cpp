@@ -25,6 +25,8 @@
 
 #include <QMessageBox>
 
+#include <cstring>
+
 #include "AudioFileDevice.h"
 #include "ExportProjectDialog.h"
 #include "GuiApplication.h"
@@ -36,7 +38,10 @@ AudioFileDevice::AudioFileDevice( OutputSettings const & outputSettings,
 					Mixer*  _mixer ) :
 	AudioDevice( _channels, _mixer ),
 	m_outputFile( _file ),
-	m_outputSettings(outputSettings)
+	m_outputSettings(outputSettings),
+	m_encoderThread( NULL ),
+	m_freeBuffers( EncoderQueueSize ),
+	m_queuedBuffers( EncoderQueueSize + 1 )
 {
 	setSampleRate( outputSettings.getSampleRate() );
 
@@ -71,12 +76,90 @@ AudioFileDevice::AudioFileDevice( OutputSettings const & outputSettings,
 
 AudioFileDevice::~AudioFileDevice()
 {
+	// writeBuffer() isn't available anymore here
+	Q_ASSERT( m_encoderThread == NULL );
 	m_outputFile.close();
 }
 
 
 
 
+void AudioFileDevice::startEncoderThread()
+{
+	if( m_encoderThread )
+	{
+		return;
+	}
+
+	const fpp_t frames = mixer()->framesPerPeriod();
+	for( int i = 0; i < EncoderQueueSize; ++i )
+	{
+		m_encoderBuffers[i].data = new surroundSampleFrame[frames];
+		m_freeBuffers.write( &m_encoderBuffers[i] );
+	}
+
+	m_encoderThread = new EncoderThread( this );
+	m_encoderThread->start();
+}
+
+
+
+
+void AudioFileDevice::stopEncoderThread()
+{
+	if( m_encoderThread == NULL )
+	{
+		return;
+	}
+
+	m_queuedBuffers.write( NULL );
+	m_encoderThread->wait();
+	delete m_encoderThread;
+	m_encoderThread = NULL;
+
+	for( int i = 0; i < EncoderQueueSize; ++i )
+	{
+		m_freeBuffers.read();
+		delete[] m_encoderBuffers[i].data;
+	}
+}
+
+
+
+
+void AudioFileDevice::outputBuffer( const surroundSampleFrame * _buf,
+						const fpp_t _frames,
+						const float _master_gain )
+{
+	if( m_encoderThread == NULL )
+	{
+		writeBuffer( _buf, _frames, _master_gain );
+		return;
+	}
+
+	// blocks if the encoder is lagging behind by EncoderQueueSize periods
+	EncoderBuffer * b = m_freeBuffers.read();
+	memcpy( b->data, _buf, _frames * sizeof( surroundSampleFrame ) );
+	b->frames = _frames;
+	b->masterGain = _master_gain;
+	m_queuedBuffers.write( b );
+}
+
+
+
+
+void AudioFileDevice::EncoderThread::run()
+{
+	while( EncoderBuffer * b = m_dev->m_queuedBuffers.read() )
+	{
+		m_dev->writeBuffer( b->data, b->frames, b->masterGain );
+		m_dev->m_freeBuffers.write( b );
+	}
+}
+
+
+
+
 int AudioFileDevice::writeData( const void* data, int len )
 {
 	if( m_outputFile.isOpen() )
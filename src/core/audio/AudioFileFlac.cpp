@@ -37,6 +37,7 @@ AudioFileFlac::AudioFileFlac(OutputSettings const& outputSettings, ch_cnt_t cons
 
 AudioFileFlac::~AudioFileFlac()
 {
+	stopEncoderThread();
 	finishEncoding();
 }
 
@@ -89,21 +90,15 @@ void AudioFileFlac::writeBuffer(surroundSampleFrame const* _ab, fpp_t const fram
 
 	if (depth == OutputSettings::Depth_24Bit || depth == OutputSettings::Depth_32Bit) // Float encoding
 	{
-		std::unique_ptr<sample_t[]> buf{ new sample_t[frames*channels()] };
-		for(fpp_t frame = 0; frame < frames; ++frame)
-		{
-			for(ch_cnt_t channel=0; channel<channels(); ++channel)
-			{
-				buf[frame*channels() + channel] = _ab[frame][channel] * master_gain;
-			}
-		}
-		sf_writef_float(m_sf,static_cast<float*>(buf.get()),frames);
+		float * buf = conversionBuffer<float>(frames);
+		SampleConversion::toFloat(_ab, frames, channels(), master_gain, buf);
+		sf_writef_float(m_sf, buf, frames);
 	}
 	else // integer PCM encoding
 	{
-		std::unique_ptr<int_sample_t[]> buf{ new int_sample_t[frames*channels()] };
-		convertToS16(_ab, frames, master_gain, buf.get(), !isLittleEndian());
-		sf_writef_short(m_sf, static_cast<short*>(buf.get()), frames);
+		int_sample_t * buf = conversionBuffer<int_sample_t>(frames);
+		convertToS16(_ab, frames, master_gain, buf, !isLittleEndian());
+		sf_writef_short(m_sf, static_cast<short*>(buf), frames);
 	}
 
 }
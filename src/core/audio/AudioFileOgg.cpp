@@ -52,6 +52,7 @@ AudioFileOgg::AudioFileOgg(	OutputSettings const & outputSettings,
 
 AudioFileOgg::~AudioFileOgg()
 {
+	stopEncoderThread();
 	finishEncoding();
 }
 
@@ -188,13 +189,8 @@ void AudioFileOgg::writeBuffer( const surroundSampleFrame * _ab,
 	float * * buffer = vorbis_analysis_buffer( &m_vd, _frames *
 							BYTES_PER_SAMPLE *
 								channels() );
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
-		{
-			buffer[chnl][frame] = _ab[frame][chnl] * _master_gain;
-		}
-	}
+	SampleConversion::toPlanarFloat( _ab, _frames, channels(),
+							_master_gain, buffer );
 
 	vorbis_analysis_wrote( &m_vd, _frames );
 
@@ -46,6 +46,7 @@ AudioFileWave::AudioFileWave( OutputSettings const & outputSettings,
 
 AudioFileWave::~AudioFileWave()
 {
+	stopEncoderThread();
 	finishEncoding();
 }
 
@@ -104,26 +105,18 @@ void AudioFileWave::writeBuffer( const surroundSampleFrame * _ab,
 
 	if( bitDepth == OutputSettings::Depth_32Bit || bitDepth == OutputSettings::Depth_24Bit )
 	{
-		float *  buf = new float[_frames*channels()];
-		for( fpp_t frame = 0; frame < _frames; ++frame )
-		{
-			for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
-			{
-				buf[frame*channels()+chnl] = _ab[frame][chnl] *
-								_master_gain;
-			}
-		}
+		float * buf = conversionBuffer<float>( _frames );
+		SampleConversion::toFloat( _ab, _frames, channels(),
+							_master_gain, buf );
 		sf_writef_float( m_sf, buf, _frames );
-		delete[] buf;
 	}
 	else
 	{
-		int_sample_t * buf = new int_sample_t[_frames * channels()];
+		int_sample_t * buf = conversionBuffer<int_sample_t>( _frames );
 		convertToS16( _ab, _frames, _master_gain, buf,
 							!isLittleEndian() );
 
 		sf_writef_short( m_sf, buf, _frames );
-		delete[] buf;
 	}
 }
 
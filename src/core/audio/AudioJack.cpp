@@ -53,7 +53,9 @@ AudioJack::AudioJack( bool & _success_ful, Mixer*  _mixer ) :
 	m_tempOutBufs( new jack_default_audio_sample_t *[channels()] ),
 	m_outBuf( new surroundSampleFrame[mixer()->framesPerPeriod()] ),
 	m_framesDoneInCurBuf( 0 ),
-	m_framesToDoInCurBuf( 0 )
+	m_framesToDoInCurBuf( 0 ),
+	m_trackPorts( ConfigManager::inst()->value( "audiojack",
+						"trackports" ).toInt() )
 {
 	_success_ful = initJackClient();
 	if( _success_ful )
@@ -71,12 +73,10 @@ AudioJack::AudioJack( bool & _success_ful, Mixer*  _mixer ) :
 AudioJack::~AudioJack()
 {
 	stopProcessing();
-#ifdef AUDIO_PORT_SUPPORT
 	while( m_portMap.size() )
 	{
 		unregisterPort( m_portMap.begin().key() );
 	}
-#endif
 
 	if( m_client != NULL )
 	{
@@ -278,20 +278,42 @@ void AudioJack::applyQualitySettings()
 
 void AudioJack::registerPort( AudioPort * _port )
 {
-#ifdef AUDIO_PORT_SUPPORT
+	// only tracks have an effect chain, the short-lived ports of
+	// sample play-handles aren't worth a JACK port of their own
+	if( !m_trackPorts || m_client == NULL || _port->effects() == NULL )
+	{
+		return;
+	}
+
 	// make sure, port is not already registered
 	unregisterPort( _port );
-	const QString name[2] = { _port->name() + " L",
-					_port->name() + " R" } ;
 
+	StereoPort * sp = new StereoPort;
 	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
 	{
-		m_portMap[_port].ports[ch] = jack_port_register( m_client,
-						name[ch].toLatin1().constData(),
-						JACK_DEFAULT_AUDIO_TYPE,
-							JackPortIsOutput, 0 );
+		sp->ports[ch] = registerOutputPort( _port->name() +
+							( ch ? " R" : " L" ) );
+		sp->buffers[ch] = NULL;
 	}
-#endif
+	const int slots = mixer()->bufferPoolDepth();
+	sp->data.resize( slots * DEFAULT_CHANNELS * mixer()->framesPerPeriod() );
+	sp->silent.fill( true, slots );
+
+	m_portListMutex.lock();
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		if( sp->ports[ch] != NULL )
+		{
+			m_portList.append( sp->ports[ch] );
+		}
+	}
+	m_portListMutex.unlock();
+
+	mixer()->requestChangeInModel();
+	m_portMapMutex.lock();
+	m_portMap[_port] = sp;
+	m_portMapMutex.unlock();
+	mixer()->doneChangeInModel();
 }
 
 
@@ -299,39 +321,139 @@ void AudioJack::registerPort( AudioPort * _port )
 
 void AudioJack::unregisterPort( AudioPort * _port )
 {
-#ifdef AUDIO_PORT_SUPPORT
+	if( !m_portMap.contains( _port ) )
+	{
+		return;
+	}
+
+	mixer()->requestChangeInModel();
+	m_portMapMutex.lock();
+	StereoPort * sp = m_portMap.take( _port );
+	m_portMapMutex.unlock();
+	mixer()->doneChangeInModel();
+
+	m_portListMutex.lock();
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		m_portList.removeAll( sp->ports[ch] );
+	}
+	m_portListMutex.unlock();
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		if( sp->ports[ch] != NULL && m_client != NULL )
+		{
+			jack_port_unregister( m_client, sp->ports[ch] );
+		}
+	}
+	delete sp;
+}
+
+
+
+
+void AudioJack::renamePort( AudioPort * _port )
+{
 	if( m_portMap.contains( _port ) )
 	{
+		const StereoPort * sp = m_portMap[_port];
 		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
 		{
-			if( m_portMap[_port].ports[ch] != NULL )
+			if( sp->ports[ch] != NULL )
 			{
-				jack_port_unregister( m_client,
-						m_portMap[_port].ports[ch] );
+				const QString name = _port->name() +
+							( ch ? " R" : " L" );
+				jack_port_set_name( sp->ports[ch],
+						name.toUtf8().constData() );
 			}
 		}
-		m_portMap.erase( m_portMap.find( _port ) );
 	}
-#endif
 }
 
 
 
 
-void AudioJack::renamePort( AudioPort * _port )
+void AudioJack::portBufferReady( AudioPort * _port, const sampleFrame * _buf )
 {
-#ifdef AUDIO_PORT_SUPPORT
-	if( m_portMap.contains( _port ) )
+	// the map is only changed while the mixer waits for the change, so
+	// the worker threads can look ports up without locking
+	const JackPortMap & portMap = m_portMap;
+	JackPortMap::ConstIterator it = portMap.constFind( _port );
+	if( it == portMap.constEnd() )
 	{
-		const QString name[2] = { _port->name() + " L",
-					_port->name() + " R" };
+		return;
+	}
+
+	StereoPort * sp = it.value();
+	const int slot = mixer()->writeBufferIndex();
+	sp->silent[slot] = _buf == NULL;
+	if( _buf )
+	{
+		const fpp_t fpp = mixer()->framesPerPeriod();
+		jack_default_audio_sample_t * dst[DEFAULT_CHANNELS];
 		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
 		{
-			jack_port_set_name( m_portMap[_port].ports[ch],
-					name[ch].toLatin1().constData() );
+			dst[ch] = sp->data.data() +
+					( slot * DEFAULT_CHANNELS + ch ) * fpp;
+		}
+		SampleConversion::toPlanarFloat( _buf, fpp, DEFAULT_CHANNELS,
+								1.0f, dst );
+	}
+}
+
+
+
+
+jack_port_t * AudioJack::registerOutputPort( const QString & _name )
+{
+	// port names have to be unique, so number tracks of the same name
+	jack_port_t * port = NULL;
+	for( int i = 1; port == NULL && i <= 16; ++i )
+	{
+		const QString name = i > 1 ?
+			QString( "%1 (%2)" ).arg( _name ).arg( i ) : _name;
+		port = jack_port_register( m_client, name.toUtf8().constData(),
+						JACK_DEFAULT_AUDIO_TYPE,
+						JackPortIsOutput, 0 );
+	}
+	return port;
+}
+
+
+
+
+void AudioJack::writePortOutputs( jack_nframes_t _offset,
+						jack_nframes_t _frames )
+{
+	// per-port data is only available for periods that are passed on
+	// without resampling
+	const fpp_t fpp = mixer()->framesPerPeriod();
+	const int slot = m_framesToDoInCurBuf == fpp ? bufferPoolIndex() : -1;
+
+	const JackPortMap & portMap = m_portMap;
+	for( const StereoPort * sp : portMap )
+	{
+		const bool silent = slot < 0 || sp->silent[slot];
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			if( sp->buffers[ch] == NULL )
+			{
+				continue;
+			}
+			jack_default_audio_sample_t * dst = sp->buffers[ch] + _offset;
+			if( silent )
+			{
+				memset( dst, 0, sizeof( *dst ) * _frames );
+			}
+			else
+			{
+				memcpy( dst, sp->data.constData() +
+					( slot * DEFAULT_CHANNELS + ch ) * fpp +
+						m_framesDoneInCurBuf,
+					sizeof( *dst ) * _frames );
+			}
 		}
 	}
-#endif
 }
 
 
@@ -355,44 +477,47 @@ int AudioJack::processCallback( jack_nframes_t _nframes, void * _udata )
 												m_outputPorts[c], _nframes );
 	}
 
-#ifdef AUDIO_PORT_SUPPORT
-	const int frames = qMin<int>( _nframes, mixer()->framesPerPeriod() );
-	for( jackPortMap::iterator it = m_portMap.begin();
-						it != m_portMap.end(); ++it )
+	// never block the process thread, if ports are (un)registered right
+	// now their outputs are silenced for this cycle instead of repeating
+	// what they played in the previous one
+	const bool withPorts = m_portMapMutex.tryLock();
+	if( withPorts )
 	{
-		for( ch_cnt_t ch = 0; ch < channels(); ++ch )
+		for( StereoPort * sp : m_portMap )
 		{
-			if( it.data().ports[ch] == NULL )
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
 			{
-				continue;
-			}
-			jack_default_audio_sample_t * buf =
-			(jack_default_audio_sample_t *) jack_port_get_buffer(
-							it.data().ports[ch],
+				sp->buffers[ch] = sp->ports[ch] == NULL ? NULL :
+					(jack_default_audio_sample_t *)
+						jack_port_get_buffer( sp->ports[ch],
 								_nframes );
-			for( int frame = 0; frame < frames; ++frame )
-			{
-				buf[frame] = it.key()->firstBuffer()[frame][ch];
 			}
 		}
 	}
-#endif
+	else if( m_portListMutex.tryLock() )
+	{
+		for( jack_port_t * port : m_portList )
+		{
+			memset( jack_port_get_buffer( port, _nframes ), 0,
+				sizeof( jack_default_audio_sample_t ) * _nframes );
+		}
+		m_portListMutex.unlock();
+	}
 
 	jack_nframes_t done = 0;
 	while( done < _nframes && m_stopped == false )
 	{
 		jack_nframes_t todo = qMin<jack_nframes_t>(
-						_nframes,
+						_nframes - done,
 						m_framesToDoInCurBuf -
 							m_framesDoneInCurBuf );
-		const float gain = mixer()->masterGain();
-		for( int c = 0; c < channels(); ++c )
+		SampleConversion::toPlanarFloat(
+					m_outBuf + m_framesDoneInCurBuf, todo,
+					channels(), mixer()->masterGain(),
+					m_tempOutBufs, done );
+		if( withPorts )
 		{
-			jack_default_audio_sample_t * o = m_tempOutBufs[c];
-			for( jack_nframes_t frame = 0; frame < todo; ++frame )
-			{
-				o[done+frame] = m_outBuf[m_framesDoneInCurBuf+frame][c] * gain;
-			}
+			writePortOutputs( done, todo );
 		}
 		done += todo;
 		m_framesDoneInCurBuf += todo;
@@ -415,6 +540,26 @@ int AudioJack::processCallback( jack_nframes_t _nframes, void * _udata )
 			jack_default_audio_sample_t * b = m_tempOutBufs[c] + done;
 			memset( b, 0, sizeof( *b ) * ( _nframes - done ) );
 		}
+		if( withPorts )
+		{
+			for( const StereoPort * sp : m_portMap )
+			{
+				for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+				{
+					if( sp->buffers[ch] != NULL )
+					{
+						memset( sp->buffers[ch] + done, 0,
+							sizeof( jack_default_audio_sample_t ) *
+							( _nframes - done ) );
+					}
+				}
+			}
+		}
+	}
+
+	if( withPorts )
+	{
+		m_portMapMutex.unlock();
 	}
 
 	return 0;
@@ -22,6 +22,8 @@
  *
  */
 
+#include <cstring>
+
 #include "AudioPort.h"
 #include "AudioDevice.h"
 #include "EffectChain.h"
@@ -37,9 +39,13 @@ AudioPort::AudioPort( const QString & _name, bool _has_effect_chain,
 		BoolModel * mutedModel ) :
 	m_bufferUsage( false ),
 	m_portBuffer( BufferManager::acquire() ),
+	m_stemBuffer( NULL ),
+	m_stemTap( StemPostEffects ),
+	m_frozenBuffer( NULL ),
 	m_extOutputEnabled( false ),
 	m_nextFxChannel( 0 ),
-	m_name( "unnamed port" ),
+	m_sourceLatency( 0 ),
+	m_name( _name ),
 	m_effects( _has_effect_chain ? new EffectChain( NULL ) : NULL ),
 	m_volumeModel( volumeModel ),
 	m_panningModel( panningModel ),
@@ -81,6 +87,41 @@ void AudioPort::setExtOutputEnabled( bool _enabled )
 
 
 
+void AudioPort::setNextFxChannel( const fx_ch_t _chnl )
+{
+	m_nextFxChannel = _chnl;
+	if( Engine::fxMixer() )
+	{
+		Engine::fxMixer()->invalidateLatency();
+	}
+}
+
+
+
+
+f_cnt_t AudioPort::latency() const
+{
+	return m_sourceLatency + ( m_effects ? m_effects->latency() : 0 );
+}
+
+
+
+
+void AudioPort::setSourceLatency( f_cnt_t _frames )
+{
+	if( _frames != m_sourceLatency )
+	{
+		m_sourceLatency = _frames;
+		if( Engine::fxMixer() )
+		{
+			Engine::fxMixer()->invalidateLatency();
+		}
+	}
+}
+
+
+
+
 void AudioPort::setName( const QString & _name )
 {
 	m_name = _name;
@@ -105,6 +146,11 @@ void AudioPort::doProcessing()
 {
 	if( m_mutedModel && m_mutedModel->value() )
 	{
+		m_frozenBuffer = NULL;
+		if( m_extOutputEnabled )
+		{
+			Engine::mixer()->audioDev()->portBufferReady( this, NULL );
+		}
 		return;
 	}
 
@@ -218,14 +264,57 @@ void AudioPort::doProcessing()
 	// as of now there's no situation where we only have panning model but no volume model
 	// if we have neither, we don't have to do anything here - just pass the audio as is
 
-	// handle effects
-	const bool me = processEffects();
-	if( me || m_bufferUsage )
+	if( m_stemBuffer && m_stemTap == StemPreEffects && m_bufferUsage )
+	{
+		memcpy( m_stemBuffer, m_portBuffer, fpp * sizeof( sampleFrame ) );
+	}
+
+	// handle effects - the output of a frozen track went through them
+	// already when it was rendered, so they're left alone while it plays
+	bool me = false;
+	if( m_frozenBuffer )
+	{
+		if( m_bufferUsage )
+		{
+			MixHelpers::add( m_portBuffer, m_frozenBuffer, fpp );
+		}
+		else
+		{
+			memcpy( m_portBuffer, m_frozenBuffer, fpp * sizeof( sampleFrame ) );
+		}
+		m_bufferUsage = true;
+		m_frozenBuffer = NULL;
+	}
+	else
+	{
+		me = processEffects();
+	}
+
+	if( m_stemBuffer && m_stemTap == StemUncompensated &&
+							( me || m_bufferUsage ) )
+	{
+		memcpy( m_stemBuffer, m_portBuffer, fpp * sizeof( sampleFrame ) );
+	}
+
+	// line up with the other inputs of the FX channel
+	const bool hasOutput = m_compensation.process( m_portBuffer,
+							me || m_bufferUsage );
+	if( hasOutput )
 	{
+		if( m_stemBuffer && m_stemTap == StemPostEffects )
+		{
+			memcpy( m_stemBuffer, m_portBuffer, fpp * sizeof( sampleFrame ) );
+		}
 		Engine::fxMixer()->mixToChannel( m_portBuffer, m_nextFxChannel ); 	// send output to fx mixer
 																			// TODO: improve the flow here - convert to pull model
 		m_bufferUsage = false;
 	}
+
+	if( m_extOutputEnabled )
+	{
+		Engine::mixer()->audioDev()->portBufferReady( this,
+							hasOutput ? m_portBuffer : NULL );
+	}
 }
 
 
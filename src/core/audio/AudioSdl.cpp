@@ -255,14 +255,9 @@ void AudioSdl::sdlAudioCallback( Uint8 * _buf, int _len )
 										  m_currentBufferFramesCount
 										- m_currentBufferFramePos );
 
-		const float gain = mixer()->masterGain();
-		for (uint f = 0; f < min_frames_count; f++)
-		{
-			(m_outBuf + m_currentBufferFramePos)[f][0] *= gain;
-			(m_outBuf + m_currentBufferFramePos)[f][1] *= gain;
-		}
-
-		memcpy( _buf, m_outBuf + m_currentBufferFramePos, min_frames_count*sizeof(sampleFrame) );
+		SampleConversion::toFloat( m_outBuf + m_currentBufferFramePos,
+					min_frames_count, DEFAULT_CHANNELS,
+					mixer()->masterGain(), (float *)_buf );
 		_buf += min_frames_count*sizeof(sampleFrame);
 		_len -= min_frames_count*sizeof(sampleFrame);
 		m_currentBufferFramePos += min_frames_count;
@@ -69,6 +69,7 @@
 #include "OutputSettings.h"
 #include "ProjectRenderer.h"
 #include "RenderManager.h"
+#include "RenderServer.h"
 #include "Song.h"
 #include "SetupDialog.h"
 
@@ -163,6 +164,10 @@ void printHelp()
 		"  dump <in>                             Dump XML of compressed file <in>\n"
 		"  render <project> [options...]         Render given project file\n"
 		"  rendertracks <project> [options...]   Render each track to a different file\n"
+		"  render-server [<jobs>] [options...]   Render the projects listed in <jobs>\n"
+		"                                        or standard in, one per line as\n"
+		"                                        <project>[<tab><output>], printing\n"
+		"                                        a line of JSON per finished job\n"
 		"  upgrade <in> [out]                    Upgrade file <in> and save as <out>\n"
 		"                                        Standard out is used if no output file\n"
 		"                                        is specified\n"
@@ -178,7 +183,7 @@ void printHelp()
 		"          geometry is <xsizexysize+xoffset+yoffsety>.\n"
 		"      --import <in> [-e]         Import MIDI or Hydrogen file <in>.\n"
 		"          If -e is specified lmms exits after importing the file.\n"
-		"\nOptions for \"render\" and \"rendertracks\":\n"
+		"\nOptions for \"render\", \"rendertracks\" and \"render-server\":\n"
 		"  -a, --float                    Use 32bit float bit depth\n"
 		"  -b, --bitrate <bitrate>        Specify output bitrate in KBit/s\n"
 		"          Default: 160.\n"
@@ -205,6 +210,12 @@ void printHelp()
 		"  -p, --profile <out>            Dump profiling information to file <out>\n"
 		"  -s, --samplerate <samplerate>  Specify output samplerate in Hz\n"
 		"          Range: 44100 (default) to 192000\n"
+		"      --stems <mode>             Specify how \"rendertracks\" renders\n"
+		"          Possible values:\n"
+		"            - mix: Render the song once per track (default)\n"
+		"            - post: Track outputs after effects, single pass\n"
+		"            - pre: Track outputs before effects, single pass\n"
+		"            - fx: FX channel outputs, single pass\n"
 		"  -x, --oversampling <value>     Specify oversampling\n"
 		"          Possible values: 1, 2, 4, 8\n"
 		"          Default: 2\n\n",
@@ -300,7 +311,10 @@ int main( int argc, char * * argv )
 	bool allowRoot = false;
 	bool renderLoop = false;
 	bool renderTracks = false;
+	bool renderServer = false;
+	RenderManager::StemModes stemMode = RenderManager::StemsFullMix;
 	QString fileToLoad, fileToImport, renderOut, profilerOutputFile, configFile;
+	QString renderJobFile;
 
 	// first of two command-line parsing stages
 	for( int i = 1; i < argc; ++i )
@@ -318,6 +332,10 @@ int main( int argc, char * * argv )
 			coreOnly = true;
 			renderTracks = true;
 		}
+		else if( arg == "render-server" || arg == "--render-server" )
+		{
+			coreOnly = true;
+		}
 		else if( arg == "--allowroot" )
 		{
 			allowRoot = true;
@@ -427,6 +445,20 @@ int main( int argc, char * * argv )
 
 			return EXIT_SUCCESS;
 		}
+		else if( arg == "render-server" || arg == "--render-server" )
+		{
+			renderServer = true;
+
+			// the job file is optional, "-" means standard in as well
+			if( i+1 < argc && argv[i+1][0] != '-' )
+			{
+				renderJobFile = QString::fromLocal8Bit( argv[++i] );
+			}
+			else if( i+1 < argc && QString( argv[i+1] ) == "-" )
+			{
+				++i;
+			}
+		}
 		else if( arg == "render" || arg == "--render" || arg == "-r" ||
 			arg == "rendertracks" || arg == "--rendertracks" )
 		{
@@ -565,6 +597,38 @@ int main( int argc, char * * argv )
 				return usageError( QString( "Invalid stereo mode %1" ).arg( argv[i] ) );
 			}
 		}
+		else if( arg == "--stems" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No stem mode specified" );
+			}
+
+			QString const mode( argv[i] );
+
+			if( mode == "mix" )
+			{
+				stemMode = RenderManager::StemsFullMix;
+			}
+			else if( mode == "post" )
+			{
+				stemMode = RenderManager::StemsTrackPostEffects;
+			}
+			else if( mode == "pre" )
+			{
+				stemMode = RenderManager::StemsTrackPreEffects;
+			}
+			else if( mode == "fx" )
+			{
+				stemMode = RenderManager::StemsFxChannels;
+			}
+			else
+			{
+				return usageError( QString( "Invalid stem mode %1" ).arg( argv[i] ) );
+			}
+		}
 		else if( arg =="--float" || arg == "-a" )
 		{
 			os.setBitDepth(OutputSettings::Depth_32Bit);
@@ -758,9 +822,31 @@ int main( int argc, char * * argv )
 
 	bool destroyEngine = false;
 
+	// set up the engine once and render all projects we're asked for
+	if( renderServer )
+	{
+		Engine::init( true );
+		destroyEngine = true;
+
+		if( profilerOutputFile.isEmpty() == false )
+		{
+			Engine::mixer()->profiler().setOutputFile( profilerOutputFile );
+		}
+
+		RenderServer * server = new RenderServer( qs, os, eff, renderLoop );
+		QCoreApplication::instance()->connect( server,
+				SIGNAL( finished() ), SLOT( quit() ) );
+
+		if( !server->start( renderJobFile ) )
+		{
+			printf( "Could not open job file %s\n",
+					renderJobFile.toUtf8().constData() );
+			return EXIT_FAILURE;
+		}
+	}
 	// if we have an output file for rendering, just render the song
 	// without starting the GUI
-	if( !renderOut.isEmpty() )
+	else if( !renderOut.isEmpty() )
 	{
 		Engine::init( true );
 		destroyEngine = true;
@@ -803,7 +889,7 @@ int main( int argc, char * * argv )
 		// start now!
 		if ( renderTracks )
 		{
-			r->renderTracks();
+			r->renderTracks( stemMode );
 		}
 		else
 		{
@@ -80,6 +80,22 @@ AudioAlsaSetupWidget::AudioAlsaSetupWidget( QWidget * _parent ) :
 	m_channels->setLabel( tr( "CHANNELS" ) );
 	m_channels->move( 180, 20 );
 
+	// formats other than S16 are converted to directly, without
+	// ALSA converting them once more if the device supports them
+	QString formatText = ConfigManager::inst()->value( "audioalsa", "format" );
+
+	m_formatComboBox = new QComboBox( this );
+	m_formatComboBox->addItem( tr( "16 bit integer" ), QString( "s16" ) );
+	m_formatComboBox->addItem( tr( "24 bit integer" ), QString( "s24" ) );
+	m_formatComboBox->addItem( tr( "32 bit integer" ), QString( "s32" ) );
+	m_formatComboBox->addItem( tr( "32 bit float" ), QString( "float" ) );
+	m_formatComboBox->setCurrentIndex( qMax( 0,
+				m_formatComboBox->findData( formatText ) ) );
+	m_formatComboBox->setGeometry( 220, 20, 110, 20 );
+
+	QLabel * format_lbl = new QLabel( tr( "SAMPLE FORMAT" ), this );
+	format_lbl->setFont( pointSize<7>( format_lbl->font() ) );
+	format_lbl->setGeometry( 220, 40, 110, 10 );
 }
 
 
@@ -106,6 +122,9 @@ void AudioAlsaSetupWidget::saveSettings()
 	ConfigManager::inst()->setValue( "audioalsa", "device", deviceText );
 	ConfigManager::inst()->setValue( "audioalsa", "channels",
 				QString::number( m_channels->value<int>() ) );
+	ConfigManager::inst()->setValue( "audioalsa", "format",
+		m_formatComboBox->itemData(
+			m_formatComboBox->currentIndex() ).toString() );
 }
 
 
@@ -28,7 +28,9 @@
 #include <QDebug>
 
 #include "ExportProjectDialog.h"
+#include "embed.h"
 #include "Song.h"
+#include "TextFloat.h"
 #include "GuiApplication.h"
 #include "MainWindow.h"
 #include "OutputSettings.h"
@@ -98,6 +100,8 @@ ExportProjectDialog::ExportProjectDialog( const QString & _file_name,
 	compressionWidget->setVisible(false);
 #endif
 
+	stemModeWidget->setVisible( m_multiExport );
+
 	connect( startButton, SIGNAL( clicked() ),
 			this, SLOT( startBtnClicked() ) );
 }
@@ -117,6 +121,15 @@ void ExportProjectDialog::reject()
 
 void ExportProjectDialog::accept()
 {
+	if( m_renderManager && m_renderManager->stemCount() > 1 )
+	{
+		TextFloat::displayMessage( tr( "Export finished" ),
+			tr( "Rendered %1 files in a single pass over the song "
+				"instead of one pass per file." ).
+					arg( m_renderManager->stemCount() ),
+			embed::getIconPixmap( "whatsthis", 24, 24 ), 4000 );
+	}
+
 	m_renderManager.reset(nullptr);
 	QDialog::accept();
 
@@ -201,7 +214,8 @@ void ExportProjectDialog::startExport()
 
 	if ( m_multiExport )
 	{
-		m_renderManager->renderTracks();
+		m_renderManager->renderTracks( static_cast<RenderManager::StemModes>(
+						stemModeCB->currentIndex() ) );
 	}
 	else
 	{
@@ -293,6 +307,9 @@ void ExportProjectDialog::startBtnClicked()
 
 void ExportProjectDialog::updateTitleBar( int _prog )
 {
+	const double speed = m_renderManager ?
+				m_renderManager->realtimeFactor() : 0;
 	gui->mainWindow()->setWindowTitle(
-					tr( "Rendering: %1%" ).arg( _prog ) );
+			tr( "Rendering: %1% (%2x realtime)" ).arg( _prog ).
+						arg( speed, 0, 'f', 1 ) );
 }
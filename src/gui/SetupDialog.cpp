@@ -106,6 +106,8 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 			"app", "disablebackup").toInt()),
 	m_openLastProject(ConfigManager::inst()->value(
 			"app", "openlastproject").toInt()),
+	m_sampleBundle(ConfigManager::inst()->value(
+			"app", "samplebundle").toInt()),
 	m_lang(ConfigManager::inst()->value(
 			"app", "language")),
 	m_saveInterval(	ConfigManager::inst()->value(
@@ -128,6 +130,10 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 			"ui", "syncvstplugins", "1").toInt()),
 	m_disableAutoQuit(ConfigManager::inst()->value(
 			"ui", "disableautoquit", "1").toInt()),
+	m_bbRenderCache(ConfigManager::inst()->value(
+			"mixer", "bbrendercache", "0").toInt()),
+	m_pipelineRemotePlugins(ConfigManager::inst()->value(
+			"mixer", "pipelineremoteplugins", "0").toInt()),
 	m_NaNHandler(ConfigManager::inst()->value(
 			"app", "nanhandler", "1").toInt()),
 	m_hqAudioDev(ConfigManager::inst()->value(
@@ -246,6 +252,8 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 		m_disableBackup, SLOT(toggleDisableBackup(bool)), false);
 	addLedCheckBox("Reopen last project on startup", projects_tw, counter,
 		m_openLastProject, SLOT(toggleOpenLastProject(bool)), false);
+	addLedCheckBox("Store embedded samples in a separate data file", projects_tw, counter,
+		m_sampleBundle, SLOT(toggleSampleBundle(bool)), false);
 
 	projects_tw->setFixedHeight(YDelta + YDelta * counter);
 
@@ -419,6 +427,14 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 	addLedCheckBox("Keep effects running even without input", plugins_tw, counter,
 		m_disableAutoQuit, SLOT(toggleDisableAutoQuit(bool)), false);
 
+	addLedCheckBox("Reuse the output of repeating beat/bassline patterns",
+		plugins_tw, counter,
+		m_bbRenderCache, SLOT(toggleBBRenderCache(bool)), false);
+
+	addLedCheckBox("Run external plugins one period ahead",
+		plugins_tw, counter, m_pipelineRemotePlugins,
+		SLOT(togglePipelineRemotePlugins(bool)), true);
+
 	plugins_tw->setFixedHeight(YDelta + YDelta * counter);
 
 
@@ -882,6 +898,8 @@ void SetupDialog::accept()
 					QString::number(!m_disableBackup));
 	ConfigManager::inst()->setValue("app", "openlastproject",
 					QString::number(m_openLastProject));
+	ConfigManager::inst()->setValue("app", "samplebundle",
+					QString::number(m_sampleBundle));
 	ConfigManager::inst()->setValue("app", "language", m_lang);
 	ConfigManager::inst()->setValue("ui", "saveinterval",
 					QString::number(m_saveInterval));
@@ -901,6 +919,10 @@ void SetupDialog::accept()
 					QString::number(m_syncVSTPlugins));
 	ConfigManager::inst()->setValue("ui", "disableautoquit",
 					QString::number(m_disableAutoQuit));
+	ConfigManager::inst()->setValue("mixer", "bbrendercache",
+					QString::number(m_bbRenderCache));
+	ConfigManager::inst()->setValue("mixer", "pipelineremoteplugins",
+					QString::number(m_pipelineRemotePlugins));
 	ConfigManager::inst()->setValue("mixer", "audiodev",
 					m_audioIfaceNames[m_audioInterfaces->currentText()]);
 	ConfigManager::inst()->setValue("app", "nanhandler",
@@ -998,6 +1020,12 @@ void SetupDialog::toggleOpenLastProject(bool enabled)
 }
 
 
+void SetupDialog::toggleSampleBundle(bool enabled)
+{
+	m_sampleBundle = enabled;
+}
+
+
 void SetupDialog::setLanguage(int lang)
 {
 	m_lang = m_languages[lang];
@@ -1080,6 +1108,18 @@ void SetupDialog::toggleDisableAutoQuit(bool enabled)
 }
 
 
+void SetupDialog::toggleBBRenderCache(bool enabled)
+{
+	m_bbRenderCache = enabled;
+}
+
+
+void SetupDialog::togglePipelineRemotePlugins(bool enabled)
+{
+	m_pipelineRemotePlugins = enabled;
+}
+
+
 
 
 // Audio settings slots.
@@ -399,7 +399,8 @@ BBTrack::~BBTrack()
 	Engine::mixer()->removePlayHandlesOfTypes( this,
 					PlayHandle::TypeNotePlayHandle
 					| PlayHandle::TypeInstrumentPlayHandle
-					| PlayHandle::TypeSamplePlayHandle );
+					| PlayHandle::TypeSamplePlayHandle
+					| PlayHandle::TypeBBRenderPlayHandle );
 
 	const int bb = s_infoMap[this];
 	Engine::getBBTrackContainer()->removeBB( bb );
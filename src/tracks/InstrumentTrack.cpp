@@ -27,6 +27,7 @@
 #include <QQueue>
 #include <QApplication>
 #include <QCloseEvent>
+#include <QEventLoop>
 #include <QLabel>
 #include <QLayout>
 #include <QLineEdit>
@@ -35,14 +36,19 @@
 #include <QMessageBox>
 #include <QMdiSubWindow>
 #include <QPainter>
+#include <QProgressDialog>
+#include <QTemporaryFile>
 
 #include "FileDialog.h"
 #include "InstrumentTrack.h"
 #include "AutomationPattern.h"
 #include "BBTrack.h"
+#include "BBTrackContainer.h"
+#include "BufferManager.h"
 #include "CaptionMenu.h"
 #include "ConfigManager.h"
 #include "ControllerConnection.h"
+#include "DetuningHelper.h"
 #include "EffectChain.h"
 #include "EffectRackView.h"
 #include "embed.h"
@@ -69,6 +75,9 @@
 #include "Pattern.h"
 #include "PluginFactory.h"
 #include "PluginView.h"
+#include "RenderManager.h"
+#include "SampleBuffer.h"
+#include "SampleDataBundle.h"
 #include "SamplePlayHandle.h"
 #include "Song.h"
 #include "StringPairDrag.h"
@@ -110,7 +119,10 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_soundShaping( this ),
 	m_arpeggio( this ),
 	m_noteStacking( this ),
-	m_piano( this )
+	m_piano( this ),
+	m_frozenBuffer( NULL ),
+	m_frozenPeriod( NULL ),
+	m_outputRevision( 0 )
 {
 	m_pitchModel.setCenterValue( 0 );
 	m_panningModel.setCenterValue( DefaultPanning );
@@ -135,6 +147,8 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 			this, SLOT( updatePitchRange() ), Qt::DirectConnection );
 	connect( &m_effectChannelModel, SIGNAL( dataChanged() ),
 			this, SLOT( updateEffectChannel() ), Qt::DirectConnection );
+	connect( this, SIGNAL( instrumentChanged() ),
+			this, SLOT( outputChanged() ), Qt::DirectConnection );
 }
 
 
@@ -152,6 +166,14 @@ InstrumentTrack::~InstrumentTrack()
 	// kill all running notes and the iph
 	silenceAllNotes( true );
 
+	if( Engine::getBBTrackContainer() != NULL &&
+		trackContainer() == (TrackContainer*)Engine::getBBTrackContainer() )
+	{
+		Engine::getBBTrackContainer()->renderCache().removeTrack( this );
+	}
+
+	unfreeze();
+
 	// now we're save deleting the instrument
 	if( m_instrument ) delete m_instrument;
 }
@@ -451,7 +473,8 @@ void InstrumentTrack::silenceAllNotes( bool removeIPH )
 	// invalidate all NotePlayHandles and PresetPreviewHandles linked to this track
 	m_processHandles.clear();
 
-	quint8 flags = PlayHandle::TypeNotePlayHandle | PlayHandle::TypePresetPreviewHandle;
+	quint8 flags = PlayHandle::TypeNotePlayHandle | PlayHandle::TypePresetPreviewHandle |
+						PlayHandle::TypeBBRenderPlayHandle;
 	if( removeIPH )
 	{
 		flags |= PlayHandle::TypeInstrumentPlayHandle;
@@ -615,6 +638,13 @@ bool InstrumentTrack::play( const MidiTime & _start, const fpp_t _frames,
 	{
 		return false;
 	}
+	if( playsFrozen() )
+	{
+		playFrozen( _offset );
+		unlock();
+		return false;
+	}
+
 	const float frames_per_tick = Engine::framesPerTick();
 
 	tcoVector tcos;
@@ -666,6 +696,17 @@ bool InstrumentTrack::play( const MidiTime & _start, const fpp_t _frames,
 			cur_start -= p->startPosition();
 		}
 
+		// notes of beat/bassline repetitions that sound the same as
+		// before are played back from a render
+		BBRender * render = NULL;
+		if( bb_track != NULL &&
+			Engine::getBBTrackContainer()->renderCache().processTick(
+				this, p, _tco_num, bb_track, cur_start, _offset,
+								&render ) )
+		{
+			continue;
+		}
+
 		// get all notes from the given pattern...
 		const NoteVector & notes = p->notes();
 		// ...and set our index to zero
@@ -693,6 +734,7 @@ bool InstrumentTrack::play( const MidiTime & _start, const fpp_t _frames,
 
 			NotePlayHandle* notePlayHandle = NotePlayHandleManager::acquire( this, _offset, note_frames, *cur_note );
 			notePlayHandle->setBBTrack( bb_track );
+			notePlayHandle->setBBRender( render );
 			// are we playing global song?
 			if( _tco_num < 0 )
 			{
@@ -713,6 +755,100 @@ bool InstrumentTrack::play( const MidiTime & _start, const fpp_t _frames,
 
 
 
+static inline void addToHash( uint * _hash, uint _value )
+{
+	*_hash = *_hash * 31 + _value;
+}
+
+
+
+
+bool InstrumentTrack::hashPatternOutput( const Pattern * _pattern, uint * _hash )
+{
+	if( m_instrument == NULL || isSustainPedalPressed() ||
+		m_midiPort.isOutputEnabled() ||
+		!m_instrument->flags().testFlag( Instrument::IsDeterministic ) ||
+		m_instrument->flags().testFlag( Instrument::IsSingleStreamed ) ||
+		m_instrument->flags().testFlag( Instrument::IsMidiBased ) )
+	{
+		return false;
+	}
+	if( ( m_arpeggio.m_arpEnabledModel.value() &&
+		( m_arpeggio.m_arpDirectionModel.value() ==
+				InstrumentFunctionArpeggio::ArpDirRandom ||
+			m_arpeggio.m_arpSkipModel.value() > 0 ||
+			m_arpeggio.m_arpMissModel.value() > 0 ) ) ||
+		m_soundShaping.usesLfo() )
+	{
+		return false;
+	}
+
+	uint hash = qHash( m_instrument ) ^ m_outputRevision;
+	if( m_useMasterPitchModel.value() )
+	{
+		addToHash( &hash, Engine::getSong()->masterPitch() );
+	}
+
+	QList<AutomatableModel *> models =
+			m_instrument->findChildren<AutomatableModel *>();
+	models += m_soundShaping.findChildren<AutomatableModel *>();
+	models += m_arpeggio.findChildren<AutomatableModel *>();
+	models += m_noteStacking.findChildren<AutomatableModel *>();
+	models += m_midiPort.findChildren<AutomatableModel *>();
+	models << &m_baseNoteModel << &m_pitchModel << &m_pitchRangeModel
+						<< &m_useMasterPitchModel;
+	for( const AutomatableModel * m : models )
+	{
+		// automation and controllers change the sound while playing
+		if( m->isAutomatedOrControlled() )
+		{
+			return false;
+		}
+		addToHash( &hash, qHash( m->value<float>() ) );
+	}
+
+	for( const Note * n : _pattern->notes() )
+	{
+		addToHash( &hash, n->pos() );
+		addToHash( &hash, n->length() );
+		addToHash( &hash, n->key() );
+		addToHash( &hash, n->getVolume() );
+		addToHash( &hash, n->getPanning() );
+		if( n->detuning() && n->detuning()->hasAutomation() )
+		{
+			const AutomationPattern * detuning =
+					n->detuning()->automationPattern();
+			addToHash( &hash, detuning->progressionType() );
+			for( AutomationPattern::timeMap::const_iterator it =
+					detuning->getTimeMap().begin();
+				it != detuning->getTimeMap().end(); ++it )
+			{
+				addToHash( &hash, it.key() );
+				addToHash( &hash, qHash( it.value() ) );
+			}
+		}
+	}
+
+	*_hash = hash;
+	return true;
+}
+
+
+
+
+void InstrumentTrack::outputChanged()
+{
+	if( m_instrument != NULL )
+	{
+		connect( m_instrument, SIGNAL( dataChanged() ),
+				this, SLOT( outputChanged() ), Qt::UniqueConnection );
+	}
+	++m_outputRevision;
+}
+
+
+
+
 TrackContentObject * InstrumentTrack::createTCO( const MidiTime & )
 {
 	return new Pattern( this );
@@ -762,6 +898,17 @@ void InstrumentTrack::saveTrackSpecificSettings( QDomDocument& doc, QDomElement
 	}
 
 	m_audioPort.effects()->saveState( doc, thisElement );
+
+	SampleDataBundle * bundle = Engine::getSong()->sampleDataBundle();
+	if( m_frozenBuffer && bundle )
+	{
+		thisElement.setAttribute( "frozenref",
+				m_frozenBuffer->addToBundle( *bundle ) );
+		thisElement.setAttribute( "frozenframes",
+						m_frozenBuffer->frames() );
+		thisElement.setAttribute( "frozenrate",
+						m_frozenBuffer->sampleRate() );
+	}
 }
 
 
@@ -770,6 +917,7 @@ void InstrumentTrack::saveTrackSpecificSettings( QDomDocument& doc, QDomElement
 void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement )
 {
 	silenceAllNotes( true );
+	unfreeze();
 
 	lock();
 
@@ -823,6 +971,7 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 				m_instrument = Instrument::instantiate(
 					node.toElement().attribute( "name" ), this, &key);
 				m_instrument->restoreState( node.firstChildElement() );
+				m_audioPort.setSourceLatency( m_instrument->latency() );
 
 				emit instrumentChanged();
 			}
@@ -841,6 +990,7 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 				{
 					m_instrument->restoreState( node.toElement() );
 				}
+				m_audioPort.setSourceLatency( m_instrument->latency() );
 				emit instrumentChanged();
 			}
 		}
@@ -848,6 +998,26 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 	}
 	updatePitchRange();
 	unlock();
+
+	// the frozen output is only stored in a project's sample data bundle
+	SampleDataBundle * bundle = Engine::getSong()->sampleDataBundle();
+	if( bundle && thisElement.hasAttribute( "frozenref" ) )
+	{
+		SampleBuffer * buffer = new SampleBuffer;
+		if( buffer->loadFromBundle( *bundle,
+				thisElement.attribute( "frozenref" ).toLongLong(),
+				thisElement.attribute( "frozenframes" ).toInt() ) )
+		{
+			buffer->setSampleRate(
+				thisElement.attribute( "frozenrate" ).toInt() );
+			buffer->dropOriginalData();
+			freeze( buffer );
+		}
+		else
+		{
+			sharedObject::unref( buffer );
+		}
+	}
 }
 
 
@@ -861,6 +1031,180 @@ void InstrumentTrack::setPreviewMode( const bool value )
 
 
 
+void InstrumentTrack::freeze( SampleBuffer * _buffer )
+{
+	unfreeze();
+
+	Engine::mixer()->requestChangeInModel();
+	m_frozenBuffer = _buffer;
+	m_frozenPeriod = BufferManager::acquire();
+	Engine::mixer()->doneChangeInModel();
+
+	watchFrozenModels();
+}
+
+
+
+
+void InstrumentTrack::unfreeze()
+{
+	if( m_frozenBuffer == NULL )
+	{
+		return;
+	}
+
+	Engine::mixer()->requestChangeInModel();
+	m_audioPort.setFrozenBuffer( NULL );
+	sharedObject::unref( m_frozenBuffer );
+	m_frozenBuffer = NULL;
+	BufferManager::release( m_frozenPeriod );
+	m_frozenPeriod = NULL;
+	Engine::mixer()->doneChangeInModel();
+}
+
+
+
+
+bool InstrumentTrack::playsFrozen() const
+{
+	// the buffer holds the song from its start, so it can't be used for
+	// playing single patterns or beat/bassline-patterns
+	const Song * song = Engine::getSong();
+	return m_frozenBuffer != NULL &&
+		song->playMode() == Song::Mode_PlaySong && !song->isStopped() &&
+		m_frozenBuffer->sampleRate() ==
+				Engine::mixer()->processingSampleRate();
+}
+
+
+
+
+void InstrumentTrack::playFrozen( const f_cnt_t _offset )
+{
+	// the song position is at frame _offset of the current period - the
+	// song calls us several times per period and later calls overwrite
+	// the rest of the period from their offset on, which gets jumps of
+	// the song position right
+	const Song::PlayPos & pos =
+			Engine::getSong()->getPlayPos( Song::Mode_PlaySong );
+	const f_cnt_t start = static_cast<f_cnt_t>( pos.getTicks() *
+			(double) Engine::framesPerTick() + pos.currentFrame() );
+	const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+	const f_cnt_t frames = qBound<f_cnt_t>( 0,
+				m_frozenBuffer->frames() - start, fpp - _offset );
+
+	if( frames > 0 )
+	{
+		memcpy( m_frozenPeriod + _offset, m_frozenBuffer->data() + start,
+						frames * sizeof( sampleFrame ) );
+	}
+	BufferManager::clear( m_frozenPeriod + _offset + frames,
+						fpp - _offset - frames );
+
+	m_audioPort.setFrozenBuffer( m_frozenPeriod );
+}
+
+
+
+
+void InstrumentTrack::watchFrozenModel( Model * _model )
+{
+	// muting, routing, the MIDI port and the keyboard don't change the
+	// frozen output
+	if( _model == &m_mutedModel || _model == &m_effectChannelModel ||
+		_model == &m_piano || _model == &m_midiPort ||
+					_model->parentModel() == &m_midiPort )
+	{
+		return;
+	}
+
+	connect( _model, SIGNAL( dataChanged() ),
+			this, SLOT( frozenModelChanged() ), Qt::UniqueConnection );
+
+	if( dynamic_cast<TrackContentObject *>( _model ) )
+	{
+		connect( _model, SIGNAL( positionChanged() ),
+			this, SLOT( frozenModelChanged() ), Qt::UniqueConnection );
+		connect( _model, SIGNAL( lengthChanged() ),
+			this, SLOT( frozenModelChanged() ), Qt::UniqueConnection );
+	}
+
+	AutomatableModel * m = dynamic_cast<AutomatableModel *>( _model );
+	if( m && m->isAutomated() )
+	{
+		for( AutomationPattern * p :
+				AutomationPattern::patternsForModel( m ) )
+		{
+			connect( p, SIGNAL( dataChanged() ), this,
+				SLOT( frozenModelChanged() ), Qt::UniqueConnection );
+		}
+	}
+}
+
+
+
+
+void InstrumentTrack::watchFrozenModels()
+{
+	QList<Model *> models = findChildren<Model *>();
+	models += m_audioPort.effects();
+	models += m_audioPort.effects()->findChildren<Model *>();
+	if( m_instrument )
+	{
+		models += m_instrument;
+		models += m_instrument->findChildren<Model *>();
+	}
+
+	for( Model * m : models )
+	{
+		watchFrozenModel( m );
+	}
+
+	connect( this, SIGNAL( instrumentChanged() ),
+			this, SLOT( frozenModelChanged() ), Qt::UniqueConnection );
+	connect( this, SIGNAL( trackContentObjectAdded( TrackContentObject * ) ),
+			this, SLOT( frozenTCOAdded( TrackContentObject * ) ),
+							Qt::UniqueConnection );
+	// positions are looked up at the current tempo
+	connect( Engine::getSong(), SIGNAL( tempoChanged( bpm_t ) ),
+			this, SLOT( frozenModelChanged() ), Qt::UniqueConnection );
+}
+
+
+
+
+void InstrumentTrack::frozenModelChanged()
+{
+	// values driven by automation or controllers end up the same as when
+	// freezing as long as the automation itself doesn't change
+	AutomatableModel * m = dynamic_cast<AutomatableModel *>( sender() );
+	if( !isFrozen() || Engine::getSong()->isLoadingProject() ||
+					( m && m->isAutomatedOrControlled() ) )
+	{
+		return;
+	}
+
+	unfreeze();
+}
+
+
+
+
+void InstrumentTrack::frozenTCOAdded( TrackContentObject * _tco )
+{
+	if( isFrozen() )
+	{
+		watchFrozenModel( _tco );
+		for( Model * m : _tco->findChildren<Model *>() )
+		{
+			watchFrozenModel( m );
+		}
+	}
+}
+
+
+
+
 Instrument * InstrumentTrack::loadInstrument(const QString & _plugin_name,
 	const Plugin::Descriptor::SubPluginFeatures::Key *key, bool keyFromDnd)
 {
@@ -873,6 +1217,7 @@ Instrument * InstrumentTrack::loadInstrument(const QString & _plugin_name,
 	delete m_instrument;
 	m_instrument = Instrument::instantiate(_plugin_name, this,
 					key, keyFromDnd);
+	m_audioPort.setSourceLatency( m_instrument->latency() );
 	unlock();
 	setName(m_instrument->displayName());
 
@@ -1045,6 +1390,98 @@ void InstrumentTrackView::createFxLine()
 
 
 
+/*! \brief Render the track's output and play it back from then on */
+void InstrumentTrackView::freezeTrack()
+{
+	InstrumentTrack * track = model();
+	Song * song = Engine::getSong();
+	Mixer * mixer = Engine::mixer();
+
+	QTemporaryFile file( QDir::temp().filePath( "lmms-freeze-XXXXXX.wav" ) );
+	if( !file.open() )
+	{
+		return;
+	}
+	file.close();
+
+	// the track's output has to cover the whole song from its start, so
+	// override the export settings for the time being
+	song->stop();
+	const bool renderBetweenMarkers = song->renderBetweenMarkers();
+	const bool exportLoop = song->exportLoop();
+	const int loopRenderCount = song->getLoopRenderCount();
+	song->setRenderBetweenMarkers( false );
+	song->setExportLoop( false );
+	song->setLoopRenderCount( 1 );
+
+	// the master volume is applied when the track is played back
+	const float masterGain = mixer->masterGain();
+	mixer->setMasterGain( 1.0f );
+
+	const OutputSettings outputSettings( mixer->processingSampleRate(),
+				OutputSettings::BitRateSettings( 160, false ),
+				OutputSettings::Depth_32Bit );
+	bool canceled;
+	{
+		RenderManager renderManager( mixer->currentQualitySettings(),
+					outputSettings, ProjectRenderer::WaveFile,
+							file.fileName() );
+
+		QProgressDialog progress( tr( "Freezing %1..." ).arg(
+							track->name() ),
+					tr( "Cancel" ), 0, 100, gui->mainWindow() );
+		progress.setWindowModality( Qt::WindowModal );
+
+		QEventLoop loop;
+		connect( &renderManager, SIGNAL( progressChanged( int ) ),
+					&progress, SLOT( setValue( int ) ) );
+		connect( &renderManager, SIGNAL( finished() ),
+				&loop, SLOT( quit() ), Qt::QueuedConnection );
+		connect( &progress, SIGNAL( canceled() ), &loop, SLOT( quit() ) );
+
+		renderManager.renderTrack( track );
+		loop.exec();
+
+		canceled = progress.wasCanceled();
+		if( canceled )
+		{
+			renderManager.abortProcessing();
+		}
+	}
+
+	mixer->setMasterGain( masterGain );
+	song->setRenderBetweenMarkers( renderBetweenMarkers );
+	song->setExportLoop( exportLoop );
+	song->setLoopRenderCount( loopRenderCount );
+
+	if( canceled )
+	{
+		return;
+	}
+
+	SampleBuffer * rendered = new SampleBuffer( file.fileName() );
+	if( rendered->frames() > 0 )
+	{
+		// the temporary file is gone once we return, so copy the data
+		// and keep nothing but that copy
+		SampleBuffer * frozen = new SampleBuffer( rendered->data(),
+							rendered->frames() );
+		sharedObject::unref( rendered );
+		frozen->dropOriginalData();
+		track->freeze( frozen );
+	}
+	else
+	{
+		sharedObject::unref( rendered );
+		QMessageBox::warning( this, tr( "Freeze failed" ),
+			tr( "The output of %1 could not be rendered." ).arg(
+							track->name() ) );
+	}
+}
+
+
+
+
 /*! \brief Assign a specific FX Channel for this track */
 void InstrumentTrackView::assignFxLine(int channelIndex)
 {
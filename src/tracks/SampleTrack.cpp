@@ -41,6 +41,7 @@
 #include "ToolTip.h"
 #include "BBTrack.h"
 #include "SamplePlayHandle.h"
+#include "SampleDataBundle.h"
 #include "SampleRecordHandle.h"
 #include "SongEditor.h"
 #include "StringPairDrag.h"
@@ -62,6 +63,10 @@ SampleTCO::SampleTCO( Track * _track ) :
 	setSampleFile( "" );
 	restoreJournallingState();
 
+	// the waveform is drawn in more detail once the sample is summarized
+	connect( m_sampleBuffer, SIGNAL( peaksReady() ),
+					this, SIGNAL( sampleChanged() ) );
+
 	// we need to receive bpm-change-events, because then we have to
 	// change length of this TCO
 	connect( Engine::getSong(), SIGNAL( tempoChanged( bpm_t ) ),
@@ -139,10 +144,13 @@ const QString & SampleTCO::sampleFile() const
 
 void SampleTCO::setSampleBuffer( SampleBuffer* sb )
 {
+	m_sampleBuffer->disconnect( this );
 	Engine::mixer()->requestChangeInModel();
 	sharedObject::unref( m_sampleBuffer );
 	Engine::mixer()->doneChangeInModel();
 	m_sampleBuffer = sb;
+	connect( m_sampleBuffer, SIGNAL( peaksReady() ),
+					this, SIGNAL( sampleChanged() ) );
 	updateLength();
 
 	emit sampleChanged();
@@ -270,8 +278,17 @@ void SampleTCO::saveSettings( QDomDocument & _doc, QDomElement & _this )
 	_this.setAttribute( "off", startTimeOffset() );
 	if( sampleFile() == "" )
 	{
-		QString s;
-		_this.setAttribute( "data", m_sampleBuffer->toBase64( s ) );
+		SampleDataBundle * bundle = Engine::getSong()->sampleDataBundle();
+		if( bundle )
+		{
+			_this.setAttribute( "dataref", m_sampleBuffer->addToBundle( *bundle ) );
+			_this.setAttribute( "dataframes", m_sampleBuffer->frames() );
+		}
+		else
+		{
+			QString s;
+			_this.setAttribute( "data", m_sampleBuffer->toBase64( s ) );
+		}
 	}
 
 	_this.setAttribute ("sample_rate", m_sampleBuffer->sampleRate());
@@ -288,7 +305,20 @@ void SampleTCO::loadSettings( const QDomElement & _this )
 		movePosition( _this.attribute( "pos" ).toInt() );
 	}
 	setSampleFile( _this.attribute( "src" ) );
-	if( sampleFile().isEmpty() && _this.hasAttribute( "data" ) )
+	SampleDataBundle * bundle = Engine::getSong()->sampleDataBundle();
+	if( sampleFile().isEmpty() && _this.hasAttribute( "dataref" ) )
+	{
+		if( bundle == NULL || !m_sampleBuffer->loadFromBundle( *bundle,
+					_this.attribute( "dataref" ).toLongLong(),
+					_this.attribute( "dataframes" ).toInt() ) )
+		{
+			Engine::getSong()->collectError(
+				tr( "Sample data missing from %1" ).arg(
+					SampleDataBundle::fileNameFor(
+				Engine::getSong()->projectFileName() ) ) );
+		}
+	}
+	else if( sampleFile().isEmpty() && _this.hasAttribute( "data" ) )
 	{
 		m_sampleBuffer->loadFromBase64( _this.attribute( "data" ) );
 	}
@@ -0,0 +1,93 @@
+/*
+ * AudioPortTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <vector>
+
+#include "AudioPort.h"
+#include "BufferManager.h"
+#include "Engine.h"
+#include "FxMixer.h"
+#include "Mixer.h"
+
+class AudioPortTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void FrozenOutputIsDelayedOnce()
+	{
+		const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+		const f_cnt_t latency = fpp / 2 + 3;
+
+		// a track whose output lags behind next to one being frozen,
+		// both playing into the master channel
+		AudioPort latent( "latent", false, NULL, NULL, NULL );
+		latent.setSourceLatency( latency );
+		AudioPort recording( "recording", false, NULL, NULL, NULL );
+		AudioPort playback( "playback", false, NULL, NULL, NULL );
+		Engine::fxMixer()->prepareMasterMix();
+
+		std::vector<sampleFrame> impulse( fpp );
+		BufferManager::clear( impulse.data(), fpp );
+		impulse[0][0] = impulse[0][1] = 1.0f;
+
+		// freezing records the output before it's lined up with the
+		// latent track
+		std::vector<sampleFrame> frozen( fpp );
+		BufferManager::clear( frozen.data(), fpp );
+		recording.setStemBuffer( frozen.data(),
+					AudioPort::StemUncompensated );
+		recording.setFrozenBuffer( impulse.data() );
+		recording.doProcessing();
+		QCOMPARE( frozen[0][0], 1.0f );
+
+		// so playing it back lines it up exactly once
+		std::vector<sampleFrame> out( fpp );
+		playback.setStemBuffer( out.data() );
+		f_cnt_t found = -1;
+		for( int period = 0; period < 3; ++period )
+		{
+			BufferManager::clear( out.data(), fpp );
+			if( period == 0 )
+			{
+				playback.setFrozenBuffer( frozen.data() );
+			}
+			playback.doProcessing();
+			for( fpp_t f = 0; f < fpp; ++f )
+			{
+				if( out[f][0] != 0.0f )
+				{
+					QCOMPARE( found, f_cnt_t( -1 ) );
+					found = period * fpp + f;
+				}
+			}
+		}
+		QCOMPARE( found, latency );
+
+		// leave the master channel clean for other tests
+		Engine::fxMixer()->prepareMasterMix();
+	}
+} AudioPortTests;
+
+#include "AudioPortTest.moc"
@@ -0,0 +1,85 @@
+/*
+ * CompensationDelayTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <vector>
+
+#include "BufferManager.h"
+#include "CompensationDelay.h"
+#include "Engine.h"
+#include "Mixer.h"
+
+class CompensationDelayTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void ZeroDelayPassesThrough()
+	{
+		const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+		std::vector<sampleFrame> buf( fpp );
+		BufferManager::clear( buf.data(), fpp );
+		buf[3][0] = 1.0f;
+
+		CompensationDelay delay;
+		QVERIFY( delay.process( buf.data(), true ) );
+		QCOMPARE( buf[3][0], 1.0f );
+		QVERIFY( !delay.process( buf.data(), false ) );
+	}
+
+	void DelaysImpulseAcrossPeriods()
+	{
+		const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+		const f_cnt_t frames = fpp + fpp / 2 + 1;
+		std::vector<sampleFrame> buf( fpp );
+
+		CompensationDelay delay;
+		delay.setDelay( frames );
+
+		// impulse at the first frame, followed by silent periods
+		BufferManager::clear( buf.data(), fpp );
+		buf[0][0] = buf[0][1] = 1.0f;
+		f_cnt_t found = -1;
+		for( int period = 0; period < 4; ++period )
+		{
+			const bool hasInput = period == 0;
+			const bool active = delay.process( buf.data(), hasInput );
+			if( period <= frames / fpp )
+			{
+				QVERIFY( active );
+			}
+			for( fpp_t f = 0; active && f < fpp; ++f )
+			{
+				if( buf[f][1] != 0.0f )
+				{
+					QCOMPARE( found, f_cnt_t( -1 ) );
+					found = period * fpp + f;
+				}
+			}
+		}
+		QCOMPARE( found, frames );
+		QVERIFY( !delay.process( buf.data(), false ) );
+	}
+} CompensationDelayTests;
+
+#include "CompensationDelayTest.moc"
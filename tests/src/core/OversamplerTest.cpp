@@ -0,0 +1,96 @@
+/*
+ * OversamplerTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include <cmath>
+#include <vector>
+
+#include "lmms_constants.h"
+#include "Oversampler.h"
+
+class OversamplerTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void RoundTripIsDelayedByLatency()
+	{
+		const fpp_t frames = 256;
+		std::vector<sampleFrame> buf( frames );
+
+		for( int factor = 1; factor <= Oversampler::MaximumFactor;
+								factor *= 2 )
+		{
+			Oversampler oversampler( factor, frames );
+			QCOMPARE( oversampler.factor(), factor );
+
+			// a 1 kHz sine at 44.1 kHz plus some DC on the left and
+			// its inverse on the right
+			std::vector<float> input;
+			float maxError = 0.0f;
+			for( int period = 0; period < 10; ++period )
+			{
+				for( fpp_t f = 0; f < frames; ++f )
+				{
+					const float s = 0.2f + 0.5f * sinf(
+						F_2PI * 1000.0f * input.size() / 44100.0f );
+					buf[f][0] = s;
+					buf[f][1] = -s;
+					input.push_back( s );
+				}
+
+				sampleFrame * up = oversampler.upsample( buf.data(),
+									frames );
+				QVERIFY( up != NULL );
+				oversampler.downsample( buf.data(), frames );
+
+				for( fpp_t f = 0; f < frames; ++f )
+				{
+					// skip the settling of the filters
+					const int i = period * frames + f -
+							oversampler.latency();
+					if( i < frames )
+					{
+						continue;
+					}
+					maxError = qMax( maxError,
+						qAbs( buf[f][0] - input[i] ) );
+					maxError = qMax( maxError,
+						qAbs( buf[f][1] + input[i] ) );
+				}
+			}
+			QVERIFY( maxError < 1e-3f );
+		}
+	}
+
+	void FactorOneHasNoLatency()
+	{
+		Oversampler oversampler;
+		QCOMPARE( oversampler.factor(), 1 );
+		QCOMPARE( oversampler.latency(), f_cnt_t( 0 ) );
+		QVERIFY( oversampler.setFactor( 4 ) );
+		QVERIFY( !oversampler.setFactor( 4 ) );
+		QVERIFY( oversampler.latency() > 0 );
+	}
+} OversamplerTests;
+
+#include "OversamplerTest.moc"
@@ -0,0 +1,92 @@
+/*
+ * PlanarBufferTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <vector>
+
+#include "PlanarBuffer.h"
+
+class PlanarBufferTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void InterleavedRoundTrip()
+	{
+		const fpp_t frames = 333;
+		std::vector<sampleFrame> src( frames );
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			src[f][0] = f * 0.5f;
+			src[f][1] = -f * 0.25f;
+		}
+
+		PlanarBuffer buffer( frames );
+		QVERIFY( buffer.capacity() >= frames );
+		buffer.fromInterleaved( src.data(), frames );
+
+		// each channel holds its samples in order
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			QCOMPARE( buffer.channel( 0 )[f], src[f][0] );
+			QCOMPARE( buffer.channel( 1 )[f], src[f][1] );
+		}
+		QCOMPARE( buffer.channels()[0], buffer.channel( 0 ) );
+		QCOMPARE( buffer.channels()[1], buffer.channel( 1 ) );
+
+		std::vector<sampleFrame> dst( frames + 1 );
+		dst[frames][0] = dst[frames][1] = 42.0f;
+		buffer.toInterleaved( dst.data(), frames );
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			QCOMPARE( dst[f][0], src[f][0] );
+			QCOMPARE( dst[f][1], src[f][1] );
+		}
+		// nothing written past the requested frames
+		QCOMPARE( dst[frames][0], 42.0f );
+		QCOMPARE( dst[frames][1], 42.0f );
+	}
+
+	void ReserveAndClear()
+	{
+		PlanarBuffer buffer;
+		buffer.reserve( 64 );
+		QVERIFY( buffer.capacity() >= 64 );
+
+		std::vector<sampleFrame> src( 64 );
+		for( fpp_t f = 0; f < 64; ++f )
+		{
+			src[f][0] = src[f][1] = 1.0f;
+		}
+		buffer.fromInterleaved( src.data(), 64 );
+		buffer.clear( 32 );
+		for( fpp_t f = 0; f < 64; ++f )
+		{
+			const float expected = f < 32 ? 0.0f : 1.0f;
+			QCOMPARE( buffer.channel( 0 )[f], expected );
+			QCOMPARE( buffer.channel( 1 )[f], expected );
+		}
+	}
+} PlanarBufferTests;
+
+#include "PlanarBufferTest.moc"
@@ -0,0 +1,215 @@
+/*
+ * RemotePluginTransportTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "RemotePlugin.h"
+
+#ifdef SYNC_WITH_SHM_RING
+
+// both ends of a ring live in this process here, but they only talk through
+// the ring memory, just like the host and a remote plugin do
+class RingPeer : public QThread
+{
+public:
+	RingPeer( shmRing::Data * _in, shmRing::Data * _out ) :
+		m_bytes( 0 ),
+		m_mismatches( 0 )
+	{
+		m_in.attach( _in, 0 );
+		m_out.attach( _out, 0 );
+	}
+
+	// reads ints and sends them back until it gets a negative one
+	void echo()
+	{
+		int32_t i;
+		do
+		{
+			m_in.read( &i, sizeof( i ) );
+			m_out.write( &i, sizeof( i ) );
+		} while( i >= 0 );
+	}
+
+	// reads m_bytes of the pattern the tests write
+	void checkPattern()
+	{
+		char buf[1000];
+		int n = 0;
+		while( n < m_bytes )
+		{
+			const int len = qMin<int>( sizeof( buf ), m_bytes - n );
+			if( !m_in.read( buf, len ) )
+			{
+				return;
+			}
+			for( int i = 0; i < len; ++i, ++n )
+			{
+				m_mismatches += buf[i] != static_cast<char>( n * 7 );
+			}
+		}
+	}
+
+	shmRing m_in;
+	shmRing m_out;
+	int m_bytes;
+	int m_mismatches;
+
+private:
+	void run() override
+	{
+		if( m_bytes > 0 )
+		{
+			checkPattern();
+		}
+		else
+		{
+			echo();
+		}
+	}
+
+} ;
+
+#endif
+
+
+class RemotePluginTransportTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void RingStreamsDataLargerThanItself()
+	{
+#ifdef SYNC_WITH_SHM_RING
+		shmRing::Data * data = createData();
+		RingPeer reader( data, NULL );
+		reader.m_bytes = 3 * SHM_RING_SIZE + 123;
+		reader.start();
+
+		shmRing writer;
+		writer.attach( data, 0 );
+		std::vector<char> buf( 4099 );
+		for( int n = 0; n < reader.m_bytes; )
+		{
+			const int len = qMin<int>( buf.size(), reader.m_bytes - n );
+			for( int i = 0; i < len; ++i )
+			{
+				buf[i] = static_cast<char>( ( n + i ) * 7 );
+			}
+			QVERIFY( writer.write( buf.data(), len ) );
+			n += len;
+		}
+
+		QVERIFY( reader.wait( 10000 ) );
+		QCOMPARE( reader.m_mismatches, 0 );
+		QVERIFY( writer.isEmpty() );
+		freeData( data );
+#else
+		QSKIP( "shared memory rings aren't used on this platform" );
+#endif
+	}
+
+	void InvalidatingWakesWaitingReader()
+	{
+#ifdef SYNC_WITH_SHM_RING
+		shmRing::Data * data = createData();
+		RingPeer reader( data, NULL );
+		reader.m_bytes = 1;
+		reader.start();
+
+		QThread::msleep( 50 );
+		QElapsedTimer timer;
+		timer.start();
+		reader.m_in.invalidate();
+		QVERIFY( reader.wait( 1000 ) );
+		// the reader also rechecks after SHM_RING_TIMEOUT, so it has to
+		// return well before that to tell that it has been woken up
+		QVERIFY( timer.elapsed() < 100 );
+		freeData( data );
+#else
+		QSKIP( "shared memory rings aren't used on this platform" );
+#endif
+	}
+
+	void BenchmarkPingPong()
+	{
+#ifdef SYNC_WITH_SHM_RING
+		shmRing::Data * toPeer = createData();
+		shmRing::Data * fromPeer = createData();
+		RingPeer peer( toPeer, fromPeer );
+		peer.start();
+
+		shmRing out;
+		shmRing in;
+		out.attach( toPeer, 0 );
+		in.attach( fromPeer, 0 );
+
+		int32_t i = 0;
+		QBENCHMARK
+		{
+			int32_t reply;
+			out.write( &i, sizeof( i ) );
+			in.read( &reply, sizeof( reply ) );
+			QCOMPARE( reply, i );
+			++i;
+		}
+
+		i = -1;
+		out.write( &i, sizeof( i ) );
+		QVERIFY( peer.wait( 1000 ) );
+		freeData( toPeer );
+		freeData( fromPeer );
+#else
+		QSKIP( "shared memory rings aren't used on this platform" );
+#endif
+	}
+
+private:
+#ifdef SYNC_WITH_SHM_RING
+	static shmRing::Data * createData()
+	{
+		void * mem = NULL;
+		if( posix_memalign( &mem, SHM_RING_ALIGN,
+						sizeof( shmRing::Data ) ) != 0 )
+		{
+			return NULL;
+		}
+		shmRing ring;
+		ring.attach( new( mem ) shmRing::Data, 0 );
+		ring.reset();
+		return static_cast<shmRing::Data *>( mem );
+	}
+
+	static void freeData( shmRing::Data * _data )
+	{
+		_data->~Data();
+		free( _data );
+	}
+#endif
+} RemotePluginTransportTests;
+
+#include "RemotePluginTransportTest.moc"
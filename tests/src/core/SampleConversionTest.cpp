@@ -0,0 +1,199 @@
+/*
+ * SampleConversionTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "SampleConversion.h"
+
+class SampleConversionTest : QTestSuite
+{
+	Q_OBJECT
+public:
+	SampleConversionTest() :
+		m_raw( Frames * SURROUND_CHANNELS )
+	{
+		// odd number of frames so the scalar tails are exercised too,
+		// with some samples clipping
+		for( size_t i = 0; i < m_raw.size(); ++i )
+		{
+			m_raw[i] = sinf( i * 0.37f ) * 1.3f;
+		}
+	}
+
+private:
+	static const int Frames = 1003;
+
+	const surroundSampleFrame * source() const
+	{
+		return reinterpret_cast<const surroundSampleFrame *>(
+							m_raw.data() );
+	}
+
+	std::vector<float> m_raw;
+
+private slots:
+	void IntegerFormatsMatchScalarConversion()
+	{
+		using namespace SampleConversion;
+		const int samples = Frames * SURROUND_CHANNELS;
+
+		std::vector<int16_t> s16( samples );
+		toS16( source(), Frames, SURROUND_CHANNELS, 0.9f, s16.data() );
+		std::vector<int16_t> swapped( samples );
+		toS16( source(), Frames, SURROUND_CHANNELS, 0.9f,
+						swapped.data(), true );
+		std::vector<int32_t> s24( samples );
+		toS24( source(), Frames, SURROUND_CHANNELS, 0.9f, s24.data() );
+		std::vector<int32_t> s32( samples );
+		toS32( source(), Frames, SURROUND_CHANNELS, 1.0f, s32.data() );
+
+		for( int i = 0; i < samples; ++i )
+		{
+			const float s = qBound( -1.0f, m_raw[i] * 0.9f, 1.0f );
+			QCOMPARE( s16[i], static_cast<int16_t>( s * 32767.0f ) );
+			QCOMPARE( static_cast<uint16_t>( swapped[i] ),
+				static_cast<uint16_t>(
+					( static_cast<uint16_t>( s16[i] ) << 8 ) |
+					( static_cast<uint16_t>( s16[i] ) >> 8 ) ) );
+			QCOMPARE( s24[i], static_cast<int32_t>( s * 8388607.0f ) );
+			const float full = qBound( -1.0f, m_raw[i], 1.0f );
+			QCOMPARE( s32[i],
+				static_cast<int32_t>( full * 2147483520.0f ) );
+		}
+	}
+
+	void StereoS24MatchesScalarConversion()
+	{
+		// fewer channels than the frames have take the per-frame path
+		std::vector<int32_t> s24( Frames * 2 );
+		SampleConversion::toS24( source(), Frames, 2, 0.9f, s24.data() );
+
+		for( int f = 0; f < Frames; ++f )
+		{
+			for( int ch = 0; ch < 2; ++ch )
+			{
+				const float s = qBound( -1.0f,
+					m_raw[f * SURROUND_CHANNELS + ch] * 0.9f,
+									1.0f );
+				QCOMPARE( s24[f * 2 + ch],
+					static_cast<int32_t>( s * 8388607.0f ) );
+			}
+		}
+	}
+
+	void PlanarFloatAppliesGain()
+	{
+		std::vector<float> left( Frames + 10 ), right( Frames + 10 );
+		float * planes[] = { left.data(), right.data() };
+		SampleConversion::toPlanarFloat( source(), Frames, 2, 0.5f,
+								planes, 10 );
+		QCOMPARE( left[10], m_raw[0] * 0.5f );
+		QCOMPARE( right[Frames + 9], m_raw[Frames * 2 - 1] * 0.5f );
+	}
+
+	void DitherKeepsSubLsbSignal()
+	{
+		// a constant quarter LSB is lost without dither, with dither
+		// it survives on average
+		using namespace SampleConversion;
+		std::vector<float> dc( 2 * 8192, 0.25f / 32767.0f );
+		std::vector<int16_t> out( dc.size() );
+		const surroundSampleFrame * src =
+			reinterpret_cast<const surroundSampleFrame *>( dc.data() );
+
+		toS16( src, 8192, 2, 1.0f, out.data() );
+		QCOMPARE( out[100], static_cast<int16_t>( 0 ) );
+
+		for( DitherModes mode : { TriangularDither, NoiseShapedDither } )
+		{
+			Ditherer ditherer( mode );
+			toS16( src, 8192, 2, 1.0f, out.data(), false, &ditherer );
+			double sum = 0;
+			for( int16_t s : out )
+			{
+				QVERIFY( abs( s ) <= 4 );
+				sum += s;
+			}
+			QVERIFY( fabs( sum / out.size() - 0.25 ) < 0.05 );
+		}
+	}
+
+	void BenchmarkS16()
+	{
+		std::vector<int16_t> out( m_raw.size() );
+		QBENCHMARK
+		{
+			SampleConversion::toS16( source(), Frames,
+					SURROUND_CHANNELS, 1.0f, out.data() );
+		}
+	}
+
+	void BenchmarkS16Dithered()
+	{
+		std::vector<int16_t> out( m_raw.size() );
+		SampleConversion::Ditherer ditherer(
+				SampleConversion::NoiseShapedDither );
+		QBENCHMARK
+		{
+			SampleConversion::toS16( source(), Frames,
+					SURROUND_CHANNELS, 1.0f, out.data(),
+							false, &ditherer );
+		}
+	}
+
+	void BenchmarkS24()
+	{
+		std::vector<int32_t> out( m_raw.size() );
+		QBENCHMARK
+		{
+			SampleConversion::toS24( source(), Frames,
+					SURROUND_CHANNELS, 1.0f, out.data() );
+		}
+	}
+
+	void BenchmarkS32()
+	{
+		std::vector<int32_t> out( m_raw.size() );
+		QBENCHMARK
+		{
+			SampleConversion::toS32( source(), Frames,
+					SURROUND_CHANNELS, 1.0f, out.data() );
+		}
+	}
+
+	void BenchmarkFloat()
+	{
+		std::vector<float> out( m_raw.size() );
+		QBENCHMARK
+		{
+			SampleConversion::toFloat( source(), Frames,
+					SURROUND_CHANNELS, 1.0f, out.data(),
+									true );
+		}
+	}
+} SampleConversionTests;
+
+#include "SampleConversionTest.moc"
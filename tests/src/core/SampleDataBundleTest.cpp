@@ -0,0 +1,149 @@
+/*
+ * SampleDataBundleTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "SampleDataBundle.h"
+
+class SampleDataBundleTest : QTestSuite
+{
+	Q_OBJECT
+private:
+	static std::vector<sampleFrame> ramp( f_cnt_t frames, float offset )
+	{
+		std::vector<sampleFrame> data( frames );
+		for( f_cnt_t f = 0; f < frames; ++f )
+		{
+			data[f][0] = offset + f;
+			data[f][1] = -offset - f;
+		}
+		return data;
+	}
+
+private slots:
+	void RoundTrip()
+	{
+		QTemporaryDir dir;
+		QVERIFY( dir.isValid() );
+		const QString fileName = SampleDataBundle::fileNameFor(
+					QDir( dir.path() ).filePath( "test.mmpz" ) );
+
+		const std::vector<sampleFrame> first = ramp( 1000, 0.0f );
+		const std::vector<sampleFrame> second = ramp( 10, 5000.0f );
+
+		qint64 firstOffset, secondOffset;
+		{
+			SampleDataBundle bundle;
+			QVERIFY( bundle.isEmpty() );
+			firstOffset = bundle.add( first.data(), first.size() );
+			secondOffset = bundle.add( second.data(), second.size() );
+			QVERIFY( !bundle.isEmpty() );
+			QVERIFY( bundle.writeFile( fileName ) );
+		}
+
+		// chunks start on pages of their own after the header
+		QCOMPARE( firstOffset, SampleDataBundle::PageSize );
+		QCOMPARE( secondOffset % SampleDataBundle::PageSize, qint64( 0 ) );
+		QVERIFY( secondOffset > firstOffset );
+
+		SampleDataBundle bundle;
+		QVERIFY( bundle.open( fileName ) );
+
+		std::vector<sampleFrame> read( first.size() );
+		QVERIFY( bundle.read( firstOffset, read.size(), read.data() ) );
+		for( size_t f = 0; f < first.size(); ++f )
+		{
+			QCOMPARE( read[f][0], first[f][0] );
+			QCOMPARE( read[f][1], first[f][1] );
+		}
+
+		read.resize( second.size() );
+		QVERIFY( bundle.read( secondOffset, read.size(), read.data() ) );
+		for( size_t f = 0; f < second.size(); ++f )
+		{
+			QCOMPARE( read[f][0], second[f][0] );
+			QCOMPARE( read[f][1], second[f][1] );
+		}
+	}
+
+	void RejectsMissingAndShortData()
+	{
+		QTemporaryDir dir;
+		QVERIFY( dir.isValid() );
+		const QString fileName = QDir( dir.path() ).filePath( "test.data" );
+
+		SampleDataBundle missing;
+		QVERIFY( !missing.open( fileName ) );
+		sampleFrame frame;
+		QVERIFY( !missing.read( SampleDataBundle::PageSize, 1, &frame ) );
+
+		const std::vector<sampleFrame> data = ramp( 100, 0.0f );
+		qint64 offset;
+		{
+			SampleDataBundle bundle;
+			offset = bundle.add( data.data(), data.size() );
+			QVERIFY( bundle.writeFile( fileName ) );
+		}
+
+		std::vector<sampleFrame> read( SampleDataBundle::PageSize );
+		{
+			SampleDataBundle bundle;
+			QVERIFY( bundle.open( fileName ) );
+			// past the end of the file, inside the header, misaligned
+			QVERIFY( !bundle.read( offset, read.size(), read.data() ) );
+			QVERIFY( !bundle.read( 0, 1, read.data() ) );
+			QVERIFY( !bundle.read( offset + 8, 1, read.data() ) );
+		}
+
+		// a bundle cut short by e.g. a failed copy
+		QFile file( fileName );
+		QVERIFY( file.resize( offset + 50 * sizeof( sampleFrame ) ) );
+		SampleDataBundle bundle;
+		QVERIFY( bundle.open( fileName ) );
+		QVERIFY( !bundle.read( offset, data.size(), read.data() ) );
+		QVERIFY( bundle.read( offset, 50, read.data() ) );
+	}
+
+	void RejectsForeignFiles()
+	{
+		QTemporaryDir dir;
+		QVERIFY( dir.isValid() );
+		const QString fileName = QDir( dir.path() ).filePath( "test.data" );
+
+		QFile file( fileName );
+		QVERIFY( file.open( QIODevice::WriteOnly ) );
+		file.write( QByteArray( SampleDataBundle::PageSize * 2, 'x' ) );
+		file.close();
+
+		SampleDataBundle bundle;
+		QVERIFY( !bundle.open( fileName ) );
+	}
+} SampleDataBundleTests;
+
+#include "SampleDataBundleTest.moc"
@@ -0,0 +1,98 @@
+/*
+ * SamplePeakCacheTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include <vector>
+
+#include "SamplePeakCache.h"
+
+class SamplePeakCacheTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void QueryMatchesRawData()
+	{
+		const f_cnt_t frames = 100000;
+		std::vector<float> raw( frames * DEFAULT_CHANNELS );
+		sampleFrame * data = reinterpret_cast<sampleFrame *>( raw.data() );
+		for( f_cnt_t f = 0; f < frames; ++f )
+		{
+			data[f][0] = ( f % 1000 ) / 1000.0f;
+			data[f][1] = -data[f][0];
+		}
+		data[54321][0] = 2.0f;
+
+		SamplePeakCache cache;
+		QVERIFY( !cache.isValid() );
+		cache.build( data, frames );
+		QVERIFY( cache.isValid() );
+
+		// short ranges are evaluated exactly
+		SamplePeakCache::Peak p = cache.query( data, 10, 20, 0 );
+		QCOMPARE( p.min, data[10][0] );
+		QCOMPARE( p.max, data[19][0] );
+
+		// long ranges go through the pyramid
+		p = cache.query( data, 0, frames, 0 );
+		QCOMPARE( p.max, 2.0f );
+		QVERIFY( p.min == 0.0f );
+		p = cache.query( data, 0, frames, 1 );
+		QVERIFY( p.max == 0.0f );
+		QCOMPARE( p.min, -0.999f );
+		QVERIFY( p.rms() > 0.5f && p.rms() < 0.65f );
+
+		cache.clear();
+		QVERIFY( !cache.isValid() );
+	}
+
+	void PartialBlockIsWeightedByItsLength()
+	{
+		// four full blocks of silence followed by a block of one frame
+		const f_cnt_t frames = 4 * SamplePeakCache::BaseBlockSize + 1;
+		std::vector<float> raw( frames * DEFAULT_CHANNELS, 0.0f );
+		sampleFrame * data = reinterpret_cast<sampleFrame *>( raw.data() );
+		data[frames - 1][0] = 1.0f;
+
+		SamplePeakCache cache;
+		cache.build( data, frames );
+
+		const SamplePeakCache::Peak p = cache.query( data, 0, frames, 0 );
+		QCOMPARE( p.max, 1.0f );
+		QCOMPARE( p.meanSquare, 1.0f / frames );
+	}
+
+	void EmptySampleGivesSilence()
+	{
+		sampleFrame frame = { 1.0f, 1.0f };
+
+		SamplePeakCache cache;
+		cache.build( &frame, 0 );
+
+		const SamplePeakCache::Peak p = cache.query( &frame, 0, 10, 0 );
+		QVERIFY( p.min == 0.0f );
+		QVERIFY( p.max == 0.0f );
+		QVERIFY( p.meanSquare == 0.0f );
+	}
+} SamplePeakCacheTests;
+
+#include "SamplePeakCacheTest.moc"